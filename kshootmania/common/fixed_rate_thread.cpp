@@ -0,0 +1,70 @@
+﻿#include "fixed_rate_thread.hpp"
+#include <chrono>
+#include <Siv3D/Windows/Windows.hpp>
+#include <timeapi.h>
+
+namespace
+{
+	int ThreadPriorityValue(FixedRateThread::Priority priority)
+	{
+		switch (priority)
+		{
+		case FixedRateThread::Priority::kHighest:
+			return THREAD_PRIORITY_HIGHEST;
+
+		case FixedRateThread::Priority::kAboveNormal:
+		default:
+			return THREAD_PRIORITY_ABOVE_NORMAL;
+		}
+	}
+}
+
+void FixedRateThread::threadMain(double rateHz, Priority priority, const std::function<void()>& func)
+{
+	using namespace std::chrono;
+
+	timeBeginPeriod(1);
+	SetThreadPriority(GetCurrentThread(), ThreadPriorityValue(priority));
+
+	const auto interval = duration_cast<steady_clock::duration>(duration<double>(1.0 / rateHz));
+	auto nextTime = steady_clock::now();
+	while (!m_isTerminating.load(std::memory_order_relaxed))
+	{
+		func();
+
+		nextTime += interval;
+		const auto now = steady_clock::now();
+		if (nextTime < now)
+		{
+			// Do not try to catch up after a stall
+			nextTime = now;
+		}
+		std::this_thread::sleep_until(nextTime);
+	}
+
+	timeEndPeriod(1);
+}
+
+FixedRateThread::~FixedRateThread()
+{
+	stop();
+}
+
+void FixedRateThread::start(double rateHz, Priority priority, std::function<void()> func)
+{
+	assert(!m_thread.joinable());
+
+	m_isTerminating.store(false);
+	m_thread = std::thread([this, rateHz, priority, func = std::move(func)] { threadMain(rateHz, priority, func); });
+}
+
+void FixedRateThread::stop()
+{
+	if (!m_thread.joinable())
+	{
+		return;
+	}
+
+	m_isTerminating.store(true);
+	m_thread.join();
+}
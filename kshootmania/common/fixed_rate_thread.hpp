@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <thread>
+#include <functional>
+
+// Dedicated thread that calls a function at a fixed rate (used for the input polling and the simulation tick)
+// Note: The timer resolution of Windows is raised to 1ms while the thread runs, because the default one (15.6ms) is too coarse
+//       for the intervals. After a stall, the thread does not try to catch up (the callers read the current time in each call).
+class FixedRateThread
+{
+public:
+	enum class Priority
+	{
+		kAboveNormal,
+		kHighest,
+	};
+
+private:
+	std::atomic<bool> m_isTerminating = false;
+
+	std::thread m_thread;
+
+	void threadMain(double rateHz, Priority priority, const std::function<void()>& func);
+
+public:
+	FixedRateThread() = default;
+
+	~FixedRateThread();
+
+	FixedRateThread(const FixedRateThread&) = delete;
+
+	FixedRateThread& operator=(const FixedRateThread&) = delete;
+
+	// Starts calling func at rateHz (must not be called while the thread is running)
+	void start(double rateHz, Priority priority, std::function<void()> func);
+
+	// Stops the thread and waits for the current call of func to finish (does nothing if the thread is not running)
+	void stop();
+};
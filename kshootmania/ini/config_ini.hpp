@@ -67,6 +67,18 @@ namespace ConfigIni
 		constexpr StringView kAudioFXDelay = U"soundfx_delay";
 		constexpr StringView kVisualOffset = U"visual_offset";
 		constexpr StringView kAutoPlaySE = U"auto_play_se";
+		constexpr StringView kPreloadBGM = U"preload_bgm";
+		constexpr StringView kAudioCacheSizeMB = U"audio_cache_size";
+		constexpr StringView kResamplerQuality = U"resampler_quality";
+		constexpr StringView kPlaySpeed = U"play_speed";
+		constexpr StringView kSaveReplay = U"save_replay";
+
+		// Other advanced input settings
+		constexpr StringView kLaserKnobDeadZone = U"laser_deadzone";
+		constexpr StringView kLaserKnobSmoothing = U"laser_smoothing";
+
+		// Other advanced graphics settings
+		constexpr StringView kParallelDrawList = U"parallel_drawlist";
 
 		constexpr StringView kMuteAudioInInactiveWindow = U"automaticmute";
 
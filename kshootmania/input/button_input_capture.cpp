@@ -0,0 +1,117 @@
+﻿#include "button_input_capture.hpp"
+#include <chrono>
+#include <Siv3D/Windows/Windows.hpp>
+#include <mmsystem.h>
+
+namespace
+{
+	Array<Array<uint8>> CollectKeyboardKeyCodes(const Array<KeyConfig::Button>& buttons)
+	{
+		return buttons.map([](KeyConfig::Button button) { return KeyConfig::KeyboardKeyCodes(button); });
+	}
+
+	Array<Array<uint8>> CollectGamepadButtonCodes(const Array<KeyConfig::Button>& buttons)
+	{
+		return buttons.map([](KeyConfig::Button button) { return KeyConfig::GamepadButtonCodes(button); });
+	}
+}
+
+double InputClockSec()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+ButtonInputCapture::ButtonInputCapture(const Array<KeyConfig::Button>& buttons)
+	: m_buttons(buttons)
+	, m_keyboardKeyCodes(CollectKeyboardKeyCodes(buttons))
+	, m_gamepadButtonCodes(CollectGamepadButtonCodes(buttons))
+	, m_hWnd(Platform::Windows::Window::GetHWND())
+	, m_prevPressed(buttons.size(), false)
+	, m_updateTimeSec(InputClockSec())
+{
+	m_pollingThread.start(kPollingRateHz, FixedRateThread::Priority::kHighest, [this] { poll(); });
+}
+
+ButtonInputCapture::~ButtonInputCapture()
+{
+	m_pollingThread.stop();
+}
+
+void ButtonInputCapture::poll()
+{
+	const double timeSec = InputClockSec();
+	const bool isForeground = (GetForegroundWindow() == static_cast<HWND>(m_hWnd));
+
+	// Note: Gamepads are read through winmm because the Siv3D gamepad API is available only in the main thread.
+	//       The button indices in the key config are the bits of dwButtons in the same way as Siv3D.
+	DWORD gamepadButtons = 0U;
+	if (isForeground)
+	{
+		JOYINFOEX joyInfo = {
+			.dwSize = sizeof(JOYINFOEX),
+			.dwFlags = JOY_RETURNBUTTONS,
+		};
+		if (joyGetPosEx(JOYSTICKID1, &joyInfo) == JOYERR_NOERROR)
+		{
+			gamepadButtons = joyInfo.dwButtons;
+		}
+	}
+
+	for (std::size_t i = 0U; i < m_buttons.size(); ++i)
+	{
+		// A button is regarded as pressed while any of the keys assigned to it is pressed, in the same way as KeyConfig::Pressed()
+		bool pressed = false;
+		if (isForeground)
+		{
+			for (const uint8 keyCode : m_keyboardKeyCodes[i])
+			{
+				if (GetAsyncKeyState(keyCode) & 0x8000)
+				{
+					pressed = true;
+					break;
+				}
+			}
+			for (const uint8 buttonCode : m_gamepadButtonCodes[i])
+			{
+				if (buttonCode < 32U && ((gamepadButtons >> buttonCode) & 1U) != 0U)
+				{
+					pressed = true;
+					break;
+				}
+			}
+		}
+
+		// Note: If the queue is full, the state is not updated so that the event is retried in the next poll
+		if (pressed != m_prevPressed[i] && m_eventQueue.push({ .button = m_buttons[i], .isPressed = pressed, .timeSec = timeSec }))
+		{
+			m_prevPressed[i] = pressed;
+		}
+	}
+}
+
+void ButtonInputCapture::update()
+{
+	m_events.clear();
+	m_updateTimeSec = InputClockSec();
+
+	while (const auto event = m_eventQueue.pop())
+	{
+		m_events.push_back(*event);
+	}
+}
+
+const Array<ButtonInputEvent>& ButtonInputCapture::events() const
+{
+	return m_events;
+}
+
+const Array<KeyConfig::Button>& ButtonInputCapture::buttons() const
+{
+	return m_buttons;
+}
+
+double ButtonInputCapture::updateTimeSec() const
+{
+	return m_updateTimeSec;
+}
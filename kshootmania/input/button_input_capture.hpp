@@ -0,0 +1,72 @@
+﻿#pragma once
+#include "key_config.hpp"
+#include "spsc_queue.hpp"
+#include "common/fixed_rate_thread.hpp"
+
+struct ButtonInputEvent
+{
+	KeyConfig::Button button = KeyConfig::kUnspecifiedButton;
+
+	bool isPressed = false;
+
+	// Time in InputClockSec()
+	double timeSec = 0.0;
+};
+
+// Clock used for the timestamps of ButtonInputEvent
+double InputClockSec();
+
+// Captures press/release of buttons with their timestamps
+// Note: Keyboards and gamepads are polled on a dedicated thread at kPollingRateHz, so that the timestamps are not quantized to the frame rate.
+//       update() can be called from another thread (e.g., the simulation thread of the game).
+class ButtonInputCapture
+{
+public:
+	static constexpr int32 kPollingRateHz = 1000;
+
+private:
+	static constexpr std::size_t kQueueCapacity = 1024U;
+
+	const Array<KeyConfig::Button> m_buttons;
+
+	// Virtual-key codes and gamepad button indices of each button (read only after construction)
+	const Array<Array<uint8>> m_keyboardKeyCodes;
+	const Array<Array<uint8>> m_gamepadButtonCodes;
+
+	// Window to which the input is accepted
+	void* const m_hWnd;
+
+	SPSCQueue<ButtonInputEvent, kQueueCapacity> m_eventQueue;
+
+	// Used only in the polling thread
+	Array<bool> m_prevPressed;
+
+	FixedRateThread m_pollingThread;
+
+	// Used only in the thread calling update()
+	Array<ButtonInputEvent> m_events;
+	double m_updateTimeSec = 0.0;
+
+	void poll();
+
+public:
+	explicit ButtonInputCapture(const Array<KeyConfig::Button>& buttons);
+
+	~ButtonInputCapture();
+
+	ButtonInputCapture(const ButtonInputCapture&) = delete;
+
+	ButtonInputCapture& operator=(const ButtonInputCapture&) = delete;
+
+	// Collects the events since the previous call
+	void update();
+
+	// Events collected by the last update() in chronological order
+	// Note: A button is regarded as pressed while any of the keys assigned to it is pressed, in the same way as KeyConfig::Pressed().
+	const Array<ButtonInputEvent>& events() const;
+
+	const Array<KeyConfig::Button>& buttons() const;
+
+	// Time at which the last update() was called (in InputClockSec())
+	double updateTimeSec() const;
+};
@@ -136,3 +136,41 @@ bool KeyConfig::Up(Button button)
 	}
 	return false;
 }
+
+Array<uint8> KeyConfig::KeyboardKeyCodes(Button button)
+{
+	Array<uint8> keyCodes;
+	if (button == KeyConfig::kUnspecifiedButton)
+	{
+		return keyCodes;
+	}
+
+	for (const auto& configSet : s_configSetArray)
+	{
+		const Input& input = configSet[button];
+		if (input.deviceType() == InputDeviceType::Keyboard && !keyCodes.contains(input.code()))
+		{
+			keyCodes.push_back(input.code());
+		}
+	}
+	return keyCodes;
+}
+
+Array<uint8> KeyConfig::GamepadButtonCodes(Button button)
+{
+	Array<uint8> buttonCodes;
+	if (button == KeyConfig::kUnspecifiedButton)
+	{
+		return buttonCodes;
+	}
+
+	for (const auto& configSet : s_configSetArray)
+	{
+		const Input& input = configSet[button];
+		if (input.deviceType() == InputDeviceType::Gamepad && !buttonCodes.contains(input.code()))
+		{
+			buttonCodes.push_back(input.code());
+		}
+	}
+	return buttonCodes;
+}
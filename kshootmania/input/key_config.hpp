@@ -65,6 +65,12 @@ namespace KeyConfig
 
 	bool Up(Button button);
 
+	// Key codes assigned to the button in the keyboard config sets (for polling outside Siv3D)
+	Array<uint8> KeyboardKeyCodes(Button button);
+
+	// Button indices assigned to the button in the gamepad config sets (for polling outside Siv3D)
+	Array<uint8> GamepadButtonCodes(Button button);
+
 	template <class C>
 	bool AnyButtonPressed(const C& buttons)
 	{
@@ -0,0 +1,192 @@
+﻿#include "laser_knob_capture.hpp"
+#include <utility>
+#include <Siv3D/Windows/Windows.hpp>
+#include <mmsystem.h>
+
+namespace
+{
+	// Mouse movement per lane width at the sensitivity 1 (in pixels)
+	constexpr double kMousePixelsPerLaneAtSensitivity1 = 2000.0;
+
+	// Analog axis movement per lane width at the sensitivity 1 (in full ranges of the axis)
+	constexpr double kAxisRangesPerLaneAtSensitivity1 = 4.0;
+
+	constexpr int32 kAxisRange = 65536;
+
+	// Movements smaller than this value are emitted at once instead of being smoothed forever
+	constexpr double kSmoothingMinDelta = 1e-4;
+
+	// Movements held in the dead zone are discarded if the knob is not moved further within this duration
+	constexpr double kDeadZoneHoldSec = 0.2;
+
+	// Difference of an axis position, regarding the axis as a rotary encoder that wraps around
+	int32 AxisDiff(DWORD pos, DWORD prevPos)
+	{
+		int32 diff = static_cast<int32>(pos) - static_cast<int32>(prevPos);
+		if (diff > kAxisRange / 2)
+		{
+			diff -= kAxisRange;
+		}
+		else if (diff < -kAxisRange / 2)
+		{
+			diff += kAxisRange;
+		}
+		return diff;
+	}
+}
+
+LaserKnobCapture::LaserKnobCapture(const LaserKnobSettings& settings)
+	: m_settings(settings)
+	, m_hWnd(Platform::Windows::Window::GetHWND())
+	, m_prevPollTimeSec(InputClockSec())
+	, m_updateTimeSec(InputClockSec())
+{
+	if (isEnabled())
+	{
+		m_pollingThread.start(kPollingRateHz, FixedRateThread::Priority::kHighest, [this] { poll(); });
+	}
+}
+
+LaserKnobCapture::~LaserKnobCapture()
+{
+	m_pollingThread.stop();
+}
+
+void LaserKnobCapture::poll()
+{
+	using namespace ConfigIni::Value;
+
+	const HWND hWnd = static_cast<HWND>(m_hWnd);
+	const double sensitivity = static_cast<double>(m_settings.sensitivity);
+	const std::size_t xLaneIdx = m_settings.swapLaserLR ? 1U : 0U;
+	const std::size_t yLaneIdx = 1U - xLaneIdx;
+
+	// Movements read in this poll
+	std::array<double, kson::kNumLaserLanesSZ> rawDeltas = {};
+
+	const double timeSec = InputClockSec();
+	const bool isForeground = (GetForegroundWindow() == hWnd);
+	if (isForeground)
+	{
+		if (m_settings.inputType == LaserInputType::kMouseXY)
+		{
+			// The mouse cursor is moved back to the center of the window after each poll, so that it never stops at the screen edge
+			RECT clientRect;
+			GetClientRect(hWnd, &clientRect);
+			POINT center = { (clientRect.left + clientRect.right) / 2, (clientRect.top + clientRect.bottom) / 2 };
+			ClientToScreen(hWnd, &center);
+
+			POINT pos;
+			if (m_wasForeground && GetCursorPos(&pos))
+			{
+				const double pixelsPerLane = kMousePixelsPerLaneAtSensitivity1 / sensitivity;
+				rawDeltas[xLaneIdx] = (pos.x - center.x) * m_settings.mouseDirectionX / pixelsPerLane;
+				rawDeltas[yLaneIdx] = (pos.y - center.y) * m_settings.mouseDirectionY / pixelsPerLane;
+			}
+			SetCursorPos(center.x, center.y);
+		}
+		else
+		{
+			// Note: Gamepads are read through winmm here because the Siv3D gamepad API is available only in the main thread
+			const bool isSlider = (m_settings.inputType == LaserInputType::kSlider);
+			JOYINFOEX joyInfo = {
+				.dwSize = sizeof(JOYINFOEX),
+				.dwFlags = static_cast<DWORD>(isSlider ? (JOY_RETURNZ | JOY_RETURNR) : (JOY_RETURNX | JOY_RETURNY)),
+			};
+			if (joyGetPosEx(JOYSTICKID1, &joyInfo) == JOYERR_NOERROR)
+			{
+				const std::pair<uint32, uint32> axisPos = isSlider ? std::make_pair(joyInfo.dwZpos, joyInfo.dwRpos) : std::make_pair(joyInfo.dwXpos, joyInfo.dwYpos);
+				if (m_prevAxisPos.has_value())
+				{
+					const double axisRangesPerLane = kAxisRangesPerLaneAtSensitivity1 / sensitivity;
+					rawDeltas[xLaneIdx] = AxisDiff(axisPos.first, m_prevAxisPos->first) / (kAxisRange * axisRangesPerLane);
+					rawDeltas[yLaneIdx] = AxisDiff(axisPos.second, m_prevAxisPos->second) / (kAxisRange * axisRangesPerLane);
+				}
+				m_prevAxisPos = axisPos;
+			}
+			else
+			{
+				m_prevAxisPos = none;
+			}
+		}
+	}
+	else
+	{
+		// Movements while the window is inactive are discarded
+		m_prevAxisPos = none;
+	}
+	m_wasForeground = isForeground;
+
+	// Note: The filters are applied per poll with the time of the poll, so that the result does not depend on when update() is called
+	for (std::size_t laneIdx = 0U; laneIdx < kson::kNumLaserLanesSZ; ++laneIdx)
+	{
+		double delta = rawDeltas[laneIdx];
+
+		// Dead zone (the movement is held until it exceeds the dead zone, and the held movement is reset when the direction
+		// is reversed or the knob stops, so that small jitters never accumulate into a movement)
+		if (delta != 0.0)
+		{
+			double& heldDeltaRef = m_deadZoneHeldDeltas[laneIdx];
+			if ((heldDeltaRef > 0.0 && delta < 0.0) || (heldDeltaRef < 0.0 && delta > 0.0) || timeSec - m_deadZoneHeldTimeSecs[laneIdx] > kDeadZoneHoldSec)
+			{
+				heldDeltaRef = 0.0;
+			}
+			heldDeltaRef += delta;
+			m_deadZoneHeldTimeSecs[laneIdx] = timeSec;
+			if (Abs(heldDeltaRef) >= m_settings.deadZone)
+			{
+				delta = std::exchange(heldDeltaRef, 0.0);
+			}
+			else
+			{
+				delta = 0.0;
+			}
+		}
+
+		// Smoothing (the pending movement is emitted gradually, so the total movement is kept)
+		if (m_settings.smoothingSec > 0.0)
+		{
+			double& pendingDeltaRef = m_smoothingPendingDeltas[laneIdx];
+			pendingDeltaRef += delta;
+			const double rate = 1.0 - std::exp(-(timeSec - m_prevPollTimeSec) / m_settings.smoothingSec);
+			delta = (Abs(pendingDeltaRef) < kSmoothingMinDelta) ? pendingDeltaRef : pendingDeltaRef * rate;
+			pendingDeltaRef -= delta;
+		}
+
+		m_unsentDeltas[laneIdx] += delta;
+
+		// Note: If the queue is full, the movement is accumulated and retried in the next poll
+		if (m_unsentDeltas[laneIdx] != 0.0 && m_eventQueue.push({ .laneIdx = laneIdx, .delta = m_unsentDeltas[laneIdx], .timeSec = timeSec }))
+		{
+			m_unsentDeltas[laneIdx] = 0.0;
+		}
+	}
+	m_prevPollTimeSec = timeSec;
+}
+
+bool LaserKnobCapture::isEnabled() const
+{
+	return m_settings.inputType != ConfigIni::Value::LaserInputType::kKeyboard;
+}
+
+void LaserKnobCapture::update()
+{
+	m_events.clear();
+	m_updateTimeSec = InputClockSec();
+
+	// Note: The movements are already filtered by the polling thread
+	while (const auto event = m_eventQueue.pop())
+	{
+		m_events.push_back(*event);
+	}
+}
+
+const Array<LaserKnobEvent>& LaserKnobCapture::events() const
+{
+	return m_events;
+}
+
+double LaserKnobCapture::updateTimeSec() const
+{
+	return m_updateTimeSec;
+}
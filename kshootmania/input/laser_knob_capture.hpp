@@ -0,0 +1,101 @@
+﻿#pragma once
+#include "button_input_capture.hpp"
+#include "spsc_queue.hpp"
+#include "common/fixed_rate_thread.hpp"
+
+struct LaserKnobEvent
+{
+	// Index of the laser lane (0: left, 1: right)
+	std::size_t laneIdx = 0U;
+
+	// Movement of the cursor (1.0 is the width of the lane)
+	double delta = 0.0;
+
+	// Time in InputClockSec()
+	double timeSec = 0.0;
+};
+
+struct LaserKnobSettings
+{
+	int32 inputType = ConfigIni::Value::LaserInputType::kKeyboard;
+
+	// Direction of the mouse movement that moves the cursor to the right (1 or -1)
+	int32 mouseDirectionX = 1;
+	int32 mouseDirectionY = 1;
+
+	// Sensitivity in the same unit as the "mouse_sensitivity" option (negative values reverse the direction)
+	int32 sensitivity = 4;
+
+	bool swapLaserLR = false;
+
+	// Movements smaller than this value are held until they accumulate in the same direction (to suppress the jitter of analog axes)
+	double deadZone = 0.0;
+
+	// Time constant of the exponential smoothing of movements (0 to disable)
+	double smoothingSec = 0.0;
+};
+
+// Captures the movement of the laser knobs (mouse or analog axes) with their timestamps
+// Note: The devices are polled on a dedicated thread at kPollingRateHz, so that the movement is not quantized to the frame rate.
+//       The dead zone and the smoothing are also applied per poll with the time of the poll, so they do not depend on the update rate.
+//       Movements that cannot be queued are carried over to the next poll, so no movement is lost between updates.
+//       update() can be called from another thread (e.g., the simulation thread of the game).
+class LaserKnobCapture
+{
+public:
+	static constexpr int32 kPollingRateHz = 1000;
+
+private:
+	static constexpr std::size_t kQueueCapacity = 1024U;
+
+	const LaserKnobSettings m_settings;
+
+	// Window to which the input is accepted
+	void* const m_hWnd;
+
+	SPSCQueue<LaserKnobEvent, kQueueCapacity> m_eventQueue;
+
+	// Movements held in the dead zone and the time when they were last moved (used only in the polling thread)
+	std::array<double, kson::kNumLaserLanesSZ> m_deadZoneHeldDeltas = {};
+	std::array<double, kson::kNumLaserLanesSZ> m_deadZoneHeldTimeSecs = {};
+
+	// Movements not emitted by the smoothing yet (used only in the polling thread)
+	std::array<double, kson::kNumLaserLanesSZ> m_smoothingPendingDeltas = {};
+
+	// Movements not queued yet, carried over if the queue is full (used only in the polling thread)
+	std::array<double, kson::kNumLaserLanesSZ> m_unsentDeltas = {};
+
+	// State of the previous poll (used only in the polling thread)
+	bool m_wasForeground = false;
+	Optional<std::pair<uint32, uint32>> m_prevAxisPos = none;
+	double m_prevPollTimeSec = 0.0;
+
+	FixedRateThread m_pollingThread;
+
+	// Used only in the thread calling update()
+	Array<LaserKnobEvent> m_events;
+	double m_updateTimeSec = 0.0;
+
+	void poll();
+
+public:
+	explicit LaserKnobCapture(const LaserKnobSettings& settings);
+
+	~LaserKnobCapture();
+
+	LaserKnobCapture(const LaserKnobCapture&) = delete;
+
+	LaserKnobCapture& operator=(const LaserKnobCapture&) = delete;
+
+	// Whether an analog input type is selected (the laser keys are used otherwise)
+	bool isEnabled() const;
+
+	// Collects the movements since the previous call
+	void update();
+
+	// Events collected by the last update() in chronological order
+	const Array<LaserKnobEvent>& events() const;
+
+	// Time at which the last update() was called (in InputClockSec())
+	double updateTimeSec() const;
+};
@@ -0,0 +1,50 @@
+﻿#pragma once
+#include <atomic>
+
+// Lock-free bounded queue for one producer thread and one consumer thread
+template <typename T, std::size_t Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity >= 2U && (Capacity & (Capacity - 1U)) == 0U, "Capacity must be a power of two");
+
+private:
+	std::array<T, Capacity> m_buffer = {};
+
+	// Note: The indices increase monotonically and are masked on access.
+	//       They are placed on separate cache lines so that the producer and the consumer do not share a line.
+	alignas(64) std::atomic<std::size_t> m_head = 0U; // Written by the consumer
+	alignas(64) std::atomic<std::size_t> m_tail = 0U; // Written by the producer
+
+public:
+	SPSCQueue() = default;
+
+	SPSCQueue(const SPSCQueue&) = delete;
+
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	// Called only from the producer thread (returns false if the queue is full)
+	bool push(const T& value)
+	{
+		const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) >= Capacity)
+		{
+			return false;
+		}
+		m_buffer[tail & (Capacity - 1U)] = value;
+		m_tail.store(tail + 1U, std::memory_order_release);
+		return true;
+	}
+
+	// Called only from the consumer thread
+	Optional<T> pop()
+	{
+		const std::size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return none;
+		}
+		T value = m_buffer[head & (Capacity - 1U)];
+		m_head.store(head + 1U, std::memory_order_release);
+		return value;
+	}
+};
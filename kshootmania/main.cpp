@@ -3,10 +3,45 @@
 #include "scene/option/option_scene.hpp"
 #include "scene/select/select_scene.hpp"
 #include "scene/play/play_scene.hpp"
+#include "music_game/replay/replay_simulator.hpp"
+#include "music_game/benchmark/autoplay_benchmark.hpp"
+#include "music_game/benchmark/stress_chart_generator.hpp"
 #include "ksmaudio/ksmaudio.hpp"
 
 void Main()
 {
+	const Array<String> args = System::GetCommandLineArgs();
+
+	// Headless re-simulation of replay files (e.g., "kshootmania.exe --replay a.ksmreplay b.ksmreplay")
+	// Note: This runs before initializing the audio backend and does not draw anything.
+	//       With "--dsp-load" (e.g., "kshootmania.exe --replay --dsp-load a.ksmreplay"), the BGM is also rendered through the
+	//       audio effects without an output device, and the DSP load is printed for each replay.
+	if (args.size() >= 2U && args[1] == U"--replay")
+	{
+		Console.open();
+		const bool measureDSPLoad = args.size() >= 3U && args[2] == U"--dsp-load";
+		if (measureDSPLoad)
+		{
+			ksmaudio::InitHeadless();
+		}
+		const bool isAllMatched = MusicGame::Replay::RunReplaySimulations(args.slice(measureDSPLoad ? 3 : 2), measureDSPLoad);
+		Console << (isAllMatched ? U"[Replay] All replays matched" : U"[Replay] Some replays did not match");
+		if (measureDSPLoad)
+		{
+			ksmaudio::Terminate();
+		}
+		return;
+	}
+
+	// Generate stress charts for the benchmark (e.g., "kshootmania.exe --generate-stress-charts songs/stress measures=200 bt=16 seed=1")
+	// Note: The options (measures, bt, fx, long, bpm, slam, param, seed) set the base density that each chart scales up from.
+	if (args.size() >= 3U && args[1] == U"--generate-stress-charts")
+	{
+		Console.open();
+		MusicGame::Benchmark::GenerateStressChartSet(args[2], MusicGame::Benchmark::ParseStressChartParams(args.slice(3)));
+		return;
+	}
+
 	// Disable application termination by Esc key
 	System::SetTerminationTriggers(UserAction::CloseButtonClicked);
 
@@ -28,11 +63,42 @@ void Main()
 	// Load config.ini
 	ConfigIni::Load();
 
+	// Quality of the resampler for audio files whose sample rate is not 44100Hz (0: low, 1: medium, 2: high)
+	const int32 resamplerQuality = Clamp(ConfigIni::GetInt(ConfigIni::Key::kResamplerQuality, static_cast<int32>(ksmaudio::ResamplerQuality::kMedium)), 0, 2);
+	ksmaudio::SetResamplerQuality(static_cast<ksmaudio::ResamplerQuality>(resamplerQuality));
+
+	// Enable on-disk cache of decoded audio (0 to disable)
+	constexpr int32 kDefaultAudioCacheSizeMB = 1024;
+	const int32 audioCacheSizeMB = Max(ConfigIni::GetInt(ConfigIni::Key::kAudioCacheSizeMB, kDefaultAudioCacheSizeMB), 0);
+	ksmaudio::DecodedAudioCache::Init("cache/audio", static_cast<std::uint64_t>(audioCacheSizeMB) * 1024U * 1024U);
+
 	// Register asset list
 	AssetManagement::RegisterAssets();
 
 	//Graphics::SetVSyncEnabled(false);
 
+	// Autoplay benchmark of the charts in a directory (e.g., "kshootmania.exe --benchmark songs 60 serial")
+	// Note: The last argument selects how the note draw lists are built ("parallel" as in the game by default, or "serial").
+	if (args.size() >= 3U && args[1] == U"--benchmark")
+	{
+		constexpr double kDefaultBenchmarkFrameRate = 60.0;
+		const double frameRate = (args.size() >= 4U) ? Max(ParseOr<double>(args[3], kDefaultBenchmarkFrameRate), 1.0) : kDefaultBenchmarkFrameRate;
+		const bool parallelDrawList = !(args.size() >= 5U && args[4] == U"serial");
+		Console.open();
+
+		// Print the cost and quality of each resampler preset
+		for (const auto quality : { ksmaudio::ResamplerQuality::kLow, ksmaudio::ResamplerQuality::kMedium, ksmaudio::ResamplerQuality::kHigh })
+		{
+			const auto result = ksmaudio::BenchmarkResampler(48000U, ksmaudio::kSampleRate, quality, 2.0);
+			Console << U"[ksmaudio] Resampler preset {}: {:.0f}x realtime, SNR {:.1f}dB, alias rejection {:.1f}dB"_fmt(
+				static_cast<int32>(quality), result.realtimeFactor, result.snrDB, result.aliasRejectionDB.value_or(0.0));
+		}
+
+		MusicGame::Benchmark::RunAutoplayBenchmark(args[2], frameRate, parallelDrawList);
+		ksmaudio::Terminate();
+		return;
+	}
+
 #if defined(_WIN32) && defined(_DEBUG)
 	AllocConsole();
 	FILE* fp = NULL;
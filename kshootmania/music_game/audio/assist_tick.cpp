@@ -2,64 +2,71 @@
 
 namespace
 {
-	// Assist tick sound is played 30ms early
-	constexpr double kLatencySec = 0.03;
-
-	// Note: ByPulse<Interval> is std::map<Pulse, Interval>
-	kson::Pulse CurrentNotePulse(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse)
+	// Schedules the ticks of the notes from the last scheduled note up to the lookahead time
+	template <typename Func>
+	void ScheduleNotes(const kson::ByPulse<kson::Interval>& lane, kson::Pulse lookaheadPulse, kson::Pulse& scheduledPulseRef, Func func)
 	{
-		const auto nextNote = lane.upper_bound(currentPulse);
-		if (nextNote == lane.begin())
+		for (auto itr = lane.upper_bound(scheduledPulseRef); itr != lane.end() && itr->first <= lookaheadPulse; ++itr)
 		{
-			return MusicGame::kPastPulse;
+			func(itr->first, itr->second);
+			scheduledPulseRef = itr->first;
 		}
-
-		return std::prev(nextNote)->first;
 	}
 }
 
-MusicGame::Audio::AssistTick::AssistTick(bool enabled)
+MusicGame::Audio::AssistTick::AssistTick(bool enabled, ksmaudio::SEMixer& seMixer)
 	: m_enabled(enabled)
-	, m_btTickSound(U"se/tick.wav")
-	, m_fxTickSound(U"se/tick2.wav")
+	, m_btTickSound(enabled ? seMixer.loadSound("se/tick.wav") : ksmaudio::SEMixer::kInvalidSoundID)
+	, m_fxTickSound(enabled ? seMixer.loadSound("se/tick2.wav") : ksmaudio::SEMixer::kInvalidSoundID)
 {
 }
 
-void MusicGame::Audio::AssistTick::update(const kson::ChartData& chartData, const kson::TimingCache& timingCache, double currentTimeSec)
+void MusicGame::Audio::AssistTick::update(const kson::ChartData& chartData, const TempoMap& tempoMap, const FrameTiming& frameTiming, SEScheduler& seScheduler)
 {
 	if (!m_enabled)
 	{
 		return;
 	}
 
-	const kson::Pulse currentPulseForAssistTick = kson::SecToPulse(currentTimeSec + kLatencySec, chartData.beat, timingCache);
+	const double currentTimeSec = frameTiming.currentTimeSec;
+	const kson::Pulse lookaheadPulse = frameTiming.seLookaheadPulse;
+
+	if (SEScheduler::IsTimeJump(m_prevTimeSec, currentTimeSec))
+	{
+		// Re-seek so that the notes from the current time are scheduled
+		// (the notes at the current pulse but before the current time are skipped by the time check below)
+		m_btScheduledPulses.fill(frameTiming.currentPulse - 1);
+		m_fxScheduledPulses.fill(frameTiming.currentPulse - 1);
+	}
+	m_prevTimeSec = currentTimeSec;
 
 	// BT notes
 	for (std::size_t i = 0; i < kson::kNumBTLanesSZ; ++i)
 	{
-		const kson::Pulse currentNotePulse = CurrentNotePulse(chartData.note.bt[i], currentPulseForAssistTick);
-		if (currentNotePulse > m_btPlayedPulses[i])
-		{
-			// Chip & long notes
-			m_btTickSound.stop();
-			m_btTickSound.play();
-			m_btPlayedPulses[i] = currentNotePulse;
-		}
+		ScheduleNotes(chartData.note.bt[i], lookaheadPulse, m_btScheduledPulses[i],
+			[&](kson::Pulse y, const kson::Interval&)
+			{
+				// Chip & long notes
+				const double noteTimeSec = tempoMap.pulseToSec(y);
+				if (noteTimeSec >= currentTimeSec)
+				{
+					seScheduler.schedule(m_btTickSound, noteTimeSec);
+				}
+			});
 	}
 
 	// FX notes
 	for (std::size_t i = 0; i < kson::kNumFXLanesSZ; ++i)
 	{
-		const kson::Pulse currentNotePulse = CurrentNotePulse(chartData.note.fx[i], currentPulseForAssistTick);
-		if (currentNotePulse > m_fxPlayedPulses[i])
-		{
-			if (chartData.note.fx[i].contains(currentNotePulse) && chartData.note.fx[i].at(currentNotePulse).length == 0)
+		ScheduleNotes(chartData.note.fx[i], lookaheadPulse, m_fxScheduledPulses[i],
+			[&](kson::Pulse y, const kson::Interval& note)
 			{
 				// Chip notes only
-				m_fxTickSound.stop();
-				m_fxTickSound.play();
-			}
-			m_fxPlayedPulses[i] = currentNotePulse;
-		}
+				const double noteTimeSec = tempoMap.pulseToSec(y);
+				if (note.length == 0 && noteTimeSec >= currentTimeSec)
+				{
+					seScheduler.schedule(m_fxTickSound, noteTimeSec);
+				}
+			});
 	}
 }
@@ -2,6 +2,8 @@
 #include "music_game/game_defines.hpp"
 #include "kson/chart_data.hpp"
 #include "kson/util/timing_utils.hpp"
+#include "music_game/frame_timing.hpp"
+#include "se_scheduler.hpp"
 
 namespace MusicGame::Audio
 {
@@ -9,15 +11,18 @@ namespace MusicGame::Audio
 	{
 	private:
 		bool m_enabled;
-		s3d::Audio m_btTickSound;
-		s3d::Audio m_fxTickSound;
+		const ksmaudio::SEMixer::SoundID m_btTickSound;
+		const ksmaudio::SEMixer::SoundID m_fxTickSound;
 
-		std::array<kson::Pulse, kson::kNumBTLanesSZ> m_btPlayedPulses = { kPastPulse, kPastPulse, kPastPulse, kPastPulse };
-		std::array<kson::Pulse, kson::kNumFXLanesSZ> m_fxPlayedPulses = { kPastPulse, kPastPulse };
+		// Pulse of the last note whose tick has been scheduled
+		std::array<kson::Pulse, kson::kNumBTLanesSZ> m_btScheduledPulses = { kPastPulse, kPastPulse, kPastPulse, kPastPulse };
+		std::array<kson::Pulse, kson::kNumFXLanesSZ> m_fxScheduledPulses = { kPastPulse, kPastPulse };
+
+		double m_prevTimeSec = kPastTimeSec;
 
 	public:
-		explicit AssistTick(bool enabled);
+		AssistTick(bool enabled, ksmaudio::SEMixer& seMixer);
 
-		void update(const kson::ChartData& chartData, const kson::TimingCache& timingCache, double currentTimeSec);
+		void update(const kson::ChartData& chartData, const TempoMap& tempoMap, const FrameTiming& frameTiming, SEScheduler& seScheduler);
 	};
 }
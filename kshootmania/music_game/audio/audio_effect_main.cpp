@@ -57,7 +57,7 @@ namespace MusicGame::Audio
 		}
 	}
 
-	void AudioEffectMain::registerAudioEffects(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache)
+	void AudioEffectMain::registerAudioEffects(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const TempoMap& tempoMap)
 	{
 		using AudioEffectUtils::PrecalculateUpdateTriggerTiming;
 
@@ -72,8 +72,8 @@ namespace MusicGame::Audio
 			const auto& paramChangeDict = chartData.audio.audioEffect.fx.paramChange;
 			const std::set<float> updateTriggerTiming =
 				paramChangeDict.contains(name)
-				? PrecalculateUpdateTriggerTiming(def, paramChangeDict.at(name), totalMeasures, chartData, timingCache)
-				: PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache);
+				? PrecalculateUpdateTriggerTiming(def, paramChangeDict.at(name), totalMeasures, chartData, timingCache, tempoMap)
+				: PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache, tempoMap);
 
 			bgm.emplaceAudioEffectFX(name, def, updateTriggerTiming);
 		}
@@ -84,8 +84,8 @@ namespace MusicGame::Audio
 			const auto& paramChangeDict = chartData.audio.audioEffect.laser.paramChange;
 			const std::set<float> updateTriggerTiming =
 				paramChangeDict.contains(name)
-				? PrecalculateUpdateTriggerTiming(def, paramChangeDict.at(name), totalMeasures, chartData, timingCache)
-				: PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache);
+				? PrecalculateUpdateTriggerTiming(def, paramChangeDict.at(name), totalMeasures, chartData, timingCache, tempoMap)
+				: PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache, tempoMap);
 
 			bgm.emplaceAudioEffectLaser(name, def, updateTriggerTiming);
 		}
@@ -94,12 +94,12 @@ namespace MusicGame::Audio
 		// TODO: Remove this code
 		{
 			const kson::AudioEffectDef def = { .type = kson::AudioEffectType::Retrigger };
-			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache);
+			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache, tempoMap);
 			bgm.emplaceAudioEffectFX("retrigger", def, updateTriggerTiming);
 		}
 		{
 			const kson::AudioEffectDef def = { .type = kson::AudioEffectType::Gate };
-			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache);
+			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache, tempoMap);
 			bgm.emplaceAudioEffectFX("gate", def, updateTriggerTiming);
 		}
 		{
@@ -112,7 +112,7 @@ namespace MusicGame::Audio
 		}
 		{
 			const kson::AudioEffectDef def = { .type = kson::AudioEffectType::Wobble };
-			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache);
+			const auto updateTriggerTiming = PrecalculateUpdateTriggerTiming(def, totalMeasures, chartData, timingCache, tempoMap);
 			bgm.emplaceAudioEffectFX("wobble", def, updateTriggerTiming);
 		}
 	}
@@ -156,19 +156,29 @@ namespace MusicGame::Audio
 		return audioEffects;
 	}
 
-	AudioEffectMain::AudioEffectMain(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache)
+	AudioEffectMain::AudioEffectMain(const kson::ChartData& chartData)
 		: m_longFXNoteAudioEffectNames(CreateLongFXNoteAudioEffectNames(chartData))
 		, m_longFXNoteAudioEffectParams(CreateLongFXNoteAudioEffectParams(chartData))
 	{
-		registerAudioEffects(bgm, chartData, timingCache);
 	}
 
-	void AudioEffectMain::update(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const AudioEffectInputStatus& inputStatus)
+	void AudioEffectMain::update(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const TempoMap& tempoMap, const FrameTiming& frameTiming, const AudioEffectInputStatus& inputStatus)
 	{
-		const double currentTimeSec = bgm.posSec();
-		const double currentTimeSecForAudio = currentTimeSec + bgm.latencySec(); // Note: In BASS v2.4.13 and later, for unknown reasons, the effects are out of sync even after adding this latency.
-		const kson::Pulse currentPulseForAudio = kson::SecToPulse(currentTimeSecForAudio, chartData.beat, timingCache);
-		const double currentBPMForAudio = kson::TempoAt(currentPulseForAudio, chartData.beat);
+		if (!m_isAudioEffectRegistered)
+		{
+			if (!bgm.isStreamReady())
+			{
+				return;
+			}
+			registerAudioEffects(bgm, chartData, timingCache, tempoMap);
+			m_isAudioEffectRegistered = true;
+		}
+
+		const double currentTimeSec = frameTiming.currentTimeSec;
+		const double currentTimeSecForAudio = frameTiming.audioTimeSec; // Note: In BASS v2.4.13 and later, for unknown reasons, the effects are out of sync even after adding this latency.
+		const kson::Pulse currentPulseForAudio = frameTiming.audioPulse;
+		// Note: The tempo is scaled by the play speed because the audio effects process the time-stretched audio
+		const double currentBPMForAudio = frameTiming.audioBPM * bgm.speed();
 
 		// FX audio effects
 		bool bypassFX = true;
@@ -183,7 +193,7 @@ namespace MusicGame::Audio
 			// Implementation in HSP: https://github.com/m4saka/kshootmania-v1-hsp/blob/19bfb6acbec8abd304b2e7dae6009df8e8e1f66f/src/scene/play/play_audio_effects.hsp#L488
 			if (currentLongNoteByTime.has_value()
 				&& (inputStatus.longFXPressed[i].value_or(true)
-					|| (currentTimeSec - kson::PulseToSec(currentLongNoteByTime->first, chartData.beat, timingCache)) < kLongFXNoteAudioEffectAutoPlaySec))
+					|| (currentTimeSec - tempoMap.pulseToSec(currentLongNoteByTime->first)) < kLongFXNoteAudioEffectAutoPlaySec))
 			{
 				currentLongNoteOfLanes[i] = currentLongNoteByTime;
 				bypassFX = false;
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "bgm.hpp"
+#include "music_game/frame_timing.hpp"
 #include "kson/chart_data.hpp"
 #include "kson/util/timing_utils.hpp"
 
@@ -21,14 +22,17 @@ namespace MusicGame::Audio
 		std::array<bool, kson::kNumFXLanesSZ> m_longFXPressedPrev = { false, false };
 		std::size_t m_lastPressedLongFXNoteLaneIdx = 0U;
 
-		void registerAudioEffects(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache);
+		// Note: Audio effects are registered after the BGM stream is loaded asynchronously
+		bool m_isAudioEffectRegistered = false;
+
+		void registerAudioEffects(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const TempoMap& tempoMap);
 
 		kson::Dict<ksmaudio::AudioEffect::ParamValueSetDict> currentActiveAudioEffectsFX(
 			const std::array<Optional<std::pair<kson::Pulse, kson::Interval>>, kson::kNumFXLanesSZ>& longNoteOfLanes, kson::Pulse currentPulseForAudio) const;
 		
 	public:
-		AudioEffectMain(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache);
+		explicit AudioEffectMain(const kson::ChartData& chartData);
 
-		void update(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const AudioEffectInputStatus& inputStatus);
+		void update(BGM& bgm, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const TempoMap& tempoMap, const FrameTiming& frameTiming, const AudioEffectInputStatus& inputStatus);
 	};
 }
@@ -38,7 +38,7 @@ namespace
 		return timingSet;
 	}
 
-	std::set<float> PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(const kson::AudioEffectDef& def, std::int64_t totalMeasures, const kson::ChartData& chartData, const kson::TimingCache& timingCache)
+	std::set<float> PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(const kson::AudioEffectDef& def, std::int64_t totalMeasures, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const MusicGame::TempoMap& tempoMap)
 	{
 		const kson::RelPulse defDy = UpdatePeriodDy(def.v.contains(kUpdatePeriodKey) ? def.v.at(kUpdatePeriodKey) : kUpdatePeriodDefault);
 		if (defDy <= 0)
@@ -47,30 +47,32 @@ namespace
 		}
 
 		std::set<float> timingSet;
+		MusicGame::TempoMap::Cursor tempoMapCursor(tempoMap);
 		for (std::int64_t measureIdx = 0; measureIdx < totalMeasures; ++measureIdx)
 		{
 			const auto [startY, endY] = MeasurePulsePair(measureIdx, chartData.beat, timingCache);
 			for (kson::Pulse y = startY; y < endY; y += defDy)
 			{
-				const float sec = static_cast<float>(kson::PulseToSec(y, chartData.beat, timingCache));
+				const float sec = static_cast<float>(tempoMapCursor.pulseToSec(y));
 				timingSet.insert(sec);
 			}
 		}
 		return timingSet;
 	}
 
-	std::set<float> PrecalculateUpdateTriggerTimingRetrigger(const kson::AudioEffectDef& def, const kson::Dict<kson::ByPulse<std::string>>& paramChange, std::int64_t totalMeasures, const kson::ChartData& chartData, const kson::TimingCache& timingCache)
+	std::set<float> PrecalculateUpdateTriggerTimingRetrigger(const kson::AudioEffectDef& def, const kson::Dict<kson::ByPulse<std::string>>& paramChange, std::int64_t totalMeasures, const kson::ChartData& chartData, const kson::TimingCache& timingCache, const MusicGame::TempoMap& tempoMap)
 	{
 		// Note: The edge case behavior of UpdatePeriod is different from HSP version, but is intended.
 
 		if (!paramChange.contains(kUpdatePeriodKey) || paramChange.at(kUpdatePeriodKey).empty())
 		{
-			return PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(def, totalMeasures, chartData, timingCache);
+			return PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(def, totalMeasures, chartData, timingCache, tempoMap);
 		}
 
 		const kson::RelPulse defDy = UpdatePeriodDy(def.v.contains(kUpdatePeriodKey) ? def.v.at(kUpdatePeriodKey) : kUpdatePeriodDefault);
 		const auto& updatePeriodChanges = paramChange.at(kUpdatePeriodKey);
 		std::set<float> timingSet;
+		MusicGame::TempoMap::Cursor tempoMapCursor(tempoMap);
 		for (std::int64_t measureIdx = 0; measureIdx < totalMeasures; ++measureIdx)
 		{
 			const auto [startY, endY] = MeasurePulsePair(measureIdx, chartData.beat, timingCache);
@@ -82,7 +84,7 @@ namespace
 				{
 					for (kson::Pulse y = startY; y < endY; y += dy)
 					{
-						const float sec = static_cast<float>(kson::PulseToSec(y, chartData.beat, timingCache));
+						const float sec = static_cast<float>(tempoMapCursor.pulseToSec(y));
 						timingSet.insert(sec);
 					}
 				}
@@ -96,7 +98,7 @@ namespace
 					const kson::RelPulse dy = ParamChangeUpdatePeriodDyAt(updatePeriodChanges, y, defDy);
 					if (ry % dy == 0)
 					{
-						const float sec = static_cast<float>(kson::PulseToSec(y, chartData.beat, timingCache));
+						const float sec = static_cast<float>(tempoMapCursor.pulseToSec(y));
 						timingSet.insert(sec);
 					}
 				}
@@ -113,13 +115,14 @@ namespace MusicGame::Audio::AudioEffectUtils
 		const kson::Dict<kson::ByPulse<std::string>>& paramChange,
 		std::int64_t totalMeasures,
 		const kson::ChartData& chartData,
-		const kson::TimingCache& timingCache)
+		const kson::TimingCache& timingCache,
+		const TempoMap& tempoMap)
 	{
 		switch (def.type)
 		{
 		case kson::AudioEffectType::Retrigger:
 		case kson::AudioEffectType::Echo:
-			return PrecalculateUpdateTriggerTimingRetrigger(def, paramChange, totalMeasures, chartData, timingCache);
+			return PrecalculateUpdateTriggerTimingRetrigger(def, paramChange, totalMeasures, chartData, timingCache, tempoMap);
 
 		case kson::AudioEffectType::Gate:
 		case kson::AudioEffectType::Wobble:
@@ -135,13 +138,14 @@ namespace MusicGame::Audio::AudioEffectUtils
 		const kson::AudioEffectDef& def,
 		std::int64_t totalMeasures,
 		const kson::ChartData& chartData,
-		const kson::TimingCache& timingCache)
+		const kson::TimingCache& timingCache,
+		const TempoMap& tempoMap)
 	{
 		switch (def.type)
 		{
 		case kson::AudioEffectType::Retrigger:
 		case kson::AudioEffectType::Echo:
-			return PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(def, totalMeasures, chartData, timingCache);
+			return PrecalculateUpdateTriggerTimingRetriggerWithoutParamChange(def, totalMeasures, chartData, timingCache, tempoMap);
 
 		case kson::AudioEffectType::Gate:
 		case kson::AudioEffectType::Wobble:
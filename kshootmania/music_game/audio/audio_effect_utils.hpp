@@ -2,6 +2,7 @@
 #include "kson/chart_data.hpp"
 #include "kson/util/timing_utils.hpp"
 #include "ksmaudio/ksmaudio.hpp"
+#include "music_game/tempo_map.hpp"
 
 namespace MusicGame::Audio::AudioEffectUtils
 {
@@ -10,11 +11,13 @@ namespace MusicGame::Audio::AudioEffectUtils
 		const kson::Dict<kson::ByPulse<std::string>>& paramChange,
 		std::int64_t totalMeasures,
 		const kson::ChartData& chartData,
-		const kson::TimingCache& timingCache);
+		const kson::TimingCache& timingCache,
+		const TempoMap& tempoMap);
 
 	std::set<float> PrecalculateUpdateTriggerTiming(
 		const kson::AudioEffectDef& def,
 		std::int64_t totalMeasures,
 		const kson::ChartData& chartData,
-		const kson::TimingCache& timingCache);
+		const kson::TimingCache& timingCache,
+		const TempoMap& tempoMap);
 }
@@ -9,6 +9,12 @@ namespace
 void MusicGame::Audio::BGM::emplaceAudioEffectImpl(bool isFX, const std::string& name, const kson::AudioEffectDef& def, const std::set<float>& updateTriggerTiming)
 {
 	const auto pAudioEffectBus = isFX ? m_pAudioEffectBusFX : m_pAudioEffectBusLaser;
+	if (pAudioEffectBus == nullptr)
+	{
+		assert(false && "BGM::emplaceAudioEffectXXX() must not be called before the stream is loaded");
+		return;
+	}
+
 	switch (def.type)
 	{
 	case kson::AudioEffectType::Retrigger:
@@ -33,18 +39,49 @@ void MusicGame::Audio::BGM::emplaceAudioEffectImpl(bool isFX, const std::string&
 	}
 }
 
-MusicGame::Audio::BGM::BGM(FilePathView filePath)
-	: m_stream(filePath.toUTF8())
-	, m_durationSec(m_stream.durationSec())
-	, m_pAudioEffectBusFX(m_stream.emplaceAudioEffectBus())
-	, m_pAudioEffectBusLaser(m_stream.emplaceAudioEffectBus())
-	, m_stopwatch(StartImmediately::No)
+void MusicGame::Audio::BGM::onStreamLoaded(std::unique_ptr<ksmaudio::StreamWithEffects>&& stream)
+{
+	m_stream = std::move(stream);
+	m_durationSec = m_stream->durationSec();
+	m_pAudioEffectBusFX = m_stream->emplaceAudioEffectBus();
+	m_pAudioEffectBusLaser = m_stream->emplaceAudioEffectBus();
+
+	if (const std::size_t preloadedBytes = m_stream->preloadedBytes(); preloadedBytes > 0U)
+	{
+		// Note: The peak is larger than the preloaded size if the audio was resampled, because the source image is kept until resampling is finished
+		Logger << U"[BGM] Preloaded into memory: {:.1f} MiB (peak while decoding: {:.1f} MiB)"_fmt(preloadedBytes / (1024.0 * 1024.0), m_stream->preloadPeakBytes() / (1024.0 * 1024.0));
+
+		const auto cacheStats = ksmaudio::DecodedAudioCache::GetStats();
+		Logger << U"[BGM] Decoded audio cache: hits={} misses={} evictions={}"_fmt(cacheStats.numHits, cacheStats.numMisses, cacheStats.numEvictions);
+	}
+}
+
+void MusicGame::Audio::BGM::waitForStream()
+{
+	if (m_stream != nullptr)
+	{
+		return;
+	}
+
+	// Note: This blocks only if the loading is not finished within the time before start
+	onStreamLoaded(m_streamTask.get());
+}
+
+MusicGame::Audio::BGM::BGM(FilePathView filePath, bool preload, double speed, bool decodeOnly)
+	: m_streamTask(Async([filePathUTF8 = filePath.toUTF8(), preload, speed, decodeOnly] { return std::make_unique<ksmaudio::StreamWithEffects>(filePathUTF8, preload, speed, decodeOnly); }))
+	, m_speed(speed)
+	, m_stopwatch(speed, StartImmediately::No)
 	, m_manualUpdateStopwatch(StartImmediately::Yes)
 {
 }
 
 void MusicGame::Audio::BGM::update()
 {
+	if (m_stream == nullptr && m_streamTask.isReady())
+	{
+		onStreamLoaded(m_streamTask.get());
+	}
+
 	if (m_isPaused)
 	{
 		return;
@@ -54,10 +91,10 @@ void MusicGame::Audio::BGM::update()
 	{
 		if (m_manualUpdateStopwatch.sF() >= kManualUpdateIntervalSec)
 		{
-			m_stream.updateManually();
+			m_stream->updateManually();
 			m_manualUpdateStopwatch.restart();
 		}
-		m_timeSec = m_stream.posSec();
+		m_timeSec = m_stream->posSec();
 
 		if (m_timeSec < m_durationSec - kBlendTimeSec)
 		{
@@ -71,15 +108,36 @@ void MusicGame::Audio::BGM::update()
 
 		if (m_timeSec >= 0.0)
 		{
-			m_stream.seekPosSec(m_timeSec);
-			m_stream.play();
+			waitForStream();
+			m_stream->seekPosSec(m_timeSec);
+			m_stream->play();
 			m_isStreamStarted = true;
 		}
 	}
 }
 
+void MusicGame::Audio::BGM::decodeHeadless(double durationSec)
+{
+	waitForStream();
+
+	const std::size_t numChannels = m_stream->numChannels();
+	const auto numFrames = static_cast<std::size_t>(durationSec * m_stream->sampleRate());
+	if (numChannels == 0U || numFrames == 0U)
+	{
+		return;
+	}
+
+	m_decodeBuffer.resize(numFrames * numChannels);
+	m_stream->decode(m_decodeBuffer.data(), numFrames);
+}
+
 void MusicGame::Audio::BGM::updateAudioEffectFX(bool bypass, const ksmaudio::AudioEffect::Status& status, const kson::Dict<ksmaudio::AudioEffect::ParamValueSetDict>& activeAudioEffects)
 {
+	if (m_pAudioEffectBusFX == nullptr)
+	{
+		return;
+	}
+
 	m_pAudioEffectBusFX->setBypass(bypass);
 	m_pAudioEffectBusFX->update(
 		status,
@@ -97,7 +155,7 @@ void MusicGame::Audio::BGM::pause()
 {
 	if (m_isStreamStarted)
 	{
-		m_stream.pause();
+		m_stream->pause();
 	}
 	m_stopwatch.pause();
 	m_isPaused = true;
@@ -105,13 +163,16 @@ void MusicGame::Audio::BGM::pause()
 
 void MusicGame::Audio::BGM::seekPosSec(double posSec)
 {
-	if (posSec < 0.0)
-	{
-		m_stream.stop();
-	}
-	else
+	if (m_stream != nullptr)
 	{
-		m_stream.seekPosSec(posSec);
+		if (posSec < 0.0)
+		{
+			m_stream->stop();
+		}
+		else
+		{
+			m_stream->seekPosSec(posSec);
+		}
 	}
 	m_timeSec = posSec;
 	m_stopwatch.set(SecondsF{ posSec });
@@ -141,6 +202,11 @@ double MusicGame::Audio::BGM::posSec() const
 	return m_timeSec;
 }
 
+bool MusicGame::Audio::BGM::isStreamReady() const
+{
+	return m_stream != nullptr;
+}
+
 double MusicGame::Audio::BGM::durationSec() const
 {
 	return m_durationSec;
@@ -148,7 +214,45 @@ double MusicGame::Audio::BGM::durationSec() const
 
 double MusicGame::Audio::BGM::latencySec() const
 {
-	return m_stream.latencySec();
+	if (m_stream == nullptr)
+	{
+		return 0.0;
+	}
+	return m_stream->latencySec();
+}
+
+double MusicGame::Audio::BGM::speed() const
+{
+	return m_speed;
+}
+
+ksmaudio::DSPLoadSnapshot MusicGame::Audio::BGM::dspLoadSnapshot() const
+{
+	if (m_stream == nullptr)
+	{
+		return {};
+	}
+	return m_stream->totalLoadSnapshot();
+}
+
+std::vector<std::pair<std::string, ksmaudio::DSPLoadSnapshot>> MusicGame::Audio::BGM::audioEffectDSPLoadSnapshots() const
+{
+	if (m_stream == nullptr)
+	{
+		return {};
+	}
+	return m_stream->audioEffectLoadSnapshots();
+}
+
+Array<String> MusicGame::Audio::BGM::dspLoadReportLines() const
+{
+	Array<String> lines;
+	lines.push_back(U"[DSP load] total: {}"_fmt(Unicode::FromUTF8(ksmaudio::DSPLoadSnapshotToString(dspLoadSnapshot()))));
+	for (const auto& [name, snapshot] : audioEffectDSPLoadSnapshots())
+	{
+		lines.push_back(U"[DSP load] {}: {}"_fmt(Unicode::FromUTF8(name), Unicode::FromUTF8(ksmaudio::DSPLoadSnapshotToString(snapshot))));
+	}
+	return lines;
 }
 
 void MusicGame::Audio::BGM::emplaceAudioEffectFX(const std::string& name, const kson::AudioEffectDef& def, const std::set<float>& updateTriggerTiming)
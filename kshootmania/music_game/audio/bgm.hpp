@@ -7,15 +7,24 @@ namespace MusicGame::Audio
 	class BGM
 	{
 	private:
-		ksmaudio::StreamWithEffects m_stream;
-		const double m_durationSec;
+		// Note: The stream is opened (and prescanned) on a worker thread so that long files do not block the scene transition.
+		//       It is waited for only when the playback actually needs to start.
+		AsyncTask<std::unique_ptr<ksmaudio::StreamWithEffects>> m_streamTask;
+		std::unique_ptr<ksmaudio::StreamWithEffects> m_stream;
+		double m_durationSec = 0.0;
 		double m_timeSec = 0.0;
 		bool m_isStreamStarted = false;
 		bool m_isPaused = true;
-		ksmaudio::AudioEffect::AudioEffectBus* const m_pAudioEffectBusFX;
-		ksmaudio::AudioEffect::AudioEffectBus* const m_pAudioEffectBusLaser;
-		Stopwatch m_stopwatch;
+		ksmaudio::AudioEffect::AudioEffectBus* m_pAudioEffectBusFX = nullptr;
+		ksmaudio::AudioEffect::AudioEffectBus* m_pAudioEffectBusLaser = nullptr;
+		const double m_speed;
+		VariableSpeedStopwatch m_stopwatch;
 		Stopwatch m_manualUpdateStopwatch;
+		std::vector<float> m_decodeBuffer;
+
+		void onStreamLoaded(std::unique_ptr<ksmaudio::StreamWithEffects>&& stream);
+
+		void waitForStream();
 
 		void emplaceAudioEffectImpl(
 			bool isFX,
@@ -24,10 +33,15 @@ namespace MusicGame::Audio
 			const std::set<float>& updateTriggerTiming);
 
 	public:
-		explicit BGM(FilePathView filePath);
+		// Note: If speed is not 1, the BGM is time-stretched and all times (e.g., posSec()) are in the chart time.
+		// Note: If decodeOnly is true, the BGM is never played on the output device, and is rendered only by decodeHeadless().
+		BGM(FilePathView filePath, bool preload, double speed = 1.0, bool decodeOnly = false);
 
 		void update();
 
+		// Renders the next durationSec of a decode-only BGM through all audio effects (used by the headless runners to measure the DSP load)
+		void decodeHeadless(double durationSec);
+
 		void updateAudioEffectFX(bool bypass, const ksmaudio::AudioEffect::Status& status, const kson::Dict<ksmaudio::AudioEffect::ParamValueSetDict>& activeAudioEffects);
 
 		void play();
@@ -38,10 +52,23 @@ namespace MusicGame::Audio
 
 		double posSec() const;
 
+		// Returns whether the stream has been loaded
+		// (durationSec() and emplaceAudioEffectXXX() are available only after this returns true)
+		bool isStreamReady() const;
+
 		double durationSec() const;
 
 		double latencySec() const;
 
+		double speed() const;
+
+		ksmaudio::DSPLoadSnapshot dspLoadSnapshot() const;
+
+		std::vector<std::pair<std::string, ksmaudio::DSPLoadSnapshot>> audioEffectDSPLoadSnapshots() const;
+
+		// Lines of the total and per-effect DSP load for the log and the headless runners
+		Array<String> dspLoadReportLines() const;
+
 		void emplaceAudioEffectFX(
 			const std::string& name,
 			const kson::AudioEffectDef& def,
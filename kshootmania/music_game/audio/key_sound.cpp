@@ -0,0 +1,120 @@
+﻿#include "key_sound.hpp"
+
+namespace
+{
+	FilePath KeySoundFilePath(const std::string& name, FilePathView parentPath)
+	{
+		const String nameStr = Unicode::FromUTF8(name);
+		if (FileSystem::Extension(nameStr).empty())
+		{
+			// Built-in key sounds
+			return U"se/note/{}.wav"_fmt(nameStr);
+		}
+		return FileSystem::PathAppend(parentPath, nameStr);
+	}
+}
+
+MusicGame::Audio::KeySound::KeySound(const kson::ChartData& chartData, const TempoMap& tempoMap, FilePathView parentPath, ksmaudio::SEMixer& seMixer)
+{
+	for (const auto& [name, lanes] : chartData.audio.keySound.fx.chipEvent)
+	{
+		const ksmaudio::SEMixer::SoundID soundID = seMixer.loadSound(KeySoundFilePath(name, parentPath).toUTF8());
+		if (soundID == ksmaudio::SEMixer::kInvalidSoundID)
+		{
+			Logger << U"[KeySound] Could not load key sound: {}"_fmt(Unicode::FromUTF8(name));
+			continue;
+		}
+
+		for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+		{
+			for (const auto& [y, invoke] : lanes[i])
+			{
+				m_fxChipEvents[i].push_back({ .y = y, .timeSec = 0.0, .soundID = soundID, .volume = static_cast<float>(invoke.vol) });
+			}
+		}
+	}
+
+	for (auto& events : m_fxChipEvents)
+	{
+		std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.y < b.y; });
+
+		// Convert the pulses in one batch
+		std::vector<kson::Pulse> pulses(events.size());
+		std::transform(events.begin(), events.end(), pulses.begin(), [](const Event& event) { return event.y; });
+		const std::vector<double> secs = tempoMap.convert(pulses);
+		for (std::size_t i = 0U; i < events.size(); ++i)
+		{
+			events[i].timeSec = secs[i];
+		}
+	}
+}
+
+void MusicGame::Audio::KeySound::seek(double currentTimeSec)
+{
+	for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+	{
+		auto& events = m_fxChipEvents[i];
+		const auto itr = std::lower_bound(events.begin(), events.end(), currentTimeSec, [](const Event& event, double sec) { return event.timeSec < sec; });
+		for (auto it = itr; it != events.end(); ++it)
+		{
+			it->isResolved = false;
+		}
+		m_fxCursors[i] = static_cast<std::size_t>(itr - events.begin());
+	}
+}
+
+void MusicGame::Audio::KeySound::update(const FrameTiming& frameTiming, const Judgment::JudgmentMain& judgmentMain, SEScheduler& seScheduler)
+{
+	const double currentTimeSec = frameTiming.currentTimeSec;
+	const kson::Pulse lookaheadPulse = frameTiming.seLookaheadPulse;
+
+	if (SEScheduler::IsTimeJump(m_prevTimeSec, currentTimeSec))
+	{
+		seek(currentTimeSec);
+	}
+	m_prevTimeSec = currentTimeSec;
+
+	for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+	{
+		auto& events = m_fxChipEvents[i];
+
+		// Note: Notes can be judged out of order (e.g., a later note is hit while an earlier one is still within the timing window),
+		//       so all events up to the lookahead are checked
+		for (std::size_t eventIdx = m_fxCursors[i]; eventIdx < events.size() && events[eventIdx].y <= lookaheadPulse; ++eventIdx)
+		{
+			Event& event = events[eventIdx];
+			if (event.isResolved)
+			{
+				continue;
+			}
+
+			const Optional<Judgment::JudgmentResult> result = judgmentMain.fxChipNoteResult(i, event.y, currentTimeSec);
+			if (!result.has_value())
+			{
+				// No chip note at the pulse, so the key sound is played regardless of the judgment
+				if (event.timeSec >= currentTimeSec)
+				{
+					seScheduler.schedule(event.soundID, event.timeSec, event.volume);
+				}
+				event.isResolved = true;
+			}
+			else if (*result == Judgment::JudgmentResult::kCritical || *result == Judgment::JudgmentResult::kNear)
+			{
+				// Note: The note is judged at the time of the key press, so a late hit is played immediately
+				seScheduler.schedule(event.soundID, Max(event.timeSec, currentTimeSec), event.volume);
+				event.isResolved = true;
+			}
+			else if (*result == Judgment::JudgmentResult::kError)
+			{
+				// Muted
+				event.isResolved = true;
+			}
+		}
+
+		auto& cursor = m_fxCursors[i];
+		while (cursor < events.size() && events[cursor].isResolved)
+		{
+			++cursor;
+		}
+	}
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "music_game/frame_timing.hpp"
+#include "music_game/tempo_map.hpp"
+#include "se_scheduler.hpp"
+#include "music_game/judgment/judgment_main.hpp"
+#include "kson/chart_data.hpp"
+#include "kson/util/timing_utils.hpp"
+
+namespace MusicGame::Audio
+{
+	// Key sounds of FX chip notes (kson "audio.key_sound.fx.chip_event")
+	// Note: Key sounds on notes are played only if the note is hit (critical or near), so missed notes are muted.
+	//       If a note is hit before its time, the key sound is still pre-queued at the exact time of the note.
+	class KeySound
+	{
+	private:
+		struct Event
+		{
+			kson::Pulse y;
+			double timeSec;
+			ksmaudio::SEMixer::SoundID soundID;
+			float volume;
+
+			// Whether the key sound has been scheduled or muted
+			bool isResolved = false;
+		};
+
+		// Sorted by pulse
+		std::array<std::vector<Event>, kson::kNumFXLanesSZ> m_fxChipEvents;
+
+		// Index of the first event not resolved yet
+		std::array<std::size_t, kson::kNumFXLanesSZ> m_fxCursors = { 0U, 0U };
+
+		double m_prevTimeSec = kPastTimeSec;
+
+		void seek(double currentTimeSec);
+
+	public:
+		KeySound(const kson::ChartData& chartData, const TempoMap& tempoMap, FilePathView parentPath, ksmaudio::SEMixer& seMixer);
+
+		void update(const FrameTiming& frameTiming, const Judgment::JudgmentMain& judgmentMain, SEScheduler& seScheduler);
+	};
+}
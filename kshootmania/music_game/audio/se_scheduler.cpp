@@ -0,0 +1,45 @@
+﻿#include "se_scheduler.hpp"
+
+namespace
+{
+	constexpr double kSmoothingRate = 0.05;
+
+	// The offset is reset instead of smoothed if it changes more than this (e.g., BGM start or seek)
+	constexpr double kResetThresholdSec = 0.05;
+}
+
+MusicGame::Audio::SEScheduler::SEScheduler(ksmaudio::SEMixer& seMixer, double playSpeed)
+	: m_seMixer(seMixer)
+	, m_framesPerSongSec(static_cast<double>(seMixer.sampleRate()) / playSpeed)
+{
+}
+
+bool MusicGame::Audio::SEScheduler::IsTimeJump(double prevTimeSec, double currentTimeSec)
+{
+	return currentTimeSec < prevTimeSec || currentTimeSec - prevTimeSec > kLookaheadSec;
+}
+
+void MusicGame::Audio::SEScheduler::update(double currentTimeSec)
+{
+	const double frameOffset = static_cast<double>(m_seMixer.playbackFrame()) - currentTimeSec * m_framesPerSongSec;
+	if (!m_frameOffset.has_value() || Abs(frameOffset - *m_frameOffset) > kResetThresholdSec * m_seMixer.sampleRate())
+	{
+		m_frameOffset = frameOffset;
+	}
+	else
+	{
+		*m_frameOffset += (frameOffset - *m_frameOffset) * kSmoothingRate;
+	}
+}
+
+void MusicGame::Audio::SEScheduler::schedule(ksmaudio::SEMixer::SoundID soundID, double timeSec, float gain)
+{
+	if (!m_frameOffset.has_value()) [[unlikely]]
+	{
+		m_seMixer.play(soundID, gain);
+		return;
+	}
+
+	const double startFrame = timeSec * m_framesPerSongSec + *m_frameOffset;
+	m_seMixer.playAt(soundID, startFrame > 0.0 ? static_cast<std::uint64_t>(startFrame) : 0U, gain);
+}
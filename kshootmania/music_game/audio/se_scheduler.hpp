@@ -0,0 +1,33 @@
+﻿#pragma once
+#include "ksmaudio/se_mixer.hpp"
+
+namespace MusicGame::Audio
+{
+	// Converts song time into the output frame index of the SE mixer, so that sound effects are pre-queued and start at the exact sample
+	class SEScheduler
+	{
+	public:
+		// Note: This must be longer than the output buffer length because the mixer renders ahead of the playback position.
+		static constexpr double kLookaheadSec = 0.5;
+
+		// Returns whether the frame time went backwards or jumped forward past the lookahead (e.g., seek),
+		// in which case the cursors of the users must be re-seeked to the current time
+		static bool IsTimeJump(double prevTimeSec, double currentTimeSec);
+
+	private:
+		ksmaudio::SEMixer& m_seMixer;
+
+		// Output frames per second of the song time (sample rate / play speed)
+		const double m_framesPerSongSec;
+
+		// Mixer playback frame minus song time in frames (smoothed to absorb the jitter of position reporting)
+		Optional<double> m_frameOffset;
+
+	public:
+		SEScheduler(ksmaudio::SEMixer& seMixer, double playSpeed = 1.0);
+
+		void update(double currentTimeSec);
+
+		void schedule(ksmaudio::SEMixer::SoundID soundID, double timeSec, float gain = 1.0f);
+	};
+}
@@ -0,0 +1,410 @@
+﻿#include "autoplay_benchmark.hpp"
+#include "music_game/game_defines.hpp"
+#include "music_game/game_status.hpp"
+#include "music_game/frame_timing.hpp"
+#include "music_game/graph_evaluator.hpp"
+#include "music_game/judgment/judgment_main.hpp"
+#include "music_game/audio/bgm.hpp"
+#include "music_game/audio/se_scheduler.hpp"
+#include "music_game/audio/assist_tick.hpp"
+#include "music_game/audio/audio_effect_main.hpp"
+#include "music_game/graphics/graphics_main.hpp"
+#include "kson/io/ksh_io.hpp"
+#include "kson/util/graph_utils.hpp"
+#include <Siv3D/Windows/Windows.hpp>
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
+namespace MusicGame::Benchmark
+{
+	namespace
+	{
+		constexpr std::size_t kNumSEVoices = 16U;
+
+		// Duration of the key press for chip notes
+		constexpr double kChipPressSec = 0.03;
+
+		// Margin after the last note
+		constexpr double kEndMarginSec = 1.0;
+
+		enum Subsystem : std::size_t
+		{
+			kJudgment = 0,
+			kGraph,
+			kAudioEffect,
+			kDSP,
+			kAssistTick,
+			kGraphics,
+
+			kNumSubsystems,
+		};
+
+		constexpr std::array<StringView, kNumSubsystems> kSubsystemNames = {
+			U"judgment",
+			U"graph",
+			U"audio_effect",
+			U"dsp",
+			U"assist_tick",
+			U"graphics",
+		};
+
+		// Maximum error allowed between the optimized evaluators (TempoMap, GraphEvaluator) and kson
+		constexpr double kMaxEquivalenceError = 1e-6;
+
+		struct EquivalenceErrors
+		{
+			double tempoMapSec = 0.0;
+			double graph = 0.0;
+		};
+
+		// Compares TempoMap with kson at the tempo changes and the start/end of the button notes
+		double MaxTempoMapError(const kson::ChartData& chartData, const TempoMap& tempoMap, const kson::TimingCache& timingCache)
+		{
+			std::vector<kson::Pulse> pulses;
+			for (const auto& [y, _] : chartData.beat.bpm)
+			{
+				pulses.push_back(y);
+			}
+			for (const auto& lanes : { std::span<const kson::ByPulse<kson::Interval>>(chartData.note.bt), std::span<const kson::ByPulse<kson::Interval>>(chartData.note.fx) })
+			{
+				for (const auto& lane : lanes)
+				{
+					for (const auto& [y, note] : lane)
+					{
+						pulses.push_back(y);
+						pulses.push_back(y + note.length);
+					}
+				}
+			}
+			std::sort(pulses.begin(), pulses.end());
+			return MaxTempoMapErrorSec(tempoMap, pulses, chartData.beat, timingCache);
+		}
+
+		// Compares GraphEvaluator with kson at the points of the lasers and next to them
+		double MaxGraphEvaluatorError(const kson::ChartData& chartData)
+		{
+			GraphEvaluator graphEvaluator(chartData);
+			double maxError = 0.0;
+			for (std::size_t i = 0U; i < kson::kNumLaserLanesSZ; ++i)
+			{
+				for (const auto& [y, laserSection] : chartData.note.laser[i])
+				{
+					for (const auto& [ry, _] : laserSection.v)
+					{
+						for (const kson::Pulse pulse : { y + ry - 1, y + ry, y + ry + 1 })
+						{
+							const double expected = kson::GraphSectionValueAtWithDefault(chartData.note.laser[i], pulse, -1.0);
+							const double actual = graphEvaluator.evaluate(pulse)[GraphEvaluator::kLeftLaser + i].value_or(-1.0);
+							maxError = Max(maxError, Abs(expected - actual));
+						}
+					}
+				}
+			}
+			return maxError;
+		}
+
+		// Press/release events that hit every note at the exact timing
+		Array<Judgment::KeyEvent> CreateAutoplayKeyEvents(const kson::ByPulse<kson::Interval>& lane, const TempoMap& tempoMap)
+		{
+			Array<Judgment::KeyEvent> keyEvents;
+			for (auto itr = lane.begin(); itr != lane.end(); ++itr)
+			{
+				const auto& [y, note] = *itr;
+				const double startSec = tempoMap.pulseToSec(y);
+				double endSec = (note.length == 0) ? startSec + kChipPressSec : tempoMap.pulseToSec(y + note.length);
+
+				// Release before the next note
+				if (const auto nextItr = std::next(itr); nextItr != lane.end())
+				{
+					endSec = Min(endSec, (startSec + tempoMap.pulseToSec(nextItr->first)) / 2);
+				}
+
+				keyEvents.push_back({ .isPressed = true, .timeSec = startSec, .pulse = y });
+				keyEvents.push_back({ .isPressed = false, .timeSec = endSec, .pulse = tempoMap.secToPulse(endSec) });
+			}
+			return keyEvents;
+		}
+
+		// Press/release events of the left and right laser keys that follow every laser and slam
+		std::array<Array<Judgment::KeyEvent>, 2> CreateAutoplayLaserKeyEvents(const kson::ByPulse<kson::LaserSection>& lane, const TempoMap& tempoMap)
+		{
+			std::array<Array<Judgment::KeyEvent>, 2> keyEvents;
+			int32 prevDirection = 0;
+			const auto setDirection = [&](int32 direction, double sec)
+			{
+				if (direction == prevDirection)
+				{
+					return;
+				}
+				const kson::Pulse pulse = tempoMap.secToPulse(sec);
+				if (prevDirection != 0)
+				{
+					keyEvents[prevDirection > 0 ? 1 : 0].push_back({ .isPressed = false, .timeSec = sec, .pulse = pulse });
+				}
+				if (direction != 0)
+				{
+					keyEvents[direction > 0 ? 1 : 0].push_back({ .isPressed = true, .timeSec = sec, .pulse = pulse });
+				}
+				prevDirection = direction;
+			};
+
+			for (const auto& [y, laserSection] : lane)
+			{
+				for (auto itr = laserSection.v.begin(); itr != laserSection.v.end(); ++itr)
+				{
+					const auto& [ry, point] = *itr;
+					const double sec = tempoMap.pulseToSec(y + ry);
+					const auto nextItr = std::next(itr);
+					const double nextSec = (nextItr == laserSection.v.end()) ? sec + kChipPressSec : tempoMap.pulseToSec(y + nextItr->first);
+					const double nextValue = (nextItr == laserSection.v.end()) ? point.vf : nextItr->second.v;
+					const int32 segmentDirection = (nextValue > point.vf) - (nextValue < point.vf);
+
+					if (point.v != point.vf)
+					{
+						setDirection(point.v < point.vf ? 1 : -1, sec);
+						setDirection(segmentDirection, Min(sec + kChipPressSec, nextSec));
+					}
+					else
+					{
+						setDirection(segmentDirection, sec);
+					}
+				}
+				if (!laserSection.v.empty())
+				{
+					setDirection(0, tempoMap.pulseToSec(y + laserSection.v.rbegin()->first) + kChipPressSec);
+				}
+			}
+			return keyEvents;
+		}
+
+		struct DurationStats
+		{
+			double p50 = 0.0;
+			double p99 = 0.0;
+			double max = 0.0;
+		};
+
+		std::size_t ProcessWorkingSetBytes()
+		{
+			PROCESS_MEMORY_COUNTERS counters;
+			if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			{
+				return 0U;
+			}
+			return counters.WorkingSetSize;
+		}
+
+		DurationStats CalculateDurationStats(Array<double> durations)
+		{
+			if (durations.empty())
+			{
+				return {};
+			}
+
+			std::sort(durations.begin(), durations.end());
+			const auto percentile = [&durations](double rate)
+			{
+				return durations[Min(static_cast<std::size_t>(durations.size() * rate), durations.size() - 1U)];
+			};
+			return {
+				.p50 = percentile(0.50),
+				.p99 = percentile(0.99),
+				.max = durations.back(),
+			};
+		}
+
+		EquivalenceErrors RunChart(FilePathView chartFilePath, double frameRate, bool parallelDrawList)
+		{
+			// Note: The load time and the memory include the preparation of all subsystems (e.g., judgment tables)
+			const std::size_t workingSetBytesBeforeLoad = ProcessWorkingSetBytes();
+			Stopwatch loadStopwatch(StartImmediately::Yes);
+
+			const FilePath parentPath = FileSystem::ParentPath(chartFilePath);
+			const kson::ChartData chartData = kson::LoadKSHChartData(FilePath{ chartFilePath }.narrow());
+			const kson::TimingCache timingCache = kson::CreateTimingCache(chartData.beat);
+			const TempoMap tempoMap(chartData.beat, timingCache);
+			FrameTimingCalculator frameTimingCalculator(tempoMap);
+
+			// Autoplay input of each lane
+			std::array<Array<Judgment::KeyEvent>, Judgment::kNumJudgmentKeysSZ> autoplayKeyEvents;
+			for (std::size_t i = 0U; i < kson::kNumBTLanesSZ; ++i)
+			{
+				autoplayKeyEvents[i] = CreateAutoplayKeyEvents(chartData.note.bt[i], tempoMap);
+			}
+			for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+			{
+				autoplayKeyEvents[kson::kNumBTLanesSZ + i] = CreateAutoplayKeyEvents(chartData.note.fx[i], tempoMap);
+			}
+			for (std::size_t i = 0U; i < kson::kNumLaserLanesSZ; ++i)
+			{
+				auto [leftKeyEvents, rightKeyEvents] = CreateAutoplayLaserKeyEvents(chartData.note.laser[i], tempoMap);
+				autoplayKeyEvents[Judgment::kNumButtonLanesSZ + i * 2U] = std::move(leftKeyEvents);
+				autoplayKeyEvents[Judgment::kNumButtonLanesSZ + i * 2U + 1U] = std::move(rightKeyEvents);
+			}
+			std::array<std::size_t, Judgment::kNumJudgmentKeysSZ> autoplayCursors = {};
+
+			Judgment::JudgmentMain judgmentMain(chartData, tempoMap, 1.0);
+			GraphEvaluator graphEvaluator(chartData);
+			Audio::BGM bgm(parentPath + U"/" + Unicode::FromUTF8(chartData.audio.bgm.filename), false, 1.0, true);
+			// Note: The SE mixer is decode-only, so that its output clock is advanced by the simulated frames instead of the output device
+			ksmaudio::SEMixer seMixer(ksmaudio::kSampleRate, kNumSEVoices, true);
+			Audio::SEScheduler seScheduler(seMixer);
+			Audio::AssistTick assistTick(true, seMixer);
+			Audio::AudioEffectMain audioEffectMain(chartData);
+			Graphics::GraphicsMain graphicsMain(chartData, parentPath, timingCache, parallelDrawList);
+			GameStatus gameStatus;
+
+			// Note: The BGM is not played on the output device. It is rendered through the audio effects in each frame to measure the DSP load.
+			while (!bgm.isStreamReady())
+			{
+				bgm.update();
+				System::Sleep(1ms);
+			}
+
+			const double loadTimeMs = loadStopwatch.msF();
+			const double loadMemoryMiB = (static_cast<double>(ProcessWorkingSetBytes()) - static_cast<double>(workingSetBytesBeforeLoad)) / (1024.0 * 1024.0);
+
+			kson::Pulse lastPulse = 0;
+			for (const auto& laneKeyEvents : autoplayKeyEvents)
+			{
+				if (!laneKeyEvents.empty())
+				{
+					lastPulse = Max(lastPulse, laneKeyEvents.back().pulse);
+				}
+			}
+			const double startSec = -TimeSecBeforeStart(false);
+			const double endSec = tempoMap.pulseToSec(lastPulse) + kEndMarginSec;
+			const int64 numFrames = static_cast<int64>((endSec - startSec) * frameRate) + 1;
+
+			std::array<Array<double>, kNumSubsystems> durationsUs;
+			for (auto& durations : durationsUs)
+			{
+				durations.reserve(static_cast<std::size_t>(numFrames));
+			}
+
+			std::vector<float> seBuffer;
+			uint64 seRenderedFrames = 0U;
+
+			Judgment::JudgmentKeyEvents keyEvents;
+			const Judgment::LaserKnobEvents knobEvents;
+			for (int64 frameIdx = 0; frameIdx < numFrames; ++frameIdx)
+			{
+				const double currentTimeSec = startSec + frameIdx / frameRate;
+				const FrameTiming frameTiming = frameTimingCalculator.calculate(currentTimeSec, 0.0, Audio::SEScheduler::kLookaheadSec);
+
+				// Judgment
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					gameStatus.currentTimeSec = frameTiming.currentTimeSec;
+					gameStatus.currentPulse = frameTiming.currentPulse;
+					gameStatus.currentBPM = frameTiming.currentBPM;
+					for (std::size_t i = 0U; i < Judgment::kNumJudgmentKeysSZ; ++i)
+					{
+						keyEvents[i].clear();
+						while (autoplayCursors[i] < autoplayKeyEvents[i].size() && autoplayKeyEvents[i][autoplayCursors[i]].timeSec <= currentTimeSec)
+						{
+							keyEvents[i].push_back(autoplayKeyEvents[i][autoplayCursors[i]]);
+							++autoplayCursors[i];
+						}
+					}
+					judgmentMain.update(keyEvents, knobEvents, frameTiming.currentPulse, frameTiming.currentTimeSec, gameStatus);
+					durationsUs[kJudgment].push_back(stopwatch.usF());
+				}
+
+				// Camera and laser graphs
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					ApplyGraphValues(graphEvaluator.evaluate(frameTiming.currentPulse), gameStatus);
+					durationsUs[kGraph].push_back(stopwatch.usF());
+				}
+
+				// Audio effects
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					std::array<Optional<bool>, kson::kNumFXLanesSZ> longFXPressed;
+					for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+					{
+						longFXPressed[i] = gameStatus.fxLaneStatus[i].longNotePressed;
+					}
+					audioEffectMain.update(bgm, chartData, timingCache, tempoMap, frameTiming, {
+						.longFXPressed = longFXPressed,
+					});
+					durationsUs[kAudioEffect].push_back(stopwatch.usF());
+				}
+
+				// Audio effect DSPs (rendered on this thread instead of the audio thread)
+				if (currentTimeSec >= 0.0)
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					bgm.decodeHeadless(1.0 / frameRate);
+					durationsUs[kDSP].push_back(stopwatch.usF());
+				}
+
+				// SE (mixed on this thread instead of the audio thread)
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					seScheduler.update(frameTiming.currentTimeSec);
+					assistTick.update(chartData, tempoMap, frameTiming, seScheduler);
+
+					const auto seEndFrame = static_cast<uint64>((frameIdx + 1) * static_cast<double>(ksmaudio::kSampleRate) / frameRate);
+					const auto seNumFrames = static_cast<std::size_t>(seEndFrame - seRenderedFrames);
+					seBuffer.resize(seNumFrames * ksmaudio::SEMixer::kNumOutputChannels);
+					seRenderedFrames += seMixer.decode(seBuffer.data(), seNumFrames);
+					durationsUs[kAssistTick].push_back(stopwatch.usF());
+				}
+
+				// Graphics (without drawing)
+				{
+					Stopwatch stopwatch(StartImmediately::Yes);
+					graphicsMain.update(chartData, gameStatus, bgm.dspLoadSnapshot());
+					durationsUs[kGraphics].push_back(stopwatch.usF());
+				}
+			}
+
+			Console << U"[Benchmark] {} ({} frames, score:{})"_fmt(chartFilePath, numFrames, judgmentMain.score());
+			Console << U"    load: {:.1f}ms, memory: {:+.1f}MiB"_fmt(loadTimeMs, loadMemoryMiB);
+			for (std::size_t i = 0U; i < kNumSubsystems; ++i)
+			{
+				const DurationStats stats = CalculateDurationStats(durationsUs[i]);
+				Console << U"    {:<12} p50:{:>8.1f}us p99:{:>8.1f}us max:{:>8.1f}us"_fmt(kSubsystemNames[i], stats.p50, stats.p99, stats.max);
+			}
+			for (const auto& line : bgm.dspLoadReportLines())
+			{
+				Console << U"    " << line;
+			}
+
+			// Note: Checked after the frame loop so that the load time and the memory are not affected
+			const EquivalenceErrors errors = {
+				.tempoMapSec = MaxTempoMapError(chartData, tempoMap, timingCache),
+				.graph = MaxGraphEvaluatorError(chartData),
+			};
+			Console << U"    equivalence: tempo_map max error:{:.3g}s ({} segments), graph max error:{:.3g} ({} segments){}"_fmt(
+				errors.tempoMapSec, tempoMap.numSegments(), errors.graph, graphEvaluator.numSegments(),
+				(errors.tempoMapSec < kMaxEquivalenceError && errors.graph < kMaxEquivalenceError) ? U"" : U" MISMATCH");
+			return errors;
+		}
+	}
+
+	void RunAutoplayBenchmark(FilePathView directoryPath, double frameRate, bool parallelDrawList)
+	{
+		const Array<FilePath> chartFilePaths = FileSystem::DirectoryContents(directoryPath, Recursive::Yes)
+			.filter([](const FilePath& path) { return FileSystem::Extension(path) == U"ksh"; });
+
+		Console << U"[Benchmark] {} charts in {} at {:.0f} fps ({} draw list)"_fmt(chartFilePaths.size(), directoryPath, frameRate, parallelDrawList ? U"parallel" : U"serial");
+		EquivalenceErrors maxErrors;
+		std::size_t numMismatches = 0U;
+		for (const auto& chartFilePath : chartFilePaths)
+		{
+			const EquivalenceErrors errors = RunChart(chartFilePath, frameRate, parallelDrawList);
+			maxErrors.tempoMapSec = Max(maxErrors.tempoMapSec, errors.tempoMapSec);
+			maxErrors.graph = Max(maxErrors.graph, errors.graph);
+			if (errors.tempoMapSec >= kMaxEquivalenceError || errors.graph >= kMaxEquivalenceError)
+			{
+				++numMismatches;
+			}
+		}
+		Console << U"[Benchmark] equivalence over all charts: tempo_map max error:{:.3g}s, graph max error:{:.3g}, {} charts above {:.0e}"_fmt(
+			maxErrors.tempoMapSec, maxErrors.graph, numMismatches, kMaxEquivalenceError);
+	}
+}
@@ -0,0 +1,10 @@
+﻿#pragma once
+
+namespace MusicGame::Benchmark
+{
+	// Runs the non-rendering game loop of every chart in the directory with autoplay input, and prints the cost of each subsystem to the console
+	// Note: The time is advanced by a fixed step (1 / frameRate) instead of the audio clock, so the result does not depend on the actual speed.
+	// Note: TempoMap and GraphEvaluator are also compared with kson for each chart, and their max errors are printed.
+	// Note: If parallelDrawList is true, the note draw lists are built on a worker thread in the same way as GameCreateInfo::parallelDrawList.
+	void RunAutoplayBenchmark(FilePathView directoryPath, double frameRate, bool parallelDrawList);
+}
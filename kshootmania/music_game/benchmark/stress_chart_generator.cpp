@@ -0,0 +1,342 @@
+﻿#include "stress_chart_generator.hpp"
+
+namespace MusicGame::Benchmark
+{
+	namespace
+	{
+		// Note: 192 lines per 4/4 measure is the finest resolution that KSH can represent with integer pulses
+		constexpr int32 kLinesPerMeasure = 192;
+
+		constexpr StringView kAudioEffectName = U"StressRetrigger";
+
+		// Laser positions at both ends (KSH uses '0'-'9', 'A'-'Z', 'a'-'o' for 0.0-1.0)
+		constexpr char32 kLaserCharLeftEnd = U'0';
+		constexpr char32 kLaserCharRightEnd = U'o';
+
+		constexpr std::array<StringView, 4> kAudioEffectWaveLengths = { U"1/4", U"1/8", U"1/16", U"1/32" };
+
+		constexpr int32 kInitialBPM = 120;
+
+		constexpr StringView kSilentMusicFilename = U"stress_silence.wav";
+
+		constexpr uint32 kSilentMusicSampleRate = 44100U;
+
+		constexpr uint16 kSilentMusicNumChannels = 2U;
+
+		constexpr uint16 kSilentMusicBitsPerSample = 16U;
+
+		// Margin after the end of the longest chart, so that the music does not end before the play finishes
+		constexpr double kSilentMusicMarginSec = 5.0;
+
+		// Line interval to place the given number of events in a measure
+		int32 LineInterval(int32 eventsPerMeasure)
+		{
+			if (eventsPerMeasure <= 0)
+			{
+				return 0;
+			}
+			return Max(kLinesPerMeasure / Min(eventsPerMeasure, kLinesPerMeasure), 1);
+		}
+
+		bool IsEventLine(int32 lineIdx, int32 interval)
+		{
+			return interval > 0 && lineIdx % interval == 0;
+		}
+
+		// State of a button lane while writing lines
+		struct ButtonLaneWriter
+		{
+			// Remaining lines of the current long note
+			int32 longNoteRemainingLines = 0;
+
+			// Returns the character of the line and whether a long note starts at this line
+			std::pair<char32, bool> next(bool isNoteLine, int32 interval, bool isLongNote, char32 chipChar, char32 longChar)
+			{
+				if (longNoteRemainingLines > 0)
+				{
+					--longNoteRemainingLines;
+					return { longChar, false };
+				}
+				if (!isNoteLine)
+				{
+					return { U'0', false };
+				}
+
+				// Note: A long note is shorter than the interval by one line, so that it is not merged with the next one
+				if (isLongNote && interval >= 3)
+				{
+					longNoteRemainingLines = interval - 2;
+					return { longChar, true };
+				}
+				return { chipChar, false };
+			}
+		};
+	}
+
+	StressChartParams ParseStressChartParams(const Array<String>& options)
+	{
+		StressChartParams params;
+		for (const auto& option : options)
+		{
+			const std::size_t separatorIdx = option.indexOf(U'=');
+			if (separatorIdx == String::npos)
+			{
+				Console << U"[StressChart] Invalid option (expected key=value): {}"_fmt(option);
+				continue;
+			}
+
+			const String key = option.substr(0U, separatorIdx);
+			const String value = option.substr(separatorIdx + 1U);
+			const Optional<int32> intValue = ParseOpt<int32>(value);
+			if (key == U"measures" && intValue.has_value())
+			{
+				params.numMeasures = Max(*intValue, 1);
+			}
+			else if (key == U"bt" && intValue.has_value())
+			{
+				params.btNotesPerMeasure = Max(*intValue, 0);
+			}
+			else if (key == U"fx" && intValue.has_value())
+			{
+				params.fxNotesPerMeasure = Max(*intValue, 0);
+			}
+			else if (key == U"long" && ParseOpt<double>(value).has_value())
+			{
+				params.longNoteRate = Clamp(Parse<double>(value), 0.0, 1.0);
+			}
+			else if (key == U"bpm" && intValue.has_value())
+			{
+				params.bpmChangesPerMeasure = Max(*intValue, 0);
+			}
+			else if (key == U"slam" && intValue.has_value())
+			{
+				params.laserSlamsPerMeasure = Max(*intValue, 0);
+			}
+			else if (key == U"param" && intValue.has_value())
+			{
+				params.audioEffectParamChangesPerMeasure = Max(*intValue, 0);
+			}
+			else if (key == U"seed" && ParseOpt<uint64>(value).has_value())
+			{
+				params.seed = Parse<uint64>(value);
+			}
+			else
+			{
+				Console << U"[StressChart] Unknown or invalid option: {}"_fmt(option);
+			}
+		}
+		return params;
+	}
+
+	String GenerateStressChartKSH(const StressChartParams& params, StringView musicFilename, double* pDurationSec)
+	{
+		SmallRNG rng(params.seed);
+		int32 bpm = kInitialBPM;
+		double durationSec = 0.0;
+
+		String ksh;
+		ksh += U"title=Stress bt:{} fx:{} bpm:{} slam:{} param:{}\n"_fmt(
+			params.btNotesPerMeasure, params.fxNotesPerMeasure, params.bpmChangesPerMeasure, params.laserSlamsPerMeasure, params.audioEffectParamChangesPerMeasure);
+		ksh += U"artist=kshootmania\n";
+		ksh += U"effect=stress chart generator\n";
+		ksh += U"difficulty=infinite\n";
+		ksh += U"level=20\n";
+		ksh += U"t={}\n"_fmt(kInitialBPM);
+		ksh += U"m={}\n"_fmt(musicFilename);
+		ksh += U"o=0\n";
+		ksh += U"beat=4/4\n";
+		ksh += U"ver=171\n";
+		ksh += U"--\n";
+
+		const int32 btInterval = LineInterval(params.btNotesPerMeasure);
+		const int32 fxInterval = LineInterval(params.fxNotesPerMeasure);
+		const int32 bpmInterval = LineInterval(params.bpmChangesPerMeasure);
+		const int32 laserInterval = LineInterval(params.laserSlamsPerMeasure);
+		const int32 paramChangeInterval = LineInterval(params.audioEffectParamChangesPerMeasure);
+
+		std::array<ButtonLaneWriter, kson::kNumBTLanesSZ> btLaneWriters;
+		std::array<ButtonLaneWriter, kson::kNumFXLanesSZ> fxLaneWriters;
+
+		// Line index of the second point of the current laser slam for each laser lane
+		std::array<Optional<int32>, kson::kNumLaserLanesSZ> laserSlamEndLines;
+		std::size_t laserLaneIdx = 0U;
+
+		for (int32 measureIdx = 0; measureIdx < params.numMeasures; ++measureIdx)
+		{
+			for (int32 lineIdx = 0; lineIdx < kLinesPerMeasure; ++lineIdx)
+			{
+				// Options (must be written before the chart line)
+				if (IsEventLine(lineIdx, bpmInterval))
+				{
+					bpm = Random(60, 300, rng);
+					ksh += U"t={}\n"_fmt(bpm);
+				}
+				durationSec += 60.0 * 4 / bpm / kLinesPerMeasure; // 4/4
+				if (IsEventLine(lineIdx, paramChangeInterval))
+				{
+					ksh += U"fx:{}:waveLength={}\n"_fmt(kAudioEffectName, kAudioEffectWaveLengths[Random(kAudioEffectWaveLengths.size() - 1U, rng)]);
+				}
+
+				String line;
+				for (auto& writer : btLaneWriters)
+				{
+					line += writer.next(IsEventLine(lineIdx, btInterval), btInterval, RandomBool(params.longNoteRate, rng), U'1', U'2').first;
+				}
+				line += U'|';
+				for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+				{
+					const auto [c, isLongNoteStart] = fxLaneWriters[i].next(IsEventLine(lineIdx, fxInterval), fxInterval, RandomBool(params.longNoteRate, rng), U'2', U'1');
+					line += c;
+					if (isLongNoteStart)
+					{
+						ksh += U"fx-{}={}\n"_fmt(i == 0U ? U'l' : U'r', kAudioEffectName);
+					}
+				}
+				line += U'|';
+
+				// Laser slams (two points on adjacent lines, alternating the lanes)
+				if (IsEventLine(lineIdx, laserInterval) && !laserSlamEndLines[laserLaneIdx].has_value() && lineIdx + 1 < kLinesPerMeasure)
+				{
+					laserSlamEndLines[laserLaneIdx] = lineIdx + 1;
+					laserLaneIdx = (laserLaneIdx + 1U) % kson::kNumLaserLanesSZ;
+				}
+				for (std::size_t i = 0U; i < kson::kNumLaserLanesSZ; ++i)
+				{
+					if (laserSlamEndLines[i] == lineIdx + 1)
+					{
+						line += (i == 0U) ? kLaserCharLeftEnd : kLaserCharRightEnd;
+					}
+					else if (laserSlamEndLines[i] == lineIdx)
+					{
+						line += (i == 0U) ? kLaserCharRightEnd : kLaserCharLeftEnd;
+						laserSlamEndLines[i] = none;
+					}
+					else
+					{
+						line += U'-';
+					}
+				}
+
+				ksh += line;
+				ksh += U'\n';
+			}
+			ksh += U"--\n";
+		}
+
+		ksh += U"#define_fx {} type=Retrigger;waveLength=1/8;updatePeriod=1/2\n"_fmt(kAudioEffectName);
+
+		if (pDurationSec != nullptr)
+		{
+			*pDurationSec = durationSec;
+		}
+
+		return ksh;
+	}
+
+	bool WriteStressChart(FilePathView filePath, const StressChartParams& params, StringView musicFilename, double* pDurationSec)
+	{
+		TextWriter writer(filePath);
+		if (!writer)
+		{
+			return false;
+		}
+		writer.write(GenerateStressChartKSH(params, musicFilename, pDurationSec));
+		return true;
+	}
+
+	bool WriteSilentWAV(FilePathView filePath, double durationSec)
+	{
+		BinaryWriter writer(filePath);
+		if (!writer)
+		{
+			return false;
+		}
+
+		constexpr uint16 kBlockAlign = kSilentMusicNumChannels * kSilentMusicBitsPerSample / 8U;
+		const auto numFrames = static_cast<uint32>(Max(durationSec, 0.0) * kSilentMusicSampleRate);
+		const uint32 dataBytes = numFrames * kBlockAlign;
+
+		// RIFF header and PCM format chunk
+		writer.write("RIFF", 4);
+		writer.write(static_cast<uint32>(36U + dataBytes));
+		writer.write("WAVEfmt ", 8);
+		writer.write(uint32{ 16U });
+		writer.write(uint16{ 1U }); // PCM
+		writer.write(kSilentMusicNumChannels);
+		writer.write(kSilentMusicSampleRate);
+		writer.write(static_cast<uint32>(kSilentMusicSampleRate * kBlockAlign));
+		writer.write(kBlockAlign);
+		writer.write(kSilentMusicBitsPerSample);
+
+		// Data chunk (written in blocks so that a long file does not need a buffer of its full size)
+		writer.write("data", 4);
+		writer.write(dataBytes);
+		const Array<Byte> zeros(static_cast<std::size_t>(kSilentMusicSampleRate) * kBlockAlign, Byte{ 0 });
+		for (uint32 writtenBytes = 0U; writtenBytes < dataBytes; )
+		{
+			const uint32 blockBytes = Min(dataBytes - writtenBytes, static_cast<uint32>(zeros.size()));
+			writer.write(zeros.data(), blockBytes);
+			writtenBytes += blockBytes;
+		}
+		return true;
+	}
+
+	void GenerateStressChartSet(FilePathView directoryPath, const StressChartParams& baseParams)
+	{
+		Array<std::pair<String, StressChartParams>> charts;
+
+		for (const int32 notesPerMeasure : { 4, 16, 64, 192 })
+		{
+			auto params = baseParams;
+			params.btNotesPerMeasure = notesPerMeasure;
+			params.fxNotesPerMeasure = notesPerMeasure / 4;
+			charts.emplace_back(U"notes_{:03d}"_fmt(notesPerMeasure), params);
+		}
+		for (const int32 bpmChangesPerMeasure : { 1, 4, 16, 64 })
+		{
+			auto params = baseParams;
+			params.bpmChangesPerMeasure = bpmChangesPerMeasure;
+			charts.emplace_back(U"bpm_{:03d}"_fmt(bpmChangesPerMeasure), params);
+		}
+		for (const int32 laserSlamsPerMeasure : { 1, 4, 16, 64 })
+		{
+			auto params = baseParams;
+			params.laserSlamsPerMeasure = laserSlamsPerMeasure;
+			charts.emplace_back(U"slam_{:03d}"_fmt(laserSlamsPerMeasure), params);
+		}
+		for (const int32 paramChangesPerMeasure : { 1, 4, 16, 64 })
+		{
+			auto params = baseParams;
+			params.audioEffectParamChangesPerMeasure = paramChangesPerMeasure;
+			charts.emplace_back(U"param_{:03d}"_fmt(paramChangesPerMeasure), params);
+		}
+
+		FileSystem::CreateDirectories(directoryPath);
+		double maxDurationSec = 0.0;
+		for (const auto& [name, params] : charts)
+		{
+			const FilePath filePath = FileSystem::PathAppend(directoryPath, name + U".ksh");
+			double durationSec = 0.0;
+			if (WriteStressChart(filePath, params, kSilentMusicFilename, &durationSec))
+			{
+				maxDurationSec = Max(maxDurationSec, durationSec);
+				Console << U"[StressChart] {} ({:.0f}s)"_fmt(filePath, durationSec);
+			}
+			else
+			{
+				Console << U"[StressChart] Could not write: {}"_fmt(filePath);
+			}
+		}
+
+		// Note: The charts share one silent music file, so that the BGM (and the audio effects on it) is decoded through the whole play
+		const FilePath musicFilePath = FileSystem::PathAppend(directoryPath, kSilentMusicFilename);
+		if (WriteSilentWAV(musicFilePath, maxDurationSec + kSilentMusicMarginSec))
+		{
+			Console << U"[StressChart] {}"_fmt(musicFilePath);
+		}
+		else
+		{
+			Console << U"[StressChart] Could not write: {}"_fmt(musicFilePath);
+		}
+	}
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+namespace MusicGame::Benchmark
+{
+	// Density of each feature of a generated chart
+	struct StressChartParams
+	{
+		int32 numMeasures = 400;
+
+		// Notes per measure in each lane
+		int32 btNotesPerMeasure = 8;
+		int32 fxNotesPerMeasure = 2;
+
+		// Probability that a note is a long note
+		double longNoteRate = 0.25;
+
+		int32 bpmChangesPerMeasure = 0;
+
+		int32 laserSlamsPerMeasure = 0;
+
+		// Parameter changes of the audio effect used by long FX notes
+		int32 audioEffectParamChangesPerMeasure = 0;
+
+		uint64 seed = 0U;
+	};
+
+	// Parses "key=value" options (measures, bt, fx, long, bpm, slam, param, seed) over the default params
+	// Note: Unknown or invalid options are reported to the console and ignored.
+	StressChartParams ParseStressChartParams(const Array<String>& options);
+
+	// Generates a valid KSH chart for scaling tests, whose music is the given silent WAV file
+	// Note: The length of the chart is written to *pDurationSec if it is not nullptr.
+	String GenerateStressChartKSH(const StressChartParams& params, StringView musicFilename, double* pDurationSec = nullptr);
+
+	bool WriteStressChart(FilePathView filePath, const StressChartParams& params, StringView musicFilename, double* pDurationSec = nullptr);
+
+	// Writes a silent 16-bit stereo WAV file of the given length
+	bool WriteSilentWAV(FilePathView filePath, double durationSec);
+
+	// Writes a set of charts where each feature is scaled up from the base density, and a silent WAV file as long as the longest one
+	// (load with "--benchmark <directoryPath>")
+	void GenerateStressChartSet(FilePathView directoryPath, const StressChartParams& baseParams = {});
+}
@@ -0,0 +1,29 @@
+﻿#include "frame_timing.hpp"
+
+namespace MusicGame
+{
+	FrameTimingCalculator::FrameTimingCalculator(const TempoMap& tempoMap)
+		: m_currentCursor(tempoMap)
+		, m_audioCursor(tempoMap)
+		, m_seLookaheadCursor(tempoMap)
+	{
+	}
+
+	FrameTiming FrameTimingCalculator::calculate(double currentTimeSec, double audioLatencySec, double seLookaheadSec)
+	{
+		FrameTiming frameTiming;
+
+		frameTiming.currentTimeSec = currentTimeSec;
+		frameTiming.currentPulse = m_currentCursor.secToPulse(currentTimeSec);
+		frameTiming.currentBPM = m_currentCursor.currentTempo();
+
+		frameTiming.audioTimeSec = currentTimeSec + audioLatencySec;
+		frameTiming.audioPulse = m_audioCursor.secToPulse(frameTiming.audioTimeSec);
+		frameTiming.audioBPM = m_audioCursor.currentTempo();
+
+		frameTiming.seLookaheadTimeSec = currentTimeSec + seLookaheadSec;
+		frameTiming.seLookaheadPulse = m_seLookaheadCursor.secToPulse(frameTiming.seLookaheadTimeSec);
+
+		return frameTiming;
+	}
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+#include "tempo_map.hpp"
+
+namespace MusicGame
+{
+	// Times, pulses and tempos used in a frame, computed once and shared by all subsystems
+	struct FrameTiming
+	{
+		// Current chart time (BGM position)
+		double currentTimeSec = 0.0;
+		kson::Pulse currentPulse = 0;
+		double currentBPM = 120.0;
+
+		// Chart time of the audio being processed by audio effects (current time + output latency)
+		double audioTimeSec = 0.0;
+		kson::Pulse audioPulse = 0;
+		double audioBPM = 120.0;
+
+		// End of the range in which sound effects are pre-queued
+		double seLookaheadTimeSec = 0.0;
+		kson::Pulse seLookaheadPulse = 0;
+	};
+
+	// Computes FrameTiming with a cursor for each time so that each conversion is amortized O(1)
+	class FrameTimingCalculator
+	{
+	private:
+		TempoMap::Cursor m_currentCursor;
+		TempoMap::Cursor m_audioCursor;
+		TempoMap::Cursor m_seLookaheadCursor;
+
+	public:
+		explicit FrameTimingCalculator(const TempoMap& tempoMap);
+
+		FrameTiming calculate(double currentTimeSec, double audioLatencySec, double seLookaheadSec);
+	};
+}
@@ -22,8 +22,19 @@ namespace MusicGame
 		KeyConfig::kFX_R,
 	};
 
+	// Left and right keys of each laser lane
+	const std::array<KeyConfig::Button, kson::kNumLaserLanesSZ * 2U> kLaserButtons = {
+		KeyConfig::kLeftLaserL,
+		KeyConfig::kLeftLaserR,
+		KeyConfig::kRightLaserL,
+		KeyConfig::kRightLaserR,
+	};
+
 	constexpr kson::Pulse kPastPulse = -100000000;
 
+	// Rate of the simulation tick (judgment, audio effects and SE scheduling)
+	constexpr int32 kSimulationTickRateHz = 1000;
+
 	enum GaugeType : int32
 	{
 		kEasyGauge = 0,
@@ -7,85 +7,181 @@ namespace MusicGame
 {
 	namespace
 	{
-		template <std::size_t N>
-		int32 SumScoreFactor(const std::array<Judgment::ButtonLaneJudgment, N>& laneJudgements)
+		constexpr std::size_t kNumSEVoices = 16U;
+
+		Array<KeyConfig::Button> JudgmentButtons()
 		{
-			int32 sum = 0;
-			for (const auto& laneJudgment : laneJudgements)
+			Array<KeyConfig::Button> buttons(kBTButtons.begin(), kBTButtons.end());
+			buttons.insert(buttons.end(), kFXButtons.begin(), kFXButtons.end());
+			buttons.insert(buttons.end(), kLaserButtons.begin(), kLaserButtons.end());
+			return buttons;
+		}
+	}
+
+	void GameMain::collectKeyEvents(const FrameTiming& frameTiming)
+	{
+		for (auto& laneKeyEvents : m_keyEvents)
+		{
+			laneKeyEvents.clear();
+		}
+
+		const auto& buttons = m_buttonInputCapture.buttons();
+		for (const auto& event : m_buttonInputCapture.events())
+		{
+			// Note: The buttons of the capture are in the same order as the keys judged
+			const std::size_t laneIdx = static_cast<std::size_t>(std::find(buttons.begin(), buttons.end(), event.button) - buttons.begin());
+			assert(laneIdx < Judgment::kNumJudgmentKeysSZ);
+
+			// Map the timestamp onto the chart time using the audio position sampled in this tick
+			// Note: BGM::posSec() is the chart time, so the elapsed real time is scaled by the play speed
+			const double timeSec = frameTiming.currentTimeSec - (m_buttonInputCapture.updateTimeSec() - event.timeSec) * m_bgm.speed();
+			m_keyEvents[laneIdx].push_back({
+				.isPressed = event.isPressed,
+				.timeSec = timeSec,
+				.pulse = m_tempoMap.secToPulse(timeSec),
+			});
+
+			if (m_saveReplay)
 			{
-				sum += laneJudgment.scoreValue();
+				m_replayData.events.push_back({
+					.laneIdx = static_cast<uint8>(laneIdx),
+					.isPressed = event.isPressed,
+					.timeSec = timeSec,
+				});
 			}
-			return sum;
+		}
+	}
+
+	void GameMain::collectKnobEvents(const FrameTiming& frameTiming)
+	{
+		for (auto& laneKnobEvents : m_knobEvents)
+		{
+			laneKnobEvents.clear();
 		}
 
-		template <std::size_t N>
-		int32 SumScoreFactorMax(const std::array<Judgment::ButtonLaneJudgment, N>& laneJudgements)
+		for (const auto& event : m_laserKnobCapture.events())
 		{
-			int32 sum = 0;
-			for (const auto& laneJudgment : laneJudgements)
+			// Map the timestamp onto the chart time in the same way as the key events
+			const double timeSec = frameTiming.currentTimeSec - (m_laserKnobCapture.updateTimeSec() - event.timeSec) * m_bgm.speed();
+			m_knobEvents[event.laneIdx].push_back({
+				.timeSec = timeSec,
+				.knobDelta = event.delta,
+			});
+
+			if (m_saveReplay)
 			{
-				sum += laneJudgment.scoreValueMax();
+				m_replayData.knobEvents.push_back({
+					.laneIdx = static_cast<uint8>(event.laneIdx),
+					.delta = event.delta,
+					.timeSec = timeSec,
+				});
 			}
-			return sum;
 		}
 	}
 
-	void GameMain::updateGameStatus()
+	void GameMain::updateGameStatus(const FrameTiming& frameTiming)
 	{
-		const double currentTimeSec = m_bgm.posSec();
-		const kson::Pulse currentPulse = kson::SecToPulse(currentTimeSec, m_chartData.beat, m_timingCache);
-		const double currentBPM = kson::TempoAt(currentPulse, m_chartData.beat);
+		const double currentTimeSec = frameTiming.currentTimeSec;
+		const kson::Pulse currentPulse = frameTiming.currentPulse;
 		m_gameStatus.currentTimeSec = currentTimeSec;
 		m_gameStatus.currentPulse = currentPulse;
-		m_gameStatus.currentBPM = currentBPM;
+		m_gameStatus.currentBPM = frameTiming.currentBPM;
+
+		// Judgments of BT, FX and laser lanes
+		collectKeyEvents(frameTiming);
+		collectKnobEvents(frameTiming);
+		m_judgmentMain.update(m_keyEvents, m_knobEvents, currentPulse, currentTimeSec, m_gameStatus);
+
+		// Camera and laser graphs
+		ApplyGraphValues(m_graphEvaluator.evaluate(currentPulse), m_gameStatus);
+	}
 
-		// BT lane judgments
-		for (std::size_t i = 0U; i < kson::kNumBTLanesSZ; ++i)
+	void GameMain::saveReplay()
+	{
+		m_replayData.score = m_judgmentMain.score();
+		m_replayData.judgmentDigest = m_judgmentMain.judgmentDigest();
+		m_replayData.playEndSec = m_gameStatus.currentTimeSec;
+
+		// Note: A counter is appended if the file already exists, so that replays saved within the same millisecond are not overwritten
+		const String baseName = DateTime::Now().format(U"yyyyMMdd_HHmmss_SSS");
+		FilePath filePath = U"replays/{}.ksmreplay"_fmt(baseName);
+		for (int32 i = 1; FileSystem::Exists(filePath); ++i)
 		{
-			m_btLaneJudgments[i].update(m_chartData.note.bt[i], currentPulse, currentTimeSec, m_gameStatus.btLaneStatus[i]);
+			filePath = U"replays/{}_{}.ksmreplay"_fmt(baseName, i);
 		}
-
-		// FX lane judgments
-		for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+		FileSystem::CreateDirectories(FileSystem::ParentPath(filePath));
+		if (Replay::SaveReplayFile(filePath, m_replayData))
 		{
-			m_fxLaneJudgments[i].update(m_chartData.note.fx[i], currentPulse, currentTimeSec, m_gameStatus.fxLaneStatus[i]);
+			Logger << U"[Replay] Saved: {} ({} events)"_fmt(filePath, m_replayData.events.size());
+		}
+		else
+		{
+			Logger << U"[Replay] Could not save: {}"_fmt(filePath);
 		}
-
-		m_gameStatus.score = static_cast<int32>(static_cast<int64>(kScoreMax) * (SumScoreFactor(m_btLaneJudgments) + SumScoreFactor(m_fxLaneJudgments)) / m_scoreFactorMax); // TODO: add laser
-
-		// TODO: Calculate camera values
 	}
 
 	GameMain::GameMain(const GameCreateInfo& gameCreateInfo)
 		: m_parentPath(FileSystem::ParentPath(gameCreateInfo.chartFilePath))
 		, m_chartData(kson::LoadKSHChartData(gameCreateInfo.chartFilePath.narrow()))
 		, m_timingCache(kson::CreateTimingCache(m_chartData.beat))
-		, m_btLaneJudgments{
-			Judgment::ButtonLaneJudgment(kBTButtons[0], m_chartData.note.bt[0], m_chartData.beat, m_timingCache),
-			Judgment::ButtonLaneJudgment(kBTButtons[1], m_chartData.note.bt[1], m_chartData.beat, m_timingCache),
-			Judgment::ButtonLaneJudgment(kBTButtons[2], m_chartData.note.bt[2], m_chartData.beat, m_timingCache),
-			Judgment::ButtonLaneJudgment(kBTButtons[3], m_chartData.note.bt[3], m_chartData.beat, m_timingCache) }
-		, m_fxLaneJudgments{
-				Judgment::ButtonLaneJudgment(kFXButtons[0], m_chartData.note.fx[0], m_chartData.beat, m_timingCache),
-				Judgment::ButtonLaneJudgment(kFXButtons[1], m_chartData.note.fx[1], m_chartData.beat, m_timingCache) }
-		, m_scoreFactorMax(SumScoreFactorMax(m_btLaneJudgments) + SumScoreFactorMax(m_fxLaneJudgments)) // TODO: add laser
-		, m_bgm(m_parentPath + U"/" + Unicode::FromUTF8(m_chartData.audio.bgm.filename))
-		, m_assistTick(gameCreateInfo.enableAssistTick)
-		, m_audioEffectMain(m_bgm, m_chartData, m_timingCache)
-		, m_graphicsMain(m_chartData, m_parentPath, m_timingCache)
+		, m_tempoMap(m_chartData.beat, m_timingCache)
+		, m_frameTimingCalculator(m_tempoMap)
+		, m_graphEvaluator(m_chartData)
+		, m_buttonInputCapture(JudgmentButtons())
+		, m_laserKnobCapture(gameCreateInfo.laserKnobSettings)
+		, m_judgmentMain(m_chartData, m_tempoMap, gameCreateInfo.playSpeed)
+		, m_saveReplay(gameCreateInfo.saveReplay)
+		, m_replayData{
+			.chartFilePath = gameCreateInfo.chartFilePath,
+			.chartMD5 = MD5::FromFile(gameCreateInfo.chartFilePath),
+			.playSpeed = gameCreateInfo.playSpeed,
+		}
+		, m_bgm(m_parentPath + U"/" + Unicode::FromUTF8(m_chartData.audio.bgm.filename), gameCreateInfo.preloadBGM, gameCreateInfo.playSpeed)
+		, m_seMixer(ksmaudio::kSampleRate, kNumSEVoices)
+		, m_seScheduler(m_seMixer, gameCreateInfo.playSpeed)
+		, m_assistTick(gameCreateInfo.enableAssistTick, m_seMixer)
+		, m_keySound(m_chartData, m_tempoMap, m_parentPath, m_seMixer)
+		, m_audioEffectMain(m_chartData)
+		, m_graphicsMain(m_chartData, m_parentPath, m_timingCache, gameCreateInfo.parallelDrawList)
 	{
 		m_bgm.seekPosSec(-TimeSecBeforeStart(false/* TODO: movie */));
 		m_bgm.play();
 
 		kson::SaveKSONChartData("hogehoge.kson", m_chartData);
+
+		m_simulationThread.start(kSimulationTickRateHz, FixedRateThread::Priority::kAboveNormal, [this] { tick(); });
 	}
 
-	void GameMain::update()
+	GameMain::~GameMain()
+	{
+		m_simulationThread.stop();
+
+		if (m_saveReplay)
+		{
+			saveReplay();
+		}
+
+		// Dump DSP load of audio effects so that dropouts can be investigated from the log file
+		for (const auto& line : m_bgm.dspLoadReportLines())
+		{
+			Logger << line;
+		}
+
+		Logger << U"[Frame time] {}"_fmt(m_graphicsMain.frameTimeStatsString());
+	}
+
+	void GameMain::tick()
 	{
 		m_bgm.update();
+		m_buttonInputCapture.update();
+		m_laserKnobCapture.update();
+
+		// Note: BGM::posSec() returns the time in the chart (not the elapsed real time) even if the play speed is changed,
+		//       so the time can be converted into pulses as is. Only the timing windows of judgments are scaled.
+		const FrameTiming frameTiming = m_frameTimingCalculator.calculate(m_bgm.posSec(), m_bgm.latencySec(), Audio::SEScheduler::kLookaheadSec);
 
 		// Game status and judgment
-		updateGameStatus();
+		updateGameStatus(frameTiming);
 
 		// Audio effects
 		std::array<Optional<bool>, kson::kNumFXLanesSZ> longFXPressed;
@@ -93,20 +189,39 @@ namespace MusicGame
 		{
 			longFXPressed[i] = m_gameStatus.fxLaneStatus[i].longNotePressed;
 		}
-		m_audioEffectMain.update(m_bgm, m_chartData, m_timingCache, {
+		m_audioEffectMain.update(m_bgm, m_chartData, m_timingCache, m_tempoMap, frameTiming, {
 			.longFXPressed = longFXPressed,
 		});
 
 		// SE
-		const double currentTimeSec = m_bgm.posSec();
-		m_assistTick.update(m_chartData, m_timingCache, currentTimeSec);
+		m_seScheduler.update(frameTiming.currentTimeSec);
+		m_assistTick.update(m_chartData, m_tempoMap, frameTiming, m_seScheduler);
+		m_keySound.update(frameTiming, m_judgmentMain, m_seScheduler);
+
+		// Publish the game status for drawing
+		const ksmaudio::DSPLoadSnapshot dspLoadSnapshot = m_bgm.dspLoadSnapshot();
+		{
+			std::lock_guard lock(m_publishedGameStatusMutex);
+			m_publishedGameStatus = m_gameStatus;
+			m_publishedDSPLoadSnapshot = dspLoadSnapshot;
+		}
+	}
+
+	void GameMain::update()
+	{
+		// Note: The game logic runs in the simulation thread, so only the graphics are updated per frame
+		{
+			std::lock_guard lock(m_publishedGameStatusMutex);
+			m_drawGameStatus = m_publishedGameStatus;
+			m_drawDSPLoadSnapshot = m_publishedDSPLoadSnapshot;
+		}
 
 		// Graphics
-		m_graphicsMain.update(m_chartData, m_gameStatus);
+		m_graphicsMain.update(m_chartData, m_drawGameStatus, m_drawDSPLoadSnapshot);
 	}
 
 	void GameMain::draw() const
 	{
-		m_graphicsMain.draw(m_chartData, m_gameStatus);
+		m_graphicsMain.draw(m_chartData, m_drawGameStatus);
 	}
 }
@@ -1,9 +1,19 @@
 ﻿#pragma once
+#include <thread>
+#include <mutex>
+#include "common/fixed_rate_thread.hpp"
 #include "game_status.hpp"
-#include "music_game/judgment/button_lane_judgment.hpp"
+#include "frame_timing.hpp"
+#include "graph_evaluator.hpp"
+#include "input/button_input_capture.hpp"
+#include "input/laser_knob_capture.hpp"
+#include "music_game/judgment/judgment_main.hpp"
+#include "music_game/replay/replay_data.hpp"
 #include "music_game/graphics/graphics_main.hpp"
 #include "music_game/audio/bgm.hpp"
 #include "music_game/audio/assist_tick.hpp"
+#include "music_game/audio/key_sound.hpp"
+#include "music_game/audio/se_scheduler.hpp"
 #include "music_game/audio/audio_effect_main.hpp"
 #include "kson/util/timing_utils.hpp"
 
@@ -14,11 +24,26 @@ namespace MusicGame
 		FilePath chartFilePath;
 
 		bool enableAssistTick = false;
+
+		// Decode the whole BGM into memory before playback (no decoding cost during gameplay)
+		bool preloadBGM = false;
+
+		// Playback speed for practice (the pitch is kept by time-stretching)
+		double playSpeed = 1.0;
+
+		// Save the judged input events into a replay file when the play ends
+		bool saveReplay = false;
+
+		LaserKnobSettings laserKnobSettings;
+
+		// Build the note draw lists on a worker thread in parallel with the main thread
+		bool parallelDrawList = true;
 	};
 
 	class GameMain
 	{
 	private:
+		// Used only in the simulation thread
 		GameStatus m_gameStatus;
 
 		FilePath m_parentPath;
@@ -26,15 +51,27 @@ namespace MusicGame
 		// Chart
 		const kson::ChartData m_chartData;
 		const kson::TimingCache m_timingCache;
+		const TempoMap m_tempoMap;
+		FrameTimingCalculator m_frameTimingCalculator;
+		GraphEvaluator m_graphEvaluator;
 
 		// Judgment
-		std::array<Judgment::ButtonLaneJudgment, kson::kNumBTLanesSZ> m_btLaneJudgments;
-		std::array<Judgment::ButtonLaneJudgment, kson::kNumFXLanesSZ> m_fxLaneJudgments;
-		const int32 m_scoreFactorMax;
+		ButtonInputCapture m_buttonInputCapture;
+		LaserKnobCapture m_laserKnobCapture;
+		Judgment::JudgmentKeyEvents m_keyEvents;
+		Judgment::LaserKnobEvents m_knobEvents;
+		Judgment::JudgmentMain m_judgmentMain;
+
+		// Replay
+		const bool m_saveReplay;
+		Replay::ReplayData m_replayData;
 
 		// Audio
 		Audio::BGM m_bgm;
+		ksmaudio::SEMixer m_seMixer;
+		Audio::SEScheduler m_seScheduler;
 		Audio::AssistTick m_assistTick;
+		Audio::KeySound m_keySound;
 
 		// Audio effects
 		Audio::AudioEffectMain m_audioEffectMain;
@@ -42,11 +79,34 @@ namespace MusicGame
 		// Graphics
 		Graphics::GraphicsMain m_graphicsMain;
 
-		void updateGameStatus();
+		// Snapshots of m_gameStatus and the BGM DSP load published at the end of each tick (guarded by m_publishedGameStatusMutex)
+		// Note: m_bgm is owned by the simulation thread, so the main thread must not access it directly
+		GameStatus m_publishedGameStatus;
+		ksmaudio::DSPLoadSnapshot m_publishedDSPLoadSnapshot;
+		mutable std::mutex m_publishedGameStatusMutex;
+
+		// Copies of the published snapshots used for drawing (used only in the main thread)
+		GameStatus m_drawGameStatus;
+		ksmaudio::DSPLoadSnapshot m_drawDSPLoadSnapshot;
+
+		// Calls tick() at kSimulationTickRateHz
+		FixedRateThread m_simulationThread;
+
+		void tick();
+
+		void collectKeyEvents(const FrameTiming& frameTiming);
+
+		void collectKnobEvents(const FrameTiming& frameTiming);
+
+		void saveReplay();
+
+		void updateGameStatus(const FrameTiming& frameTiming);
 
 	public:
 		explicit GameMain(const GameCreateInfo& gameCreateInfo);
 
+		~GameMain();
+
 		void update();
 
 		void draw() const;
@@ -31,6 +31,17 @@ namespace MusicGame
 		double currentLongNoteAnimOffsetTimeSec = kPastTimeSec;
 	};
 
+	struct LaserLaneStatus
+	{
+		// This value will be none while no laser section is being judged
+		Optional<double> cursorX = none;
+
+		bool isCursorOnLaser = false;
+
+		// Value of the laser graph at the current pulse (none outside the laser sections)
+		Optional<double> laserValue = none;
+	};
+
 	struct CamStatus
 	{
 		double zoom = 0.0;
@@ -49,6 +60,7 @@ namespace MusicGame
 		
 		std::array<LaneStatus, kson::kNumBTLanesSZ> btLaneStatus;
 		std::array<LaneStatus, kson::kNumFXLanesSZ> fxLaneStatus;
+		std::array<LaserLaneStatus, kson::kNumLaserLanesSZ> laserLaneStatus;
 
 		std::size_t lastPressedLongFXNoteLaneIdx = 0U; // For audio effect parameter priority
 
@@ -0,0 +1,156 @@
+﻿#include "graph_evaluator.hpp"
+
+namespace MusicGame
+{
+	namespace
+	{
+		// Forward steps of a cursor before falling back to a binary search
+		constexpr std::size_t kMaxCursorSteps = 8U;
+
+		constexpr kson::Pulse kPulseMax = std::numeric_limits<kson::Pulse>::max();
+	}
+
+	void GraphEvaluator::addPoint(kson::Pulse pulse, const kson::GraphValue& point, kson::Pulse nextPulse, double nextValue)
+	{
+		// Note: The value at the point itself is the value after the slam (vf), in the same way as kson::GraphValueAt()
+		m_segmentStartPulses.push_back(pulse);
+		m_segmentEndPulses.push_back(nextPulse);
+		m_segmentStartValues.push_back(point.vf);
+		m_segmentSlopes.push_back((nextValue - point.vf) / static_cast<double>(nextPulse - pulse));
+	}
+
+	void GraphEvaluator::addGraph(const kson::Graph& graph)
+	{
+		for (auto itr = graph.begin(); itr != graph.end(); ++itr)
+		{
+			const auto& [y, point] = *itr;
+			if (const auto nextItr = std::next(itr); nextItr != graph.end())
+			{
+				addPoint(y, point, nextItr->first, nextItr->second.v);
+			}
+			else
+			{
+				// The last value is kept to the end of the chart
+				addPoint(y, point, kPulseMax, point.vf);
+			}
+		}
+	}
+
+	void GraphEvaluator::addLaserLane(const kson::ByPulse<kson::LaserSection>& lane)
+	{
+		for (const auto& [y, laserSection] : lane)
+		{
+			for (auto itr = laserSection.v.begin(); itr != laserSection.v.end(); ++itr)
+			{
+				const auto& [ry, point] = *itr;
+				if (const auto nextItr = std::next(itr); nextItr != laserSection.v.end())
+				{
+					addPoint(y + ry, point, y + nextItr->first, nextItr->second.v);
+				}
+				else
+				{
+					// The section ends at its last point (inclusive), in the same way as kson::GraphSectionValueAt()
+					addPoint(y + ry, point, y + ry + 1, point.vf);
+				}
+			}
+		}
+	}
+
+	std::size_t GraphEvaluator::seek(std::size_t graphIdx, kson::Pulse pulse) const
+	{
+		const auto begin = m_segmentEndPulses.begin() + m_graphSegmentOffsets[graphIdx];
+		const auto end = m_segmentEndPulses.begin() + m_graphSegmentOffsets[graphIdx + 1U];
+		return static_cast<std::size_t>(std::upper_bound(begin, end, pulse) - m_segmentEndPulses.begin());
+	}
+
+	GraphEvaluator::GraphEvaluator(const kson::ChartData& chartData)
+	{
+		const auto& camBody = chartData.camera.cam.body;
+		const std::array<const kson::Graph*, kLeftLaser> camGraphs = {
+			&camBody.zoom,
+			&camBody.shiftX,
+			&camBody.rotationX,
+			&camBody.rotationZ,
+			&camBody.rotationZLane,
+			&camBody.rotationZJdgLine,
+		};
+
+		for (std::size_t i = 0U; i < kNumGraphTypes; ++i)
+		{
+			m_graphSegmentOffsets[i] = m_segmentStartPulses.size();
+			m_cursors[i] = m_segmentStartPulses.size();
+			if (i < kLeftLaser)
+			{
+				addGraph(*camGraphs[i]);
+			}
+			else
+			{
+				addLaserLane(chartData.note.laser[i - kLeftLaser]);
+			}
+		}
+		m_graphSegmentOffsets[kNumGraphTypes] = m_segmentStartPulses.size();
+	}
+
+	const GraphEvaluator::Values& GraphEvaluator::evaluate(kson::Pulse pulse)
+	{
+		const bool isBackward = pulse < m_prevPulse;
+		for (std::size_t i = 0U; i < kNumGraphTypes; ++i)
+		{
+			const std::size_t end = m_graphSegmentOffsets[i + 1U];
+			std::size_t& cursorRef = m_cursors[i];
+			if (isBackward)
+			{
+				cursorRef = seek(i, pulse);
+			}
+			else
+			{
+				std::size_t numSteps = 0U;
+				while (cursorRef < end && m_segmentEndPulses[cursorRef] <= pulse)
+				{
+					++cursorRef;
+					if (++numSteps > kMaxCursorSteps) [[unlikely]]
+					{
+						cursorRef = seek(i, pulse);
+						break;
+					}
+				}
+			}
+
+			if (cursorRef < end && m_segmentStartPulses[cursorRef] <= pulse)
+			{
+				m_values[i] = m_segmentStartValues[cursorRef] + m_segmentSlopes[cursorRef] * static_cast<double>(pulse - m_segmentStartPulses[cursorRef]);
+			}
+			else
+			{
+				m_values[i] = none;
+			}
+		}
+		m_prevPulse = pulse;
+		return m_values;
+	}
+
+	const GraphEvaluator::Values& GraphEvaluator::values() const
+	{
+		return m_values;
+	}
+
+	std::size_t GraphEvaluator::numSegments() const
+	{
+		return m_segmentStartPulses.size();
+	}
+
+	void ApplyGraphValues(const GraphEvaluator::Values& values, GameStatus& gameStatusRef)
+	{
+		CamStatus& camStatusRef = gameStatusRef.camStatus;
+		camStatusRef.zoom = values[GraphEvaluator::kCamZoom].value_or(0.0);
+		camStatusRef.shiftX = values[GraphEvaluator::kCamShiftX].value_or(0.0);
+		camStatusRef.rotationX = values[GraphEvaluator::kCamRotationX].value_or(0.0);
+		camStatusRef.rotationZ = values[GraphEvaluator::kCamRotationZ].value_or(0.0);
+		camStatusRef.rotationZLane = values[GraphEvaluator::kCamRotationZLane].value_or(0.0);
+		camStatusRef.rotationZJdgLine = values[GraphEvaluator::kCamRotationZJdgLine].value_or(0.0);
+		for (std::size_t i = 0U; i < kson::kNumLaserLanesSZ; ++i)
+		{
+			gameStatusRef.laserLaneStatus[i].laserValue = values[GraphEvaluator::kLeftLaser + i];
+		}
+	}
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include "kson/chart_data.hpp"
+#include "game_status.hpp"
+
+namespace MusicGame
+{
+	// Evaluates all graphs of the chart (camera and lasers) at once from contiguous arrays of linear segments
+	// Note: Each graph keeps a cursor, so monotonic queries (e.g., once per tick) are amortized O(1) without searching std::map.
+	//       Backward queries and long jumps fall back to a binary search.
+	class GraphEvaluator
+	{
+	public:
+		enum GraphType : std::size_t
+		{
+			kCamZoom = 0,
+			kCamShiftX,
+			kCamRotationX,
+			kCamRotationZ,
+			kCamRotationZLane,
+			kCamRotationZJdgLine,
+			kLeftLaser,
+			kRightLaser,
+
+			kNumGraphTypes,
+		};
+
+		// Value of each graph (none before the first point of camera graphs and outside the sections of lasers)
+		using Values = std::array<Optional<double>, kNumGraphTypes>;
+
+	private:
+		// Segment i covers [m_segmentStartPulses[i], m_segmentEndPulses[i]) and its value is linear in the pulse
+		// Note: The segments of graph g are in [m_graphSegmentOffsets[g], m_graphSegmentOffsets[g + 1]) without overlaps.
+		std::vector<kson::Pulse> m_segmentStartPulses;
+		std::vector<kson::Pulse> m_segmentEndPulses;
+		std::vector<double> m_segmentStartValues;
+		std::vector<double> m_segmentSlopes; // Per pulse (precomputed to avoid division)
+
+		std::array<std::size_t, kNumGraphTypes + 1U> m_graphSegmentOffsets = {};
+
+		// Index of the first segment ending after the last queried pulse (for each graph)
+		std::array<std::size_t, kNumGraphTypes> m_cursors = {};
+
+		kson::Pulse m_prevPulse = 0;
+
+		Values m_values;
+
+		void addGraph(const kson::Graph& graph);
+
+		void addLaserLane(const kson::ByPulse<kson::LaserSection>& lane);
+
+		void addPoint(kson::Pulse pulse, const kson::GraphValue& point, kson::Pulse nextPulse, double nextValue);
+
+		std::size_t seek(std::size_t graphIdx, kson::Pulse pulse) const;
+
+	public:
+		explicit GraphEvaluator(const kson::ChartData& chartData);
+
+		// Evaluates all graphs at the pulse in one pass
+		const Values& evaluate(kson::Pulse pulse);
+
+		// Values of the last evaluate()
+		const Values& values() const;
+
+		std::size_t numSegments() const;
+	};
+
+	// Sets the camera status and the laser values of the game status from the graph values
+	void ApplyGraphValues(const GraphEvaluator::Values& values, GameStatus& gameStatusRef);
+}
@@ -1,7 +1,6 @@
 ﻿#include "graphics_main.hpp"
 #include "graphics_defines.hpp"
 #include "music_game/game_defines.hpp"
-#include "kson/util/graph_utils.hpp"
 
 namespace MusicGame::Graphics
 {
@@ -100,31 +99,45 @@ namespace MusicGame::Graphics
 		}
 	}
 
-	GraphicsMain::GraphicsMain(const kson::ChartData& chartData, FilePathView parentPath, const kson::TimingCache& timingCache)
+	GraphicsMain::GraphicsMain(const kson::ChartData& chartData, FilePathView parentPath, const kson::TimingCache& timingCache, bool parallelDrawList)
 		: m_camera(Scene::Size(), kCameraVerticalFOV, kCameraPosition, kCameraLookAt)
 		, m_bgBillboardMesh(MeshData::Billboard())
 		, m_bgTexture(BGFilePath(chartData))
 		, m_bgTransform(m_camera.billboard(kBGBillboardPosition, kBGBillboardSize))
 		, m_layerFrameTextures(SplitLayerTexture(LayerFilePath(chartData)))
 		, m_layerTransform(m_camera.billboard(kLayerBillboardPosition, kLayerBillboardSize))
+		, m_highway3DGraphics(chartData, parallelDrawList)
 		, m_songInfoPanel(chartData, parentPath)
 		, m_gaugePanel(kNormalGauge/* TODO: gauge type */)
 		, m_initialPulse(kson::MsToPulse(TimeSecBeforeStart(false/* TODO: movie */), chartData.beat, timingCache))
+		, m_parallelDrawList(parallelDrawList)
 	{
 	}
 
-	void GraphicsMain::update(const kson::ChartData& chartData, const GameStatus& gameStatus)
+	void GraphicsMain::update(const kson::ChartData& chartData, const GameStatus& gameStatus, const ksmaudio::DSPLoadSnapshot& dspLoadSnapshot)
 	{
-		const double leftLaserValue = kson::GraphSectionValueAtWithDefault(chartData.note.laser[0], gameStatus.currentPulse, 0.0); // range: [0, +1]
-		const double rightLaserValue = kson::GraphSectionValueAtWithDefault(chartData.note.laser[1], gameStatus.currentPulse, 1.0) - 1.0; // range: [-1, 0]
+		const Stopwatch stopwatch(StartImmediately::Yes);
+
+		const double leftLaserValue = gameStatus.laserLaneStatus[0].laserValue.value_or(0.0); // range: [0, +1]
+		const double rightLaserValue = gameStatus.laserLaneStatus[1].laserValue.value_or(1.0) - 1.0; // range: [-1, 0]
 		const double tiltFactor = leftLaserValue + rightLaserValue; // range: [-1, +1]
 		m_highwayTilt.update(tiltFactor);
+
+		m_highway3DGraphics.update(gameStatus);
+
+		const double updateSec = stopwatch.sF();
+		++m_numFrames;
+		m_updateSecSum += updateSec;
+		m_updateSecMax = Max(m_updateSecMax, updateSec);
+		m_frameSecSum += Scene::DeltaTime();
+
+		m_dspLoadMonitor.update(dspLoadSnapshot);
 	}
 
 	void GraphicsMain::draw(const kson::ChartData& chartData, const GameStatus& gameStatus) const
 	{
 		// Draw 2D render textures
-		m_highway3DGraphics.draw2D(chartData, gameStatus);
+		m_highway3DGraphics.draw2D(gameStatus);
 		m_jdgoverlay3DGraphics.draw2D(gameStatus);
 		Graphics2D::Flush();
 
@@ -142,5 +155,21 @@ namespace MusicGame::Graphics
 		m_scorePanel.draw(gameStatus.score);
 		m_gaugePanel.draw(100.0/* TODO: Percentage */, gameStatus.currentPulse);
 		m_frameRateMonitor.draw();
+		m_dspLoadMonitor.draw();
+	}
+
+	String GraphicsMain::frameTimeStatsString() const
+	{
+		if (m_numFrames == 0)
+		{
+			return U"no frames";
+		}
+
+		return U"draw list: {}, frames={}, avg frame={:.2f}ms, avg update={:.3f}ms, max update={:.3f}ms"_fmt(
+			m_parallelDrawList ? U"parallel" : U"serial",
+			m_numFrames,
+			m_frameSecSum / m_numFrames * 1000,
+			m_updateSecSum / m_numFrames * 1000,
+			m_updateSecMax * 1000);
 	}
 }
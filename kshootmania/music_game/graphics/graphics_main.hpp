@@ -7,6 +7,7 @@
 #include "hud/score_panel.hpp"
 #include "hud/gauge_panel.hpp"
 #include "hud/frame_rate_monitor.hpp"
+#include "hud/dsp_load_monitor.hpp"
 #include "music_game/game_status.hpp"
 #include "kson/util/timing_utils.hpp"
 
@@ -35,18 +36,28 @@ namespace MusicGame::Graphics
 		ScorePanel m_scorePanel;
 		GaugePanel m_gaugePanel;
 		FrameRateMonitor m_frameRateMonitor;
+		DSPLoadMonitor m_dspLoadMonitor;
 
 		kson::Pulse m_initialPulse;
 
+		// CPU time statistics of update() for comparing the serial and parallel draw list preparation
+		const bool m_parallelDrawList;
+		int64 m_numFrames = 0;
+		double m_updateSecSum = 0.0;
+		double m_updateSecMax = 0.0;
+		double m_frameSecSum = 0.0;
+
 		void drawBG() const;
 
 		void drawLayer(const kson::ChartData& chartData, const GameStatus& gameStatus) const;
 
 	public:
-		explicit GraphicsMain(const kson::ChartData& chartData, FilePathView parentPath, const kson::TimingCache& timingCache);
+		GraphicsMain(const kson::ChartData& chartData, FilePathView parentPath, const kson::TimingCache& timingCache, bool parallelDrawList);
 
-		void update(const kson::ChartData& chartData, const GameStatus& gameStatus);
+		void update(const kson::ChartData& chartData, const GameStatus& gameStatus, const ksmaudio::DSPLoadSnapshot& dspLoadSnapshot);
 
 		void draw(const kson::ChartData& chartData, const GameStatus& gameStatus) const;
+
+		String frameTimeStatsString() const;
 	};
 }
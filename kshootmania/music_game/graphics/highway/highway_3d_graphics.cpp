@@ -25,19 +25,62 @@ namespace MusicGame::Graphics
 		constexpr int32 kNumShineEffects = 4;
 		constexpr Vec2 kShineEffectPositionOffset = { 40.0, 0.0 };
 		constexpr Vec2 kShineEffectPositionDiff = { 0.0, 300.0 };
+
+		// Notes whose end is within this range behind the judgment line are still drawn
+		constexpr kson::RelPulse kVisibleNotePulsesBehind = kson::kResolution;
+
+		// Margin above the highway texture (covers the laser start texture)
+		constexpr double kVisibleNoteMarginAbove = 220.0;
 	}
 
-	Highway3DGraphics::Highway3DGraphics()
+	Highway3DGraphics::Highway3DGraphics(const kson::ChartData& chartData, bool parallelDrawList)
 		: m_baseTexture(TextureAsset(kHighwayBaseTextureFilename))
 		, m_shineEffectTexture(TextureAsset(kShineEffectTextureFilename))
 		, m_additiveRenderTexture(kHighwayTextureSize)
 		, m_invMultiplyRenderTexture(kHighwayTextureSize)
 		, m_meshData(MeshData::Grid({ 0.0, 0.0, 0.0 }, kHighwayPlaneSize, 2, 2, { 1.0f - kUVShrinkX, 1.0f - kUVShrinkY }, { kUVShrinkX / 2, kUVShrinkY / 2 }))
+		, m_laserNoteGraphics(chartData)
 		, m_mesh(m_meshData) // <- this initialization is required because DynamicMesh::fill() does not resize the vertex array dynamically
+		, m_visibleNoteIndex(chartData)
+		, m_parallelDrawList(parallelDrawList)
+	{
+	}
+
+	void Highway3DGraphics::update(const GameStatus& gameStatus)
 	{
+		// TODO: Hi-speed (480px per measure is fixed for now)
+		const kson::RelPulse pulsesAhead = static_cast<kson::RelPulse>((static_cast<double>(kHighwayTextureSize.y) + kVisibleNoteMarginAbove) * kson::kResolution / 480);
+		m_visibleNoteIndex.update(gameStatus.currentPulse, kVisibleNotePulsesBehind, pulsesAhead);
+
+		const auto buildLaserNoteDrawList = [this, &gameStatus]
+		{
+			m_laserNoteDrawList.clear();
+			m_laserNoteGraphics.buildDrawList(m_visibleNoteIndex, gameStatus, m_laserNoteDrawList);
+		};
+
+		// Note: Both builders only read the visible note index, the game status and the textures, and each writes only to
+		//       its own draw list, so the laser draw list can be built on a worker thread. Only the submission in draw2D()
+		//       touches the GPU, and it stays in the main thread.
+		AsyncTask<void> laserTask;
+		if (m_parallelDrawList)
+		{
+			laserTask = Async(buildLaserNoteDrawList);
+		}
+
+		m_buttonNoteDrawList.clear();
+		m_buttonNoteGraphics.buildDrawList(m_visibleNoteIndex, gameStatus, m_buttonNoteDrawList);
+
+		if (m_parallelDrawList)
+		{
+			laserTask.get();
+		}
+		else
+		{
+			buildLaserNoteDrawList();
+		}
 	}
 
-	void Highway3DGraphics::draw2D(const kson::ChartData& chartData, const GameStatus& gameStatus) const
+	void Highway3DGraphics::draw2D(const GameStatus& gameStatus) const
 	{
 		const ScopedRenderStates2D samplerState(SamplerState::ClampNearest);
 		Shader::Copy(m_baseTexture(0, 0, kHighwayTextureSize), m_additiveRenderTexture);
@@ -55,13 +98,13 @@ namespace MusicGame::Graphics
 		}
 
 		// Draw BT/FX notes
-		m_buttonNoteGraphics.draw(chartData, gameStatus, m_additiveRenderTexture, m_invMultiplyRenderTexture);
+		m_buttonNoteDrawList.submit(m_additiveRenderTexture, m_invMultiplyRenderTexture);
 
 		// Draw key beams
 		m_keyBeamGraphics.draw(gameStatus, m_additiveRenderTexture);
 
 		// Draw laser notes
-		m_laserNoteGraphics.draw(chartData, gameStatus, m_additiveRenderTexture, m_invMultiplyRenderTexture);
+		m_laserNoteDrawList.submit(m_additiveRenderTexture, m_invMultiplyRenderTexture);
 	}
 
 	void Highway3DGraphics::draw3D(double tiltRadians) const
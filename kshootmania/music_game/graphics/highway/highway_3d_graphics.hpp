@@ -20,13 +20,22 @@ namespace MusicGame::Graphics
 
 		KeyBeamGraphics m_keyBeamGraphics;
 
+		VisibleNoteIndex m_visibleNoteIndex;
+
+		NoteDrawList m_buttonNoteDrawList;
+		NoteDrawList m_laserNoteDrawList;
+
+		const bool m_parallelDrawList;
+
 		MeshData m_meshData;
 		DynamicMesh m_mesh;
 
 	public:
-		Highway3DGraphics();
+		Highway3DGraphics(const kson::ChartData& chartData, bool parallelDrawList);
+
+		void update(const GameStatus& gameStatus);
 
-		void draw2D(const kson::ChartData& chartData, const GameStatus& gameStatus) const;
+		void draw2D(const GameStatus& gameStatus) const;
 
 		void draw3D(double tiltRadians) const;
 	};
@@ -21,22 +21,16 @@ namespace
 	}
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawChipNotesCommon(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, bool isBT) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildChipNotesCommon(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, bool isBT, NoteDrawList& drawList) const
 {
 	const double highwayTextureHeight = static_cast<double>(kHighwayTextureSize.y);
 
-	const ScopedRenderTarget2D renderTarget(additiveTarget);
-	const ScopedRenderStates2D samplerState(SamplerState::ClampNearest);
-
 	for (std::size_t laneIdx = 0; laneIdx < (isBT ? kson::kNumBTLanesSZ : kson::kNumFXLanesSZ); ++laneIdx)
 	{
-		const auto& lane = isBT ? chartData.note.bt[laneIdx] : chartData.note.fx[laneIdx];
-		for (const auto& [y, note] : lane)
+		const auto& range = isBT ? visibleNoteIndex.btLaneRange(laneIdx) : visibleNoteIndex.fxLaneRange(laneIdx);
+		for (auto itr = range.begin(); itr != range.end(); ++itr)
 		{
-			if (y + note.length < gameStatus.currentPulse - kson::kResolution)
-			{
-				continue;
-			}
+			const auto& [y, note] = *itr;
 
 			const double positionStartY = highwayTextureHeight - static_cast<double>(y - gameStatus.currentPulse) * 480 / kson::kResolution;
 			if (positionStartY < 0)
@@ -50,39 +44,36 @@ void MusicGame::Graphics::ButtonNoteGraphics::drawChipNotesCommon(const kson::Ch
 				const double height = NoteGraphicsUtils::ChipNoteHeight(yRate);
 				const TiledTexture& sourceTexture = isBT ? m_chipBTNoteTexture : m_chipFXNoteTexture;
 				const Vec2 position = kLanePositionOffset + (isBT ? kBTLanePositionDiff : kFXLanePositionDiff) * static_cast<double>(laneIdx) + Vec2::Down(positionStartY - height / 2);
-				sourceTexture() // TODO: Chip BT color
-					.resized(isBT ? 40 : 82, NoteGraphicsUtils::ChipNoteHeight(yRate))
-					.draw(position);
+				drawList.addRect(
+					NoteDrawTarget::kAdditive,
+					NoteDrawBlend::kDefault,
+					RectF{ position, isBT ? 40 : 82, height },
+					sourceTexture()); // TODO: Chip BT color
 			}
 		}
 	}
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawChipBTNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildChipBTNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 {
-	drawChipNotesCommon(chartData, gameStatus, additiveTarget, true);
+	buildChipNotesCommon(visibleNoteIndex, gameStatus, true, drawList);
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawChipFXNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildChipFXNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 {
-	drawChipNotesCommon(chartData, gameStatus, additiveTarget, false);
+	buildChipNotesCommon(visibleNoteIndex, gameStatus, false, drawList);
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawLongNotesCommon(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget, bool isBT) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildLongNotesCommon(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, bool isBT, NoteDrawList& drawList) const
 {
 	const double highwayTextureHeight = static_cast<double>(kHighwayTextureSize.y);
 
-	const ScopedRenderStates2D samplerState(SamplerState::ClampNearest);
-
 	for (std::size_t laneIdx = 0; laneIdx < (isBT ? kson::kNumBTLanesSZ : kson::kNumFXLanesSZ); ++laneIdx)
 	{
-		const auto& lane = isBT ? chartData.note.bt[laneIdx] : chartData.note.fx[laneIdx];
-		for (const auto& [y, note] : lane)
+		const auto& range = isBT ? visibleNoteIndex.btLaneRange(laneIdx) : visibleNoteIndex.fxLaneRange(laneIdx);
+		for (auto itr = range.begin(); itr != range.end(); ++itr)
 		{
-			if (y + note.length < gameStatus.currentPulse - kson::kResolution)
-			{
-				continue;
-			}
+			const auto& [y, note] = *itr;
 
 			const double positionStartY = highwayTextureHeight - static_cast<double>(y - gameStatus.currentPulse) * 480 / kson::kResolution;
 			if (positionStartY < 0)
@@ -93,10 +84,10 @@ void MusicGame::Graphics::ButtonNoteGraphics::drawLongNotesCommon(const kson::Ch
 			if (note.length > 0)
 			{
 				const double positionEndY = highwayTextureHeight - static_cast<double>(y + note.length - gameStatus.currentPulse) * 480 / kson::kResolution;
-				for (int32 i = 0; i < (isBT ? 2 : 1); ++i) // Note: Long BT note has additional texture for invMultiplyTarget
+				for (int32 i = 0; i < (isBT ? 2 : 1); ++i) // Note: Long BT note has additional texture for the invMultiply target
 				{
-					const ScopedRenderTarget2D renderTarget((i == 0) ? additiveTarget : invMultiplyTarget);
-					const ScopedRenderStates2D blendState((i == 0) ? (isBT ? BlendState::Additive : BlendState::Default2D) : BlendState::Subtractive);
+					const NoteDrawTarget target = (i == 0) ? NoteDrawTarget::kAdditive : NoteDrawTarget::kInvMultiply;
+					const NoteDrawBlend blend = (i == 0) ? (isBT ? NoteDrawBlend::kAdditive : NoteDrawBlend::kDefault) : NoteDrawBlend::kSubtractive;
 					const LaneStatus& laneStatus = isBT ? gameStatus.btLaneStatus[laneIdx] : gameStatus.fxLaneStatus[laneIdx];
 					double sourceY;
 					if (laneStatus.currentLongNotePulse == y)
@@ -117,23 +108,25 @@ void MusicGame::Graphics::ButtonNoteGraphics::drawLongNotesCommon(const kson::Ch
 					const Texture& sourceTexture = isBT ? m_longBTNoteTexture : m_longFXNoteTexture;
 					const int32 width = isBT ? 40 : 82;
 					const Vec2 position = kLanePositionOffset + (isBT ? kBTLanePositionDiff : kFXLanePositionDiff) * static_cast<double>(laneIdx) + Vec2::Down(positionEndY);
-					sourceTexture(width * i, sourceY + kOnePixelTextureSourceOffset, width, kOnePixelTextureSourceSize)
-						.resized(width, static_cast<double>(note.length) * 480 / kson::kResolution)
-						.draw(position);
+					drawList.addRect(
+						target,
+						blend,
+						RectF{ position, width, static_cast<double>(note.length) * 480 / kson::kResolution },
+						sourceTexture(width * i, sourceY + kOnePixelTextureSourceOffset, width, kOnePixelTextureSourceSize));
 				}
 			}
 		}
 	}
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawLongBTNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildLongBTNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 {
-	drawLongNotesCommon(chartData, gameStatus, additiveTarget, invMultiplyTarget, true);
+	buildLongNotesCommon(visibleNoteIndex, gameStatus, true, drawList);
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::drawLongFXNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildLongFXNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 {
-	drawLongNotesCommon(chartData, gameStatus, additiveTarget, invMultiplyTarget, false);
+	buildLongNotesCommon(visibleNoteIndex, gameStatus, false, drawList);
 }
 
 MusicGame::Graphics::ButtonNoteGraphics::ButtonNoteGraphics()
@@ -152,10 +145,11 @@ MusicGame::Graphics::ButtonNoteGraphics::ButtonNoteGraphics()
 {
 }
 
-void MusicGame::Graphics::ButtonNoteGraphics::draw(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const
+void MusicGame::Graphics::ButtonNoteGraphics::buildDrawList(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 {
-	drawLongFXNotes(chartData, gameStatus, additiveTarget, invMultiplyTarget);
-	drawLongBTNotes(chartData, gameStatus, additiveTarget, invMultiplyTarget);
-	drawChipFXNotes(chartData, gameStatus, additiveTarget);
-	drawChipBTNotes(chartData, gameStatus, additiveTarget);
+	// Note: The draw order is preserved in the draw list, so long notes are added before chip notes
+	buildLongFXNotes(visibleNoteIndex, gameStatus, drawList);
+	buildLongBTNotes(visibleNoteIndex, gameStatus, drawList);
+	buildChipFXNotes(visibleNoteIndex, gameStatus, drawList);
+	buildChipBTNotes(visibleNoteIndex, gameStatus, drawList);
 }
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "music_game/game_status.hpp"
+#include "visible_note_index.hpp"
+#include "note_draw_list.hpp"
 
 namespace MusicGame::Graphics
 {
@@ -12,21 +14,21 @@ namespace MusicGame::Graphics
 		const TiledTexture m_chipFXNoteTexture;
 		const Texture m_longFXNoteTexture;
 
-		void drawChipNotesCommon(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, bool isBT) const;
+		void buildChipNotesCommon(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, bool isBT, NoteDrawList& drawList) const;
 
-		void drawChipBTNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget) const;
+		void buildChipBTNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 
-		void drawChipFXNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget) const;
+		void buildChipFXNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 
-		void drawLongNotesCommon(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget, bool isBT) const;
+		void buildLongNotesCommon(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, bool isBT, NoteDrawList& drawList) const;
 
-		void drawLongBTNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const;
+		void buildLongBTNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 
-		void drawLongFXNotes(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const;
+		void buildLongFXNotes(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 
 	public:
 		ButtonNoteGraphics();
 
-		void draw(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const;
+		void buildDrawList(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 	};
 }
@@ -22,6 +22,16 @@ namespace MusicGame::Graphics
 			kLaserNoteStartTextureColumnInvMultiply,
 		};
 
+		double PulseSpaceY(kson::Pulse pulse)
+		{
+			return -static_cast<double>(pulse) * 480 / kson::kResolution;
+		}
+
+		double LaserX(double value)
+		{
+			return value * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2;
+		}
+
 		Quad LaserLineQuad(const Vec2& positionStart, const Vec2& positionEnd)
 		{
 			return {
@@ -32,30 +42,8 @@ namespace MusicGame::Graphics
 			};
 		}
 
-		void DrawLaserLine(int32 laneIdx, kson::RelPulse relPulse1, const kson::GraphValue& point1, kson::RelPulse relPulse2, const kson::GraphValue& point2, const Texture& laserNoteTexture)
-		{
-			const Vec2 positionStart = {
-				point1.vf * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-				static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse1) * 480 / kson::kResolution + kLaserShiftY - ((point1.v != point1.vf) ? kLaserTextureSize.y : 0.0)
-			};
-
-			const Vec2 positionEnd = {
-				point2.v * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-				static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse2) * 480 / kson::kResolution + kLaserShiftY
-			};
-
-			const Quad quad = LaserLineQuad(positionStart, positionEnd);
-			quad(laserNoteTexture(kLaserTextureSize.x * laneIdx, kLaserTextureSize.y - 1 + kOnePixelTextureSourceOffset, kLaserTextureSize.x, kOnePixelTextureSourceSize)).draw();
-		}
-
 		Quad LaserSlamLineQuad(const Vec2& positionStart, const Vec2& positionEnd)
 		{
-			if (Abs(positionEnd.x - positionStart.x) <= kLaserLineWidth)
-			{
-				// Too short to draw line
-				return { Vec2::Zero(), Vec2::Zero(), Vec2::Zero(), Vec2::Zero() };
-			}
-
 			const int diffXSign = Sign(positionEnd.x - positionStart.x);
 			return {
 				positionStart + Vec2{ diffXSign * kLaserLineWidth / 2, -kLaserLineWidth },
@@ -65,103 +53,138 @@ namespace MusicGame::Graphics
 			};
 		}
 
-		void DrawLaserSlam(int32 laneIdx, kson::RelPulse relPulse, const kson::GraphValue& point, const Texture& laserNoteTexture)
+		void AddLaserQuad(Array<LaserNoteGraphics::LaserQuad>& quads, LaserNoteGraphics::LaserQuadType type, const Quad& quad, const RectF& sourceRect, bool mirrored = false, bool flipped = false)
 		{
-			const Vec2 positionStart = {
-				point.v * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-				static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse) * 480 / kson::kResolution + kLaserShiftY
-			};
-
-			const Vec2 positionEnd = {
-				point.vf * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-				static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse) * 480 / kson::kResolution + kLaserShiftY
-			};
-
-			// Draw angles
-			const bool isLeftToRight = (point.v < point.vf);
-			laserNoteTexture(kLaserTextureSize.x * laneIdx, 0, kLaserTextureSize).mirrored(isLeftToRight).drawAt(positionStart + Vec2{ 0.0, -kLaserLineWidth / 2 });
-			laserNoteTexture(kLaserTextureSize.x * laneIdx, 0, kLaserTextureSize).mirrored(!isLeftToRight).flipped().drawAt(positionEnd + Vec2{ 0.0, -kLaserLineWidth / 2 });
+			const double minY = std::min({ quad.p0.y, quad.p1.y, quad.p2.y, quad.p3.y });
+			const double maxY = std::max({ quad.p0.y, quad.p1.y, quad.p2.y, quad.p3.y });
+			quads.push_back({
+				.type = type,
+				.quad = quad,
+				.minY = minY,
+				.maxY = maxY,
+				.sourceRect = sourceRect,
+				.mirrored = mirrored,
+				.flipped = flipped,
+			});
+		}
 
-			// Draw line
-			const Quad quad = LaserSlamLineQuad(positionStart, positionEnd);
-			quad(laserNoteTexture(kLaserTextureSize.x * laneIdx + kOnePixelTextureSourceOffset, 0, kOnePixelTextureSourceSize, kLaserTextureSize.y)).draw();
+		RectF LaserLineSourceRect(int32 laneIdx)
+		{
+			return RectF(kLaserTextureSize.x * laneIdx, kLaserTextureSize.y - 1 + kOnePixelTextureSourceOffset, kLaserTextureSize.x, kOnePixelTextureSourceSize);
 		}
 
-		void DrawLaserSlamTail(int32 laneIdx, kson::RelPulse relPulse, const kson::GraphValue& point, const Texture& laserNoteTexture)
+		void AddLaserLine(Array<LaserNoteGraphics::LaserQuad>& quads, int32 laneIdx, kson::Pulse pulse1, const kson::GraphValue& point1, kson::Pulse pulse2, const kson::GraphValue& point2)
 		{
-			const Vec2 positionStart = {
-				point.vf * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-				static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse) * 480 / kson::kResolution + kLaserShiftY
-			};
-			const Quad quad = LaserLineQuad(positionStart + Vec2{ 0.0, -kLaserTextureSize.y }, positionStart + Vec2{ 0.0, -kLaserTextureSize.y - 80.0 });
-			quad(laserNoteTexture(kLaserTextureSize.x * laneIdx, kLaserTextureSize.y - 1 + kOnePixelTextureSourceOffset, kLaserTextureSize.x, kOnePixelTextureSourceSize)).draw();
+			const Vec2 positionStart = { LaserX(point1.vf), PulseSpaceY(pulse1) - ((point1.v != point1.vf) ? kLaserTextureSize.y : 0.0) };
+			const Vec2 positionEnd = { LaserX(point2.v), PulseSpaceY(pulse2) };
+			AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kBody, LaserLineQuad(positionStart, positionEnd), LaserLineSourceRect(laneIdx));
 		}
 
-		void DrawLaserSection(int32 laneIdx, kson::RelPulse relPulse, const kson::LaserSection& laserSection, const RenderTexture& target, const Texture& laserNoteTexture, const TextureRegion& laserStartTexture)
+		void AddLaserSlam(Array<LaserNoteGraphics::LaserQuad>& quads, int32 laneIdx, kson::Pulse pulse, const kson::GraphValue& point)
 		{
-			const double positionSectionStartY = static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse) * 480 / kson::kResolution + kLaserShiftY;
-			if (positionSectionStartY + kLaserStartTextureSize.y < 0)
+			const Vec2 positionStart = { LaserX(point.v), PulseSpaceY(pulse) };
+			const Vec2 positionEnd = { LaserX(point.vf), PulseSpaceY(pulse) };
+
+			// Angles
+			const bool isLeftToRight = (point.v < point.vf);
+			const RectF angleSourceRect(kLaserTextureSize.x * laneIdx, 0, kLaserTextureSize.x, kLaserTextureSize.y);
+			AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kBody, RectF(Arg::center = positionStart + Vec2{ 0.0, -kLaserLineWidth / 2 }, kLaserTextureSize.x, kLaserTextureSize.y).asQuad(), angleSourceRect, isLeftToRight, false);
+			AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kBody, RectF(Arg::center = positionEnd + Vec2{ 0.0, -kLaserLineWidth / 2 }, kLaserTextureSize.x, kLaserTextureSize.y).asQuad(), angleSourceRect, !isLeftToRight, true);
+
+			// Line
+			if (Abs(positionEnd.x - positionStart.x) > kLaserLineWidth) // Note: Too short to draw line otherwise
 			{
-				// Laser section is above the drawing area
-				return;
+				const RectF lineSourceRect(kLaserTextureSize.x * laneIdx + kOnePixelTextureSourceOffset, 0, kOnePixelTextureSourceSize, kLaserTextureSize.y);
+				AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kBody, LaserSlamLineQuad(positionStart, positionEnd), lineSourceRect);
 			}
+		}
 
-			const ScopedRenderTarget2D renderTarget(target);
+		void AddLaserSlamTail(Array<LaserNoteGraphics::LaserQuad>& quads, int32 laneIdx, kson::Pulse pulse, const kson::GraphValue& point)
+		{
+			const Vec2 positionStart = { LaserX(point.vf), PulseSpaceY(pulse) };
+			const Quad quad = LaserLineQuad(positionStart + Vec2{ 0.0, -kLaserTextureSize.y }, positionStart + Vec2{ 0.0, -kLaserTextureSize.y - 80.0 });
+			AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kBody, quad, LaserLineSourceRect(laneIdx));
+		}
 
+		Array<LaserNoteGraphics::LaserQuad> TessellateLaserSection(int32 laneIdx, kson::Pulse y, const kson::LaserSection& laserSection)
+		{
+			Array<LaserNoteGraphics::LaserQuad> quads;
 			for (auto itr = laserSection.v.begin(); itr != laserSection.v.end(); ++itr)
 			{
 				const auto& [ry, point] = *itr;
+				const kson::Pulse pulse = y + ry;
 
-				// Draw laser start texture
+				// Laser start texture
 				if (itr == laserSection.v.begin())
 				{
-					const Vec2 positionStart = {
-						point.v * (kHighwayTextureSize.x - kLaserLineWidth) + kLaserLineWidth / 2,
-						static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse + ry) * 480 / kson::kResolution + kLaserShiftY
-					};
-					laserStartTexture.draw(Arg::topCenter = positionStart);
+					const Vec2 positionStart = { LaserX(point.v), PulseSpaceY(pulse) };
+					AddLaserQuad(quads, LaserNoteGraphics::LaserQuadType::kStart, RectF(Arg::topCenter = positionStart, kLaserStartTextureSize.x, kLaserStartTextureSize.y).asQuad(), RectF{});
 				}
 
-				const double positionStartY = static_cast<double>(kHighwayTextureSize.y) - static_cast<double>(relPulse + ry) * 480 / kson::kResolution + kLaserShiftY;
-				if (positionStartY < 0)
-				{
-					// Laser point is above the drawing area
-					return;
-				}
-
-				// Draw laser slam
+				// Laser slam
 				if (point.v != point.vf)
 				{
-					DrawLaserSlam(laneIdx, relPulse + ry, point, laserNoteTexture);
+					AddLaserSlam(quads, laneIdx, pulse, point);
 				}
 
 				// Last laser point does not create laser line
 				const auto nextItr = std::next(itr);
 				if (nextItr == laserSection.v.end())
 				{
-					// If the last point is a laser slam, draw its tail
+					// If the last point is a laser slam, add its tail
 					if (point.v != point.vf)
 					{
-						DrawLaserSlamTail(laneIdx, relPulse + ry, point, laserNoteTexture);
+						AddLaserSlamTail(quads, laneIdx, pulse, point);
 					}
 
 					break;
 				}
 
-				// Draw laser line by two laser points
+				// Laser line by two laser points
+				const auto& [nextRy, nextPoint] = *nextItr;
+				AddLaserLine(quads, laneIdx, pulse, point, y + nextRy, nextPoint);
+			}
+			return quads;
+		}
+
+		std::array<LaserNoteGraphics::LaserQuadList, static_cast<std::size_t>(LaserNoteGraphics::LaserQuadType::kNumTypes)> SplitLaserQuadsByType(const Array<LaserNoteGraphics::LaserQuad>& quads)
+		{
+			std::array<LaserNoteGraphics::LaserQuadList, static_cast<std::size_t>(LaserNoteGraphics::LaserQuadType::kNumTypes)> quadLists;
+			for (const auto& quad : quads)
+			{
+				auto& quadList = quadLists[static_cast<std::size_t>(quad.type)];
+				quadList.quads.push_back(quad);
+				quadList.maxHeight = Max(quadList.maxHeight, quad.maxY - quad.minY);
+			}
+			for (auto& quadList : quadLists)
+			{
+				std::stable_sort(quadList.quads.begin(), quadList.quads.end(),
+					[](const LaserNoteGraphics::LaserQuad& a, const LaserNoteGraphics::LaserQuad& b) { return a.minY < b.minY; });
+			}
+			return quadLists;
+		}
+
+		std::array<Array<LaserNoteGraphics::LaserSectionGeometry>, kson::kNumLaserLanesSZ> TessellateLaserLanes(const kson::ChartData& chartData)
+		{
+			std::array<Array<LaserNoteGraphics::LaserSectionGeometry>, kson::kNumLaserLanesSZ> sectionGeometries;
+			for (int32 laneIdx = 0; laneIdx < kson::kNumLaserLanes; ++laneIdx)
+			{
+				const auto& lane = chartData.note.laser[laneIdx];
+				auto& geometries = sectionGeometries[laneIdx];
+				geometries.reserve(lane.size());
+				for (const auto& [y, laserSection] : lane)
 				{
-					const auto& [nextRy, nextPoint] = *nextItr;
-					if (relPulse + nextRy < -kson::kResolution)
-					{
-						continue;
-					}
-					DrawLaserLine(laneIdx, relPulse + ry, point, relPulse + nextRy, nextPoint, laserNoteTexture);
+					geometries.push_back({
+						.y = y,
+						.quadLists = SplitLaserQuadsByType(TessellateLaserSection(laneIdx, y, laserSection)),
+					});
 				}
 			}
+			return sectionGeometries;
 		}
 	}
 
-	LaserNoteGraphics::LaserNoteGraphics()
+	LaserNoteGraphics::LaserNoteGraphics(const kson::ChartData& chartData)
 		: m_laserNoteTexture(TextureAsset(kLaserNoteTextureFilename))
 		, m_laserNoteMaskTexture(TextureAsset(kLaserNoteMaskTextureFilename))
 		, m_laserNoteStartTextures{
@@ -177,23 +200,66 @@ namespace MusicGame::Graphics
 					.column = 2,
 					.sourceSize = kLaserStartTextureSize,
 				}) }
+		, m_sectionGeometries(TessellateLaserLanes(chartData))
 	{
 	}
 
-	void LaserNoteGraphics::draw(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const
+	void LaserNoteGraphics::buildDrawList(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const
 	{
-		const ScopedRenderStates2D samplerState(SamplerState::ClampNearest);
-		const ScopedRenderStates2D renderState(BlendState::Additive);
+		// Pulse space to highway texture space
+		const double scrollOffsetY = static_cast<double>(kHighwayTextureSize.y) + kLaserShiftY - PulseSpaceY(gameStatus.currentPulse);
+		const double highwayTextureHeight = static_cast<double>(kHighwayTextureSize.y);
 
-		// Draw laser notes
-		for (int32 laneIdx = 0; laneIdx < kson::kNumLaserLanes; ++laneIdx) // Note: Use int32 instead of size_t here to avoid extra casting
+		// Note: Laser notes are drawn with additive blending, so the draw order does not matter within this pass.
+		//       The laser body quads of both lanes are added first and the start textures after them, so that
+		//       each texture needs only one bucket per render target.
+		for (const LaserQuadType type : { LaserQuadType::kBody, LaserQuadType::kStart })
 		{
-			const auto& lane = chartData.note.laser[laneIdx];
-			for (const auto& [y, laserSection] : lane)
+			for (int32 laneIdx = 0; laneIdx < kson::kNumLaserLanes; ++laneIdx) // Note: Use int32 instead of size_t here to avoid extra casting
 			{
-				const kson::RelPulse relPulse = y - gameStatus.currentPulse;
-				DrawLaserSection(laneIdx, relPulse, laserSection, additiveTarget, m_laserNoteTexture, m_laserNoteStartTextures[laneIdx](0, kLaserNoteStartTextureColumnAdditive));
-				DrawLaserSection(laneIdx, relPulse, laserSection, invMultiplyTarget, m_laserNoteMaskTexture, m_laserNoteStartTextures[laneIdx](0, kLaserNoteStartTextureColumnInvMultiply));
+				const auto& range = visibleNoteIndex.laserLaneRange(laneIdx);
+				if (range.begin() == range.end())
+				{
+					continue;
+				}
+
+				const auto& geometries = m_sectionGeometries[laneIdx];
+				auto geometryItr = std::lower_bound(geometries.begin(), geometries.end(), range.begin()->first,
+					[](const LaserSectionGeometry& geometry, kson::Pulse y) { return geometry.y < y; });
+				for (auto itr = range.begin(); itr != range.end() && geometryItr != geometries.end(); ++itr, ++geometryItr)
+				{
+					// Note: Only the quads whose minY is in the drawing area extended upward by the tallest quad can be visible
+					const auto& quadList = geometryItr->quadLists[static_cast<std::size_t>(type)];
+					const auto quadBeginItr = std::lower_bound(quadList.quads.begin(), quadList.quads.end(), -scrollOffsetY - quadList.maxHeight,
+						[](const LaserQuad& laserQuad, double y) { return laserQuad.minY < y; });
+					const auto quadEndItr = std::upper_bound(quadBeginItr, quadList.quads.end(), highwayTextureHeight - scrollOffsetY,
+						[](double y, const LaserQuad& laserQuad) { return y < laserQuad.minY; });
+					for (auto quadItr = quadBeginItr; quadItr != quadEndItr; ++quadItr)
+					{
+						const LaserQuad& laserQuad = *quadItr;
+						if (laserQuad.maxY + scrollOffsetY < 0.0)
+						{
+							// Outside the drawing area
+							continue;
+						}
+
+						const Quad quad = laserQuad.quad.movedBy(0.0, scrollOffsetY);
+						if (type == LaserQuadType::kStart)
+						{
+							const auto& startTexture = m_laserNoteStartTextures[laneIdx];
+							drawList.addQuad(NoteDrawTarget::kAdditive, NoteDrawBlend::kAdditive, quad, startTexture(0, kLaserNoteStartTextureColumnAdditive));
+							drawList.addQuad(NoteDrawTarget::kInvMultiply, NoteDrawBlend::kAdditive, quad, startTexture(0, kLaserNoteStartTextureColumnInvMultiply));
+						}
+						else
+						{
+							const RectF& rect = laserQuad.sourceRect;
+							drawList.addQuad(NoteDrawTarget::kAdditive, NoteDrawBlend::kAdditive, quad,
+								m_laserNoteTexture(rect.x, rect.y, rect.w, rect.h).mirrored(laserQuad.mirrored).flipped(laserQuad.flipped));
+							drawList.addQuad(NoteDrawTarget::kInvMultiply, NoteDrawBlend::kAdditive, quad,
+								m_laserNoteMaskTexture(rect.x, rect.y, rect.w, rect.h).mirrored(laserQuad.mirrored).flipped(laserQuad.flipped));
+						}
+					}
+				}
 			}
 		}
 	}
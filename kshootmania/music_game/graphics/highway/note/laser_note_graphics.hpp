@@ -1,20 +1,59 @@
 ﻿#pragma once
 #include "music_game/game_status.hpp"
+#include "visible_note_index.hpp"
+#include "note_draw_list.hpp"
 
 namespace MusicGame::Graphics
 {
 	class LaserNoteGraphics
 	{
+	public:
+		enum class LaserQuadType : uint8
+		{
+			kBody = 0, // Uses the laser note texture (or its mask)
+			kStart, // Uses the laser start texture
+
+			kNumTypes,
+		};
+
+		// Laser quad tessellated at chart load
+		// Note: Y coordinates are in pulse space (-pulse * 480 / kResolution + pixel offset), so adding the scroll offset
+		//       of the current pulse gives the position in the highway texture.
+		struct LaserQuad
+		{
+			LaserQuadType type;
+			Quad quad;
+			double minY;
+			double maxY;
+			RectF sourceRect; // Used only for kBody
+			bool mirrored = false;
+			bool flipped = false;
+		};
+
+		// Quads of one LaserQuadType sorted by minY, so that the visible ones can be found by binary search
+		struct LaserQuadList
+		{
+			Array<LaserQuad> quads;
+			double maxHeight = 0.0; // Maximum of maxY - minY
+		};
+
+		struct LaserSectionGeometry
+		{
+			kson::Pulse y;
+			std::array<LaserQuadList, static_cast<std::size_t>(LaserQuadType::kNumTypes)> quadLists;
+		};
+
 	private:
 		const Texture m_laserNoteTexture;
 		const Texture m_laserNoteMaskTexture;
 		const std::array<TiledTexture, kson::kNumLaserLanesSZ> m_laserNoteStartTextures;
 
-		void drawSection(int32 laneIdx, kson::RelPulse relPulse, const kson::LaserSection& laserSection, const RenderTexture& target, const Texture& laserNoteTexture, const TextureRegion& laserStartTexture) const;
+		// Sorted by section pulse, in the same order as chartData.note.laser[laneIdx]
+		const std::array<Array<LaserSectionGeometry>, kson::kNumLaserLanesSZ> m_sectionGeometries;
 
 	public:
-		LaserNoteGraphics();
+		explicit LaserNoteGraphics(const kson::ChartData& chartData);
 
-		void draw(const kson::ChartData& chartData, const GameStatus& gameStatus, const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const;
+		void buildDrawList(const VisibleNoteIndex& visibleNoteIndex, const GameStatus& gameStatus, NoteDrawList& drawList) const;
 	};
 }
@@ -0,0 +1,124 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace MusicGame::Graphics
+{
+	enum class NoteDrawTarget : std::uint8_t
+	{
+		kAdditive = 0,
+		kInvMultiply,
+
+		kNumTargets,
+	};
+
+	enum class NoteDrawBlend : std::uint8_t
+	{
+		kDefault = 0,
+		kAdditive,
+		kSubtractive,
+	};
+
+	// Assigns the note quads of NoteDrawList to buckets keyed by (render target, blend state, texture)
+	// Note: Only the order within the same render target matters, so a quad is appended to the latest bucket of its target
+	//       if the key matches, and otherwise a new bucket is started. This keeps the draw order of the original per-note drawing.
+	// Note: This does not depend on Siv3D, so that it can be tested headlessly (see kshootmania/test).
+	class NoteDrawBucketer
+	{
+	public:
+		// Note: Buffer2D uses 16-bit vertex indices
+		static constexpr std::size_t kMaxVerticesPerBucket = 65536U;
+
+		static constexpr std::size_t kVerticesPerQuad = 4U;
+
+		struct BucketKey
+		{
+			NoteDrawTarget target = NoteDrawTarget::kAdditive;
+			NoteDrawBlend blend = NoteDrawBlend::kDefault;
+			std::uint64_t textureID = 0U;
+
+			bool operator==(const BucketKey&) const = default;
+		};
+
+		struct AddResult
+		{
+			std::size_t bucketIdx = 0U;
+
+			// Whether the bucket has been started by this quad
+			bool isNewBucket = false;
+		};
+
+	private:
+		std::vector<BucketKey> m_bucketKeys;
+		std::vector<std::size_t> m_bucketNumQuads;
+
+		std::array<std::optional<std::size_t>, static_cast<std::size_t>(NoteDrawTarget::kNumTargets)> m_lastBucketIdxs;
+
+		std::size_t m_numQuads = 0U;
+
+	public:
+		void clear()
+		{
+			m_bucketKeys.clear();
+			m_bucketNumQuads.clear();
+			m_lastBucketIdxs.fill(std::nullopt);
+			m_numQuads = 0U;
+		}
+
+		AddResult addQuad(const BucketKey& key)
+		{
+			++m_numQuads;
+
+			auto& lastBucketIdx = m_lastBucketIdxs[static_cast<std::size_t>(key.target)];
+			if (lastBucketIdx.has_value()
+				&& m_bucketKeys[*lastBucketIdx] == key
+				&& (m_bucketNumQuads[*lastBucketIdx] + 1U) * kVerticesPerQuad <= kMaxVerticesPerBucket)
+			{
+				++m_bucketNumQuads[*lastBucketIdx];
+				return { .bucketIdx = *lastBucketIdx, .isNewBucket = false };
+			}
+
+			lastBucketIdx = m_bucketKeys.size();
+			m_bucketKeys.push_back(key);
+			m_bucketNumQuads.push_back(1U);
+			return { .bucketIdx = *lastBucketIdx, .isNewBucket = true };
+		}
+
+		std::size_t numQuads() const
+		{
+			return m_numQuads;
+		}
+
+		std::size_t numBuckets() const
+		{
+			return m_bucketKeys.size();
+		}
+
+		const BucketKey& bucketKey(std::size_t bucketIdx) const
+		{
+			return m_bucketKeys[bucketIdx];
+		}
+
+		std::size_t bucketNumQuads(std::size_t bucketIdx) const
+		{
+			return m_bucketNumQuads[bucketIdx];
+		}
+
+		// Number of render target or blend state changes needed to submit all buckets in order
+		std::size_t numStateChanges() const
+		{
+			std::size_t numStateChanges = 0U;
+			for (std::size_t i = 0U; i < m_bucketKeys.size(); ++i)
+			{
+				if (i == 0U || m_bucketKeys[i].target != m_bucketKeys[i - 1U].target || m_bucketKeys[i].blend != m_bucketKeys[i - 1U].blend)
+				{
+					++numStateChanges;
+				}
+			}
+			return numStateChanges;
+		}
+	};
+}
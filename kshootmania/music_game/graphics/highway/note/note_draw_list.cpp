@@ -0,0 +1,94 @@
+﻿#include "note_draw_list.hpp"
+
+namespace MusicGame::Graphics
+{
+	namespace
+	{
+		BlendState ToBlendState(NoteDrawBlend blend)
+		{
+			switch (blend)
+			{
+			case NoteDrawBlend::kAdditive:
+				return BlendState::Additive;
+
+			case NoteDrawBlend::kSubtractive:
+				return BlendState::Subtractive;
+
+			default:
+				return BlendState::Default2D;
+			}
+		}
+	}
+
+	void NoteDrawList::clear()
+	{
+		m_bucketer.clear();
+	}
+
+	void NoteDrawList::addQuad(NoteDrawTarget target, NoteDrawBlend blend, const Quad& quad, const TextureRegion& textureRegion)
+	{
+		const auto [bucketIdx, isNewBucket] = m_bucketer.addQuad({ .target = target, .blend = blend, .textureID = textureRegion.texture.id().value() });
+		if (bucketIdx == m_buckets.size())
+		{
+			m_buckets.push_back(Bucket{});
+		}
+
+		Bucket& bucket = m_buckets[bucketIdx];
+		auto& vertices = bucket.buffer.vertices;
+		auto& indices = bucket.buffer.indices;
+		if (isNewBucket)
+		{
+			bucket.texture = textureRegion.texture;
+			vertices.clear();
+			indices.clear();
+		}
+
+		const auto baseIdx = static_cast<Vertex2D::IndexType>(vertices.size());
+		const FloatRect& uv = textureRegion.uvRect;
+		constexpr Float4 kColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+		vertices.push_back(Vertex2D{ .pos = Float2{ quad.p0 }, .tex = { uv.left, uv.top }, .color = kColor });
+		vertices.push_back(Vertex2D{ .pos = Float2{ quad.p1 }, .tex = { uv.right, uv.top }, .color = kColor });
+		vertices.push_back(Vertex2D{ .pos = Float2{ quad.p2 }, .tex = { uv.right, uv.bottom }, .color = kColor });
+		vertices.push_back(Vertex2D{ .pos = Float2{ quad.p3 }, .tex = { uv.left, uv.bottom }, .color = kColor });
+		indices.push_back(TriangleIndex{ baseIdx, static_cast<Vertex2D::IndexType>(baseIdx + 1), static_cast<Vertex2D::IndexType>(baseIdx + 2) });
+		indices.push_back(TriangleIndex{ baseIdx, static_cast<Vertex2D::IndexType>(baseIdx + 2), static_cast<Vertex2D::IndexType>(baseIdx + 3) });
+	}
+
+	void NoteDrawList::addRect(NoteDrawTarget target, NoteDrawBlend blend, const RectF& rect, const TextureRegion& textureRegion)
+	{
+		addQuad(target, blend, rect.asQuad(), textureRegion);
+	}
+
+	std::size_t NoteDrawList::numQuads() const
+	{
+		return m_bucketer.numQuads();
+	}
+
+	std::size_t NoteDrawList::numBuckets() const
+	{
+		return m_bucketer.numBuckets();
+	}
+
+	std::size_t NoteDrawList::numStateChanges() const
+	{
+		return m_bucketer.numStateChanges();
+	}
+
+	void NoteDrawList::submit(const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const
+	{
+		// Note: Consecutive buckets with the same target and blend state share one scope
+		const std::size_t numBuckets = m_bucketer.numBuckets();
+		std::size_t i = 0U;
+		while (i < numBuckets)
+		{
+			const NoteDrawTarget target = m_bucketer.bucketKey(i).target;
+			const NoteDrawBlend blend = m_bucketer.bucketKey(i).blend;
+			const ScopedRenderTarget2D renderTarget((target == NoteDrawTarget::kAdditive) ? additiveTarget : invMultiplyTarget);
+			const ScopedRenderStates2D blendState(ToBlendState(blend));
+			for (; i < numBuckets && m_bucketer.bucketKey(i).target == target && m_bucketer.bucketKey(i).blend == blend; ++i)
+			{
+				m_buckets[i].buffer.draw(m_buckets[i].texture);
+			}
+		}
+	}
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "note_draw_bucketer.hpp"
+
+namespace MusicGame::Graphics
+{
+	// CPU-side draw list of the textured note quads
+	// Note: Quads are grouped into buckets by NoteDrawBucketer, and each bucket is submitted with a single state change
+	//       and a single Buffer2D draw.
+	class NoteDrawList
+	{
+	private:
+		struct Bucket
+		{
+			Texture texture;
+			Buffer2D buffer;
+		};
+
+		NoteDrawBucketer m_bucketer;
+
+		// Buckets after m_bucketer.numBuckets() are kept only for reusing their capacity
+		Array<Bucket> m_buckets;
+
+	public:
+		NoteDrawList() = default;
+
+		// Note: The allocated buffers are kept for the next frame
+		void clear();
+
+		void addQuad(NoteDrawTarget target, NoteDrawBlend blend, const Quad& quad, const TextureRegion& textureRegion);
+
+		void addRect(NoteDrawTarget target, NoteDrawBlend blend, const RectF& rect, const TextureRegion& textureRegion);
+
+		std::size_t numQuads() const;
+
+		std::size_t numBuckets() const;
+
+		// Number of render target or blend state changes needed to submit all buckets
+		std::size_t numStateChanges() const;
+
+		void submit(const RenderTexture& additiveTarget, const RenderTexture& invMultiplyTarget) const;
+	};
+}
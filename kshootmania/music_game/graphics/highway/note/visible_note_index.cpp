@@ -0,0 +1,55 @@
+﻿#include "visible_note_index.hpp"
+
+namespace MusicGame::Graphics
+{
+	VisibleNoteIndex::VisibleNoteIndex(const kson::ChartData& chartData)
+		: m_btLaneRanges{
+			LaneVisibleRange<kson::Interval>(chartData.note.bt[0]),
+			LaneVisibleRange<kson::Interval>(chartData.note.bt[1]),
+			LaneVisibleRange<kson::Interval>(chartData.note.bt[2]),
+			LaneVisibleRange<kson::Interval>(chartData.note.bt[3]) }
+		, m_fxLaneRanges{
+			LaneVisibleRange<kson::Interval>(chartData.note.fx[0]),
+			LaneVisibleRange<kson::Interval>(chartData.note.fx[1]) }
+		, m_laserLaneRanges{
+			LaneVisibleRange<kson::LaserSection>(chartData.note.laser[0]),
+			LaneVisibleRange<kson::LaserSection>(chartData.note.laser[1]) }
+	{
+	}
+
+	void VisibleNoteIndex::update(kson::Pulse currentPulse, kson::RelPulse pulsesBehind, kson::RelPulse pulsesAhead)
+	{
+		const kson::Pulse visibleStartPulse = currentPulse - pulsesBehind;
+		const kson::Pulse visibleEndPulse = currentPulse + pulsesAhead;
+
+		for (auto& range : m_btLaneRanges)
+		{
+			range.update(visibleStartPulse, visibleEndPulse);
+		}
+
+		for (auto& range : m_fxLaneRanges)
+		{
+			range.update(visibleStartPulse, visibleEndPulse);
+		}
+
+		for (auto& range : m_laserLaneRanges)
+		{
+			range.update(visibleStartPulse, visibleEndPulse);
+		}
+	}
+
+	const LaneVisibleRange<kson::Interval>& VisibleNoteIndex::btLaneRange(std::size_t laneIdx) const
+	{
+		return m_btLaneRanges.at(laneIdx);
+	}
+
+	const LaneVisibleRange<kson::Interval>& VisibleNoteIndex::fxLaneRange(std::size_t laneIdx) const
+	{
+		return m_fxLaneRanges.at(laneIdx);
+	}
+
+	const LaneVisibleRange<kson::LaserSection>& VisibleNoteIndex::laserLaneRange(std::size_t laneIdx) const
+	{
+		return m_laserLaneRanges.at(laneIdx);
+	}
+}
@@ -0,0 +1,141 @@
+﻿#pragma once
+#include "kson/chart_data.hpp"
+
+namespace MusicGame::Graphics
+{
+	inline kson::Pulse NoteEndPulse(kson::Pulse y, const kson::Interval& note)
+	{
+		return y + note.length;
+	}
+
+	inline kson::Pulse NoteEndPulse(kson::Pulse y, const kson::LaserSection& laserSection)
+	{
+		return laserSection.v.empty() ? y : y + laserSection.v.rbegin()->first;
+	}
+
+	// Range of the notes in a lane that overlap [visibleStartPulse, visibleEndPulse]
+	// Note: Notes in a lane never overlap each other, so both the start and end pulses are sorted in the map order.
+	//       The iterators are moved forward step by step while playing, and are re-seeked by binary search only for
+	//       backward moves (e.g. hi-speed decrease, practice rewind) and long jumps.
+	template <typename T>
+	class LaneVisibleRange
+	{
+	public:
+		using Iterator = typename kson::ByPulse<T>::const_iterator;
+
+	private:
+		static constexpr int32 kMaxForwardSteps = 8;
+
+		const kson::ByPulse<T>* m_pLane;
+
+		// First note whose end pulse is at or after visibleStartPulse
+		Iterator m_begin;
+
+		// First note whose start pulse is after visibleEndPulse
+		Iterator m_end;
+
+		kson::Pulse m_visibleStartPulse = kson::Pulse{ 0 };
+		kson::Pulse m_visibleEndPulse = kson::Pulse{ -1 };
+
+		Iterator seekBegin(kson::Pulse visibleStartPulse) const
+		{
+			auto itr = m_pLane->lower_bound(visibleStartPulse);
+			if (itr != m_pLane->begin())
+			{
+				// Only the previous note can overlap visibleStartPulse
+				const auto prevItr = std::prev(itr);
+				if (NoteEndPulse(prevItr->first, prevItr->second) >= visibleStartPulse)
+				{
+					itr = prevItr;
+				}
+			}
+			return itr;
+		}
+
+		void updateBegin(kson::Pulse visibleStartPulse)
+		{
+			if (visibleStartPulse < m_visibleStartPulse)
+			{
+				m_begin = seekBegin(visibleStartPulse);
+				return;
+			}
+
+			for (int32 i = 0; m_begin != m_pLane->end() && NoteEndPulse(m_begin->first, m_begin->second) < visibleStartPulse; ++i)
+			{
+				if (i >= kMaxForwardSteps)
+				{
+					m_begin = seekBegin(visibleStartPulse);
+					return;
+				}
+				++m_begin;
+			}
+		}
+
+		void updateEnd(kson::Pulse visibleEndPulse)
+		{
+			if (visibleEndPulse < m_visibleEndPulse)
+			{
+				m_end = m_pLane->upper_bound(visibleEndPulse);
+				return;
+			}
+
+			for (int32 i = 0; m_end != m_pLane->end() && m_end->first <= visibleEndPulse; ++i)
+			{
+				if (i >= kMaxForwardSteps)
+				{
+					m_end = m_pLane->upper_bound(visibleEndPulse);
+					return;
+				}
+				++m_end;
+			}
+		}
+
+	public:
+		explicit LaneVisibleRange(const kson::ByPulse<T>& lane)
+			: m_pLane(&lane)
+			, m_begin(lane.begin())
+			, m_end(lane.begin())
+		{
+		}
+
+		void update(kson::Pulse visibleStartPulse, kson::Pulse visibleEndPulse)
+		{
+			updateBegin(visibleStartPulse);
+			updateEnd(visibleEndPulse);
+			m_visibleStartPulse = visibleStartPulse;
+			m_visibleEndPulse = visibleEndPulse;
+		}
+
+		Iterator begin() const
+		{
+			return m_begin;
+		}
+
+		Iterator end() const
+		{
+			return m_end;
+		}
+	};
+
+	// Per-lane visible note ranges shared by the note drawing passes
+	// Note: This is updated once per frame in Highway3DGraphics::update(), so that each pass does not need to walk
+	//       each lane from the beginning of the chart.
+	class VisibleNoteIndex
+	{
+	private:
+		std::array<LaneVisibleRange<kson::Interval>, kson::kNumBTLanesSZ> m_btLaneRanges;
+		std::array<LaneVisibleRange<kson::Interval>, kson::kNumFXLanesSZ> m_fxLaneRanges;
+		std::array<LaneVisibleRange<kson::LaserSection>, kson::kNumLaserLanesSZ> m_laserLaneRanges;
+
+	public:
+		explicit VisibleNoteIndex(const kson::ChartData& chartData);
+
+		void update(kson::Pulse currentPulse, kson::RelPulse pulsesBehind, kson::RelPulse pulsesAhead);
+
+		const LaneVisibleRange<kson::Interval>& btLaneRange(std::size_t laneIdx) const;
+
+		const LaneVisibleRange<kson::Interval>& fxLaneRange(std::size_t laneIdx) const;
+
+		const LaneVisibleRange<kson::LaserSection>& laserLaneRange(std::size_t laneIdx) const;
+	};
+}
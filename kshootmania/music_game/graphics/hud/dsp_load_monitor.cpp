@@ -0,0 +1,24 @@
+﻿#include "dsp_load_monitor.hpp"
+
+namespace MusicGame::Graphics
+{
+	DSPLoadMonitor::DSPLoadMonitor()
+		: m_font(ScreenUtils::Scaled(9))
+	{
+	}
+
+	void DSPLoadMonitor::update(const ksmaudio::DSPLoadSnapshot& snapshot)
+	{
+		m_snapshot = snapshot;
+	}
+
+	void DSPLoadMonitor::draw() const
+	{
+		using namespace ScreenUtils;
+
+		// Percentages of the audio block duration spent in the audio effect DSPs
+		const String text = U"DSP p95:{:.0f}% max:{:.0f}% xrun:{}"_fmt(m_snapshot.p95 * 100, m_snapshot.max * 100, m_snapshot.numOverruns);
+		const ColorF color = m_snapshot.numOverruns > 0U ? Palette::Red : Palette::White;
+		m_font(text).draw(Arg::bottomRight = Vec2{ Scene::Width() - Scaled(42), Scaled(469) }, color);
+	}
+}
@@ -0,0 +1,19 @@
+﻿#pragma once
+#include "ksmaudio/dsp_load_stats.hpp"
+
+namespace MusicGame::Graphics
+{
+	class DSPLoadMonitor
+	{
+	private:
+		const Font m_font;
+		ksmaudio::DSPLoadSnapshot m_snapshot;
+
+	public:
+		DSPLoadMonitor();
+
+		void update(const ksmaudio::DSPLoadSnapshot& snapshot);
+
+		void draw() const;
+	};
+}
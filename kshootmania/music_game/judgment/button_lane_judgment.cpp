@@ -5,61 +5,30 @@ namespace MusicGame::Judgment
 {
 	namespace
 	{
-		constexpr double kHalveComboBPMThreshold = 256.0;
-
-		std::map<kson::Pulse, double> CreatePulseToSec(const kson::ByPulse<kson::Interval>& lane, const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache)
+		ButtonNoteTable CreateNoteTable(const kson::ByPulse<kson::Interval>& lane, const TempoMap& tempoMap)
 		{
-			std::map<kson::Pulse, double> pulseToSec;
-
-			for (const auto& [y, note] : lane)
-			{
-				if (!pulseToSec.contains(y))
-				{
-					const double sec = kson::PulseToSec(y, beatInfo, timingCache);
-					pulseToSec.emplace(y, sec);
-				}
-				if (!pulseToSec.contains(y + note.length))
-				{
-					const double sec = kson::PulseToSec(y + note.length, beatInfo, timingCache);
-					pulseToSec.emplace(y + note.length, sec);
-				}
-			}
-
-			return pulseToSec;
-		}
-
-		kson::ByPulse<JudgmentResult> CreateChipNoteJudgmentArray(const kson::ByPulse<kson::Interval>& lane)
-		{
-			kson::ByPulse<JudgmentResult> judgmentArray;
-
-			for (const auto& [y, note] : lane)
-			{
-				if (note.length == 0)
-				{
-					judgmentArray.emplace(y, JudgmentResult::kUnspecified);
-				}
-			}
-
-			return judgmentArray;
-		}
-
-		kson::ByPulse<JudgmentResult> CreateLongNoteJudgmentArray(const kson::ByPulse<kson::Interval>& lane, const kson::BeatInfo& beatInfo)
-		{
-			kson::ByPulse<JudgmentResult> judgmentArray;
+			ButtonNoteTable table;
+			table.startPulses.reserve(lane.size());
+			table.endPulses.reserve(lane.size());
+			table.longTickOffsets.reserve(lane.size() + 1U);
 
 			for (const auto& [y, note] : lane) // TODO: merge two long notes if note1.y + note1.l == note2.y
 			{
+				table.startPulses.push_back(y);
+				table.endPulses.push_back(y + note.length);
+				table.longTickOffsets.push_back(table.longTickPulses.size());
+
 				if (note.length > 0)
 				{
 					// Determine whether to halve the combo based on the BPM at the start of the note
 					// (BPM changes during the notes are ignored)
-					const bool halvesCombo = kson::TempoAt(y, beatInfo) >= kHalveComboBPMThreshold;
+					const bool halvesCombo = tempoMap.tempoAt(y) >= kHalveComboBPMThreshold;
 					const kson::RelPulse minPulseInterval = halvesCombo ? (kson::kResolution4 * 3 / 8) : (kson::kResolution4 * 3 / 16);
 					const kson::RelPulse pulseInterval = halvesCombo ? (kson::kResolution4 / 8) : (kson::kResolution4 / 16);
 
 					if (note.length <= minPulseInterval)
 					{
-						judgmentArray.emplace(y, JudgmentResult::kUnspecified);
+						table.longTickPulses.push_back(y);
 					}
 					else
 					{
@@ -68,59 +37,65 @@ namespace MusicGame::Judgment
 
 						for (kson::Pulse pulse = start; pulse < end; pulse += pulseInterval)
 						{
-							judgmentArray.emplace(pulse, JudgmentResult::kUnspecified);
+							table.longTickPulses.push_back(pulse);
 						}
 					}
 				}
 			}
+			table.longTickOffsets.push_back(table.longTickPulses.size());
+
+			// Note: Both arrays are sorted because the notes in a lane do not overlap, so each conversion is a single pass
+			table.startSecs = tempoMap.convert(table.startPulses);
+			table.endSecs = tempoMap.convert(table.endPulses);
+
+			table.results.assign(table.size(), JudgmentResult::kUnspecified);
+			table.longTickResults.assign(table.longTickPulses.size(), JudgmentResult::kUnspecified);
 
-			return judgmentArray;
+			return table;
 		}
 
-		bool IsDuringLongNote(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse)
+		int32 ScoreValueMax(const ButtonNoteTable& table)
 		{
-			const auto& currentNoteItr = kson::ValueItrAt(lane, currentPulse);
-			if (currentNoteItr != lane.end())
+			std::size_t numJudgments = table.longTickPulses.size();
+			for (std::size_t i = 0U; i < table.size(); ++i)
 			{
-				const auto& [y, note] = *currentNoteItr;
-				if (y <= currentPulse && currentPulse < y + note.length)
+				if (!table.isLongNote(i))
 				{
-					return true;
+					++numJudgments;
 				}
 			}
-			return false;
+			return static_cast<int32>(numJudgments) * kScoreValueCritical;
 		}
 	}
 
-	void ButtonLaneJudgment::processKeyDown(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, double currentTimeSec, LaneStatus& laneStatusRef)
+	void ButtonLaneJudgment::processKeyDown(kson::Pulse currentPulse, double currentTimeSec, LaneStatus& laneStatusRef)
 	{
 		using namespace TimingWindow;
 
 		// Pick up the nearest note from the lane
 		bool found = false;
 		double minDistance = 0.0;
-		kson::Pulse nearestNotePulse;
-		for (auto itr = lane.upper_bound(m_passedNotePulse); itr != lane.end(); ++itr)
+		std::size_t nearestNoteIdx = 0U;
+		for (std::size_t i = m_passedNoteCursor; i < m_noteTable.size(); ++i)
 		{
-			const auto& [y, note] = *itr;
-			const double sec = m_pulseToSec.at(y);
-			const double endSec = (note.length == 0) ? sec : m_pulseToSec.at(y + note.length);
-			if (currentTimeSec - endSec >= ChipNote::kWindowSecError)
+			const double sec = m_noteTable.startSecs[i];
+			if (currentTimeSec - m_noteTable.endSecs[i] >= ChipNote::kWindowSecError * m_timingWindowScale)
 			{
-				m_passedNotePulse = y;
+				m_passedNoteCursor = i + 1U;
 				continue;
 			}
 
-			if (note.length == 0) // Chip note
+			const kson::Pulse y = m_noteTable.startPulses[i];
+			if (!m_noteTable.isLongNote(i)) // Chip note
 			{
-				if (m_chipJudgmentArray.at(y) != JudgmentResult::kUnspecified)
+				if (m_noteTable.results[i] != JudgmentResult::kUnspecified)
 				{
 					continue;
 				}
 
 				if (!found || Abs(sec - currentTimeSec) < minDistance)
 				{
-					nearestNotePulse = y;
+					nearestNoteIdx = i;
 					minDistance = Abs(sec - currentTimeSec);
 					found = true;
 				}
@@ -131,13 +106,14 @@ namespace MusicGame::Judgment
 			}
 			else // Long note
 			{
-				if ((!found || Abs(sec - currentTimeSec) < minDistance) && sec - currentTimeSec <= LongNote::kWindowSecPreHold && (y + note.length > currentPulse))
+				if ((!found || Abs(sec - currentTimeSec) < minDistance) && sec - currentTimeSec <= LongNote::kWindowSecPreHold * m_timingWindowScale && (m_noteTable.endPulses[i] > currentPulse))
 				{
+					m_currentLongNoteIdx = i;
 					laneStatusRef.currentLongNotePulse = y;
 					laneStatusRef.currentLongNoteAnimOffsetTimeSec = currentTimeSec;
 					return;
 				}
-				else if (found && sec - currentTimeSec > LongNote::kWindowSecPreHold && y > currentPulse)
+				else if (found && sec - currentTimeSec > LongNote::kWindowSecPreHold * m_timingWindowScale && y > currentPulse)
 				{
 					break;
 				}
@@ -149,24 +125,25 @@ namespace MusicGame::Judgment
 
 		if (found)
 		{
+			JudgmentResult& resultRef = m_noteTable.results[nearestNoteIdx];
 			Optional<JudgmentResult> chipAnimType = none;
-			if (minDistance < ChipNote::kWindowSecCritical)
+			if (minDistance < ChipNote::kWindowSecCritical * m_timingWindowScale)
 			{
-				m_chipJudgmentArray.at(nearestNotePulse) = JudgmentResult::kCritical;
+				resultRef = JudgmentResult::kCritical;
 				m_scoreValue += kScoreValueCritical;
 				laneStatusRef.keyBeamType = KeyBeamType::kCritical;
 				chipAnimType = JudgmentResult::kCritical;
 			}
-			else if (minDistance < ChipNote::kWindowSecNear)
+			else if (minDistance < ChipNote::kWindowSecNear * m_timingWindowScale)
 			{
-				m_chipJudgmentArray.at(nearestNotePulse) = JudgmentResult::kNear;
+				resultRef = JudgmentResult::kNear;
 				m_scoreValue += kScoreValueNear;
 				laneStatusRef.keyBeamType = KeyBeamType::kNear; // TODO: fast/slow
 				chipAnimType = JudgmentResult::kNear; // TODO: fast/slow
 			}
-			else if (minDistance < ChipNote::kWindowSecError) // TODO: easy gauge, fast/slow
+			else if (minDistance < ChipNote::kWindowSecError * m_timingWindowScale) // TODO: easy gauge, fast/slow
 			{
-				m_chipJudgmentArray.at(nearestNotePulse) = JudgmentResult::kError;
+				resultRef = JudgmentResult::kError;
 				laneStatusRef.keyBeamType = KeyBeamType::kDefault;
 				chipAnimType = JudgmentResult::kError;
 			}
@@ -183,65 +160,106 @@ namespace MusicGame::Judgment
 		}
 	}
 
-	void ButtonLaneJudgment::processKeyPressed(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, const LaneStatus& laneStatusRef)
+	void ButtonLaneJudgment::processKeyPressed(kson::Pulse currentPulse)
 	{
-		if (laneStatusRef.currentLongNotePulse.has_value())
+		if (!m_currentLongNoteIdx.has_value())
 		{
-			const kson::Pulse noteStartPulse = *laneStatusRef.currentLongNotePulse;
-			const kson::Pulse noteEndPulse = *laneStatusRef.currentLongNotePulse + lane.at(*laneStatusRef.currentLongNotePulse).length;
-			const kson::Pulse limitPulse = Min(currentPulse, noteEndPulse);
+			return;
+		}
 
-			for (auto itr = m_longJudgmentArray.upper_bound(Max(noteStartPulse, m_prevPulse) - 1); itr != m_longJudgmentArray.end(); ++itr)
-			{
-				auto& [y, result] = *itr;
-				if (y >= limitPulse)
-				{
-					break;
-				}
+		const std::size_t noteIdx = *m_currentLongNoteIdx;
+		const kson::Pulse fromPulse = Max(m_noteTable.startPulses[noteIdx], m_prevPulse);
+		const kson::Pulse limitPulse = Min(currentPulse, m_noteTable.endPulses[noteIdx]);
+		const std::size_t tickEnd = m_noteTable.longTickOffsets[noteIdx + 1U];
 
-				if (result == JudgmentResult::kUnspecified)
-				{
-					result = JudgmentResult::kCritical;
-					m_scoreValue += kScoreValueCritical;
-				}
+		// Note: The ticks before the previous pulse have been judged or missed already, so the cursor never goes back
+		m_longTickCursor = Max(m_longTickCursor, m_noteTable.longTickOffsets[noteIdx]);
+		while (m_longTickCursor < tickEnd && m_noteTable.longTickPulses[m_longTickCursor] < fromPulse)
+		{
+			++m_longTickCursor;
+		}
+
+		while (m_longTickCursor < tickEnd && m_noteTable.longTickPulses[m_longTickCursor] < limitPulse)
+		{
+			JudgmentResult& resultRef = m_noteTable.longTickResults[m_longTickCursor];
+			if (resultRef == JudgmentResult::kUnspecified)
+			{
+				resultRef = JudgmentResult::kCritical;
+				m_scoreValue += kScoreValueCritical;
 			}
+			++m_longTickCursor;
 		}
 	}
 
-	ButtonLaneJudgment::ButtonLaneJudgment(KeyConfig::Button keyConfigButton, const kson::ByPulse<kson::Interval>& lane, const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache)
+	void ButtonLaneJudgment::releaseLongNote(double currentTimeSec, LaneStatus& laneStatusRef)
+	{
+		m_currentLongNoteIdx = none;
+		laneStatusRef.currentLongNotePulse = none;
+		laneStatusRef.currentLongNoteAnimOffsetTimeSec = currentTimeSec;
+	}
+
+	bool ButtonLaneJudgment::isDuringLongNote(kson::Pulse currentPulse)
+	{
+		while (m_startedNoteCursor < m_noteTable.size() && m_noteTable.startPulses[m_startedNoteCursor] <= currentPulse)
+		{
+			++m_startedNoteCursor;
+		}
+
+		if (m_startedNoteCursor == 0U)
+		{
+			return false;
+		}
+
+		const std::size_t noteIdx = m_startedNoteCursor - 1U;
+		return m_noteTable.isLongNote(noteIdx) && currentPulse < m_noteTable.endPulses[noteIdx];
+	}
+
+	ButtonLaneJudgment::ButtonLaneJudgment(KeyConfig::Button keyConfigButton, const kson::ByPulse<kson::Interval>& lane, const TempoMap& tempoMap, double playSpeed)
 		: m_keyConfigButton(keyConfigButton)
-		, m_pulseToSec(CreatePulseToSec(lane, beatInfo, timingCache))
-		, m_chipJudgmentArray(CreateChipNoteJudgmentArray(lane))
-		, m_longJudgmentArray(CreateLongNoteJudgmentArray(lane, beatInfo))
-		, m_scoreValueMax(static_cast<int32>(m_chipJudgmentArray.size() + m_longJudgmentArray.size())* kScoreValueCritical)
+		, m_timingWindowScale(playSpeed)
+		, m_noteTable(CreateNoteTable(lane, tempoMap))
+		, m_scoreValueMax(ScoreValueMax(m_noteTable))
 	{
 	}
 
-	void ButtonLaneJudgment::update(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, double currentTimeSec, LaneStatus& laneStatusRef)
+	void ButtonLaneJudgment::update(std::span<const KeyEvent> keyEvents, kson::Pulse currentPulse, double currentTimeSec, LaneStatus& laneStatusRef)
 	{
-		// Chip note & long note start
-		if (KeyConfig::Down(m_keyConfigButton))
+		for (const auto& keyEvent : keyEvents)
 		{
-			processKeyDown(lane, currentPulse, currentTimeSec, laneStatusRef);
+			if (keyEvent.isPressed)
+			{
+				// Chip note & long note start
+				processKeyDown(keyEvent.pulse, keyEvent.timeSec, laneStatusRef);
+				m_isKeyPressed = true;
+			}
+			else
+			{
+				// Long note release (the ticks before the release are still judged)
+				processKeyPressed(keyEvent.pulse);
+				if (m_currentLongNoteIdx.has_value())
+				{
+					releaseLongNote(keyEvent.timeSec, laneStatusRef);
+				}
+				m_isKeyPressed = false;
+			}
+			m_prevPulse = Max(m_prevPulse, keyEvent.pulse);
 		}
 
 		// Long note hold
-		if (KeyConfig::Pressed(m_keyConfigButton))
+		if (m_isKeyPressed)
 		{
-			processKeyPressed(lane, currentPulse, laneStatusRef);
+			processKeyPressed(currentPulse);
 		}
 
-		// Long note release
-		if (laneStatusRef.currentLongNotePulse.has_value() &&
-			(KeyConfig::Up(m_keyConfigButton) || (*laneStatusRef.currentLongNotePulse + lane.at(*laneStatusRef.currentLongNotePulse).length < currentPulse)))
+		// Long note end
+		if (m_currentLongNoteIdx.has_value() && m_noteTable.endPulses[*m_currentLongNoteIdx] < currentPulse)
 		{
-			laneStatusRef.currentLongNotePulse = none;
-			laneStatusRef.currentLongNoteAnimOffsetTimeSec = currentTimeSec;
+			releaseLongNote(currentTimeSec, laneStatusRef);
 		}
 
-		if (IsDuringLongNote(lane, currentPulse))
+		if (isDuringLongNote(currentPulse))
 		{
-			laneStatusRef.longNotePressed = laneStatusRef.currentLongNotePulse.has_value();
+			laneStatusRef.longNotePressed = m_currentLongNoteIdx.has_value();
 		}
 		else
 		{
@@ -251,6 +269,38 @@ namespace MusicGame::Judgment
 		m_prevPulse = currentPulse;
 	}
 
+	KeyConfig::Button ButtonLaneJudgment::keyConfigButton() const
+	{
+		return m_keyConfigButton;
+	}
+
+	const ButtonNoteTable& ButtonLaneJudgment::noteTable() const
+	{
+		return m_noteTable;
+	}
+
+	Optional<JudgmentResult> ButtonLaneJudgment::chipNoteResult(kson::Pulse y, double currentTimeSec) const
+	{
+		const auto itr = std::lower_bound(m_noteTable.startPulses.begin(), m_noteTable.startPulses.end(), y);
+		if (itr == m_noteTable.startPulses.end() || *itr != y)
+		{
+			return none;
+		}
+
+		const std::size_t noteIdx = static_cast<std::size_t>(itr - m_noteTable.startPulses.begin());
+		if (m_noteTable.isLongNote(noteIdx))
+		{
+			return none;
+		}
+
+		const JudgmentResult result = m_noteTable.results[noteIdx];
+		if (result == JudgmentResult::kUnspecified && currentTimeSec - m_noteTable.startSecs[noteIdx] >= TimingWindow::ChipNote::kWindowSecError * m_timingWindowScale)
+		{
+			return JudgmentResult::kError;
+		}
+		return result;
+	}
+
 	int32 ButtonLaneJudgment::scoreValue() const
 	{
 		return m_scoreValue;
@@ -3,34 +3,91 @@
 #include "music_game/game_status.hpp"
 #include "kson/chart_data.hpp"
 #include "kson/util/timing_utils.hpp"
+#include "music_game/tempo_map.hpp"
 
 namespace MusicGame::Judgment
 {
+	// Notes of the lane in structure-of-arrays layout (indexed in pulse order)
+	struct ButtonNoteTable
+	{
+		std::vector<kson::Pulse> startPulses;
+
+		// Same as the start for chip notes
+		std::vector<kson::Pulse> endPulses;
+
+		std::vector<double> startSecs;
+		std::vector<double> endSecs;
+
+		// Judgment of chip notes (long notes are judged by their ticks, so this value is unused for them)
+		std::vector<JudgmentResult> results;
+
+		// Ticks of the i-th note are in [longTickOffsets[i], longTickOffsets[i + 1])
+		std::vector<std::size_t> longTickOffsets;
+
+		std::vector<kson::Pulse> longTickPulses;
+		std::vector<JudgmentResult> longTickResults;
+
+		std::size_t size() const
+		{
+			return startPulses.size();
+		}
+
+		bool isLongNote(std::size_t noteIdx) const
+		{
+			return startPulses[noteIdx] != endPulses[noteIdx];
+		}
+	};
+
 	class ButtonLaneJudgment
 	{
 	private:
 		const KeyConfig::Button m_keyConfigButton;
-		const std::map<kson::Pulse, double> m_pulseToSec;
 
-		kson::ByPulse<JudgmentResult> m_chipJudgmentArray;
-		kson::ByPulse<JudgmentResult> m_longJudgmentArray;
+		// Play speed (timing windows are defined in real time, so they are scaled into the chart time)
+		const double m_timingWindowScale;
 
-		kson::Pulse m_prevPulse = kPastPulse;
+		ButtonNoteTable m_noteTable;
 
-		kson::Pulse m_passedNotePulse = kPastPulse;
+		// Index of the first note that is not passed yet
+		std::size_t m_passedNoteCursor = 0U;
+
+		// Number of notes started at or before the current pulse
+		std::size_t m_startedNoteCursor = 0U;
+
+		bool m_isKeyPressed = false;
+
+		// Index of the long note being held
+		Optional<std::size_t> m_currentLongNoteIdx = none;
+
+		// Index of the next long note tick to be judged
+		std::size_t m_longTickCursor = 0U;
+
+		kson::Pulse m_prevPulse = kPastPulse;
 
 		int32 m_scoreValue = 0;
 
 		const int32 m_scoreValueMax;
 
-		void processKeyDown(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, double currentSec, LaneStatus& laneStatusRef);
+		void processKeyDown(kson::Pulse currentPulse, double currentSec, LaneStatus& laneStatusRef);
 
-		void processKeyPressed(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, const LaneStatus& laneStatusRef);
+		void processKeyPressed(kson::Pulse currentPulse);
+
+		void releaseLongNote(double currentSec, LaneStatus& laneStatusRef);
+
+		bool isDuringLongNote(kson::Pulse currentPulse);
 
 	public:
-		ButtonLaneJudgment(KeyConfig::Button keyConfigButton, const kson::ByPulse<kson::Interval>& lane, const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache);
+		ButtonLaneJudgment(KeyConfig::Button keyConfigButton, const kson::ByPulse<kson::Interval>& lane, const TempoMap& tempoMap, double playSpeed = 1.0);
+
+		// Note: The key events are judged at their own timestamps rather than the frame time
+		void update(std::span<const KeyEvent> keyEvents, kson::Pulse currentPulse, double currentSec, LaneStatus& laneStatusRef);
+
+		KeyConfig::Button keyConfigButton() const;
+
+		const ButtonNoteTable& noteTable() const;
 
-		void update(const kson::ByPulse<kson::Interval>& lane, kson::Pulse currentPulse, double currentSec, LaneStatus& laneStatusRef);
+		// Judgment of the chip note at the pulse (kError once the note has passed without being pressed, none if there is no chip note at the pulse)
+		Optional<JudgmentResult> chipNoteResult(kson::Pulse y, double currentTimeSec) const;
 
 		int32 scoreValue() const;
 
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include "kson/chart_data.hpp"
 
 namespace MusicGame::Judgment
 {
@@ -22,6 +23,16 @@ namespace MusicGame::Judgment
 		kNumBeamTypes,
 	};
 
+	// Press or release of the button of a lane, mapped onto the chart time
+	struct KeyEvent
+	{
+		bool isPressed = false;
+
+		double timeSec = 0.0;
+
+		kson::Pulse pulse = 0;
+	};
+
 	namespace TimingWindow
 	{
 		namespace ChipNote
@@ -56,8 +67,20 @@ namespace MusicGame::Judgment
 		{
 			constexpr double kWindowSecPreHold = 0.15;
 		}
+
+		namespace LaserNote
+		{
+			constexpr double kWindowSecSlamEarly = 0.08;
+			constexpr double kWindowSecSlamLate = 0.12;
+
+			// The cursor stays on the laser while it is moved in the wrong direction for this duration
+			constexpr double kWindowSecDirectionLenience = 0.1;
+		}
 	}
 
+	// Ticks of long notes and lasers are halved at or above this BPM
+	constexpr double kHalveComboBPMThreshold = 256.0;
+
 	constexpr int32 kScoreValueNear = 1;
 	constexpr int32 kScoreValueCritical = 2;
 }
@@ -0,0 +1,158 @@
+﻿#include "judgment_main.hpp"
+#include "music_game/game_defines.hpp"
+
+namespace MusicGame::Judgment
+{
+	namespace
+	{
+		template <typename LaneJudgment, std::size_t N>
+		int32 SumScoreFactor(const std::array<LaneJudgment, N>& laneJudgements)
+		{
+			int32 sum = 0;
+			for (const auto& laneJudgment : laneJudgements)
+			{
+				sum += laneJudgment.scoreValue();
+			}
+			return sum;
+		}
+
+		template <typename LaneJudgment, std::size_t N>
+		int32 SumScoreFactorMax(const std::array<LaneJudgment, N>& laneJudgements)
+		{
+			int32 sum = 0;
+			for (const auto& laneJudgment : laneJudgements)
+			{
+				sum += laneJudgment.scoreValueMax();
+			}
+			return sum;
+		}
+
+		// FNV-1a
+		constexpr uint64 kDigestOffsetBasis = 14695981039346656037ULL;
+		constexpr uint64 kDigestPrime = 1099511628211ULL;
+
+		uint64 AddToDigest(uint64 digest, std::span<const JudgmentResult> results)
+		{
+			for (const JudgmentResult result : results)
+			{
+				digest ^= static_cast<uint64>(result);
+				digest *= kDigestPrime;
+			}
+			return digest;
+		}
+	}
+
+	JudgmentMain::JudgmentMain(const kson::ChartData& chartData, const TempoMap& tempoMap, double playSpeed)
+		: m_btLaneJudgments{
+			ButtonLaneJudgment(kBTButtons[0], chartData.note.bt[0], tempoMap, playSpeed),
+			ButtonLaneJudgment(kBTButtons[1], chartData.note.bt[1], tempoMap, playSpeed),
+			ButtonLaneJudgment(kBTButtons[2], chartData.note.bt[2], tempoMap, playSpeed),
+			ButtonLaneJudgment(kBTButtons[3], chartData.note.bt[3], tempoMap, playSpeed) }
+		, m_fxLaneJudgments{
+				ButtonLaneJudgment(kFXButtons[0], chartData.note.fx[0], tempoMap, playSpeed),
+				ButtonLaneJudgment(kFXButtons[1], chartData.note.fx[1], tempoMap, playSpeed) }
+		, m_laserLaneJudgments{
+				LaserLaneJudgment(chartData.note.laser[0], tempoMap, playSpeed),
+				LaserLaneJudgment(chartData.note.laser[1], tempoMap, playSpeed) }
+		, m_scoreFactorMax(SumScoreFactorMax(m_btLaneJudgments) + SumScoreFactorMax(m_fxLaneJudgments) + SumScoreFactorMax(m_laserLaneJudgments))
+	{
+	}
+
+	void JudgmentMain::collectLaserInputEvents(const JudgmentKeyEvents& keyEvents, const LaserKnobEvents& knobEvents)
+	{
+		for (std::size_t laneIdx = 0U; laneIdx < kson::kNumLaserLanesSZ; ++laneIdx)
+		{
+			auto& inputEvents = m_laserInputEvents[laneIdx];
+			inputEvents.clear();
+
+			// Merge the events of the left and right keys in chronological order
+			const std::size_t leftKeyIdx = laneIdx * 2U;
+			const std::size_t rightKeyIdx = leftKeyIdx + 1U;
+			const auto& leftKeyEvents = keyEvents[kNumButtonLanesSZ + leftKeyIdx];
+			const auto& rightKeyEvents = keyEvents[kNumButtonLanesSZ + rightKeyIdx];
+			std::size_t leftCursor = 0U;
+			std::size_t rightCursor = 0U;
+			while (leftCursor < leftKeyEvents.size() || rightCursor < rightKeyEvents.size())
+			{
+				const bool isLeft = rightCursor >= rightKeyEvents.size() || (leftCursor < leftKeyEvents.size() && leftKeyEvents[leftCursor].timeSec <= rightKeyEvents[rightCursor].timeSec);
+				const KeyEvent& keyEvent = isLeft ? leftKeyEvents[leftCursor++] : rightKeyEvents[rightCursor++];
+				m_laserKeyPressed[isLeft ? leftKeyIdx : rightKeyIdx] = keyEvent.isPressed;
+
+				// Note: The cursor stops while both keys are held
+				inputEvents.push_back({
+					.timeSec = keyEvent.timeSec,
+					.keyDirection = static_cast<int32>(m_laserKeyPressed[rightKeyIdx]) - static_cast<int32>(m_laserKeyPressed[leftKeyIdx]),
+				});
+			}
+
+			// Merge the knob movements (both are in chronological order)
+			const auto& laneKnobEvents = knobEvents[laneIdx];
+			if (!laneKnobEvents.empty())
+			{
+				const std::size_t numKeyInputEvents = inputEvents.size();
+				inputEvents.insert(inputEvents.end(), laneKnobEvents.begin(), laneKnobEvents.end());
+				std::inplace_merge(inputEvents.begin(), inputEvents.begin() + numKeyInputEvents, inputEvents.end(),
+					[](const LaserInputEvent& a, const LaserInputEvent& b) { return a.timeSec < b.timeSec; });
+			}
+		}
+	}
+
+	void JudgmentMain::update(const JudgmentKeyEvents& keyEvents, const LaserKnobEvents& knobEvents, kson::Pulse currentPulse, double currentTimeSec, GameStatus& gameStatusRef)
+	{
+		// BT lane judgments
+		for (std::size_t i = 0U; i < kson::kNumBTLanesSZ; ++i)
+		{
+			m_btLaneJudgments[i].update(keyEvents[i], currentPulse, currentTimeSec, gameStatusRef.btLaneStatus[i]);
+		}
+
+		// FX lane judgments
+		for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+		{
+			m_fxLaneJudgments[i].update(keyEvents[kson::kNumBTLanesSZ + i], currentPulse, currentTimeSec, gameStatusRef.fxLaneStatus[i]);
+		}
+
+		// Laser lane judgments
+		collectLaserInputEvents(keyEvents, knobEvents);
+		for (std::size_t i = 0U; i < kson::kNumLaserLanesSZ; ++i)
+		{
+			m_laserLaneJudgments[i].update(m_laserInputEvents[i], currentTimeSec, gameStatusRef.laserLaneStatus[i]);
+		}
+
+		gameStatusRef.score = score();
+	}
+
+	int32 JudgmentMain::score() const
+	{
+		if (m_scoreFactorMax == 0)
+		{
+			return 0;
+		}
+		return static_cast<int32>(static_cast<int64>(kScoreMax) * (SumScoreFactor(m_btLaneJudgments) + SumScoreFactor(m_fxLaneJudgments) + SumScoreFactor(m_laserLaneJudgments)) / m_scoreFactorMax);
+	}
+
+	Optional<JudgmentResult> JudgmentMain::fxChipNoteResult(std::size_t laneIdx, kson::Pulse y, double currentTimeSec) const
+	{
+		return m_fxLaneJudgments[laneIdx].chipNoteResult(y, currentTimeSec);
+	}
+
+	uint64 JudgmentMain::judgmentDigest() const
+	{
+		uint64 digest = kDigestOffsetBasis;
+		for (const auto& laneJudgment : m_btLaneJudgments)
+		{
+			digest = AddToDigest(digest, laneJudgment.noteTable().results);
+			digest = AddToDigest(digest, laneJudgment.noteTable().longTickResults);
+		}
+		for (const auto& laneJudgment : m_fxLaneJudgments)
+		{
+			digest = AddToDigest(digest, laneJudgment.noteTable().results);
+			digest = AddToDigest(digest, laneJudgment.noteTable().longTickResults);
+		}
+		for (const auto& laneJudgment : m_laserLaneJudgments)
+		{
+			digest = AddToDigest(digest, laneJudgment.noteTable().tickResults);
+			digest = AddToDigest(digest, laneJudgment.noteTable().slamResults);
+		}
+		return digest;
+	}
+}
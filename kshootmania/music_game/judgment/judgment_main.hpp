@@ -0,0 +1,52 @@
+﻿#pragma once
+#include "button_lane_judgment.hpp"
+#include "laser_lane_judgment.hpp"
+#include "music_game/game_status.hpp"
+#include "music_game/tempo_map.hpp"
+
+namespace MusicGame::Judgment
+{
+	// Number of button lanes (BT lanes followed by FX lanes)
+	constexpr std::size_t kNumButtonLanesSZ = kson::kNumBTLanesSZ + kson::kNumFXLanesSZ;
+
+	// Number of laser keys (the left and right keys of each laser lane, in the same order as kLaserButtons)
+	constexpr std::size_t kNumLaserKeysSZ = kson::kNumLaserLanesSZ * 2U;
+
+	// Number of keys judged (button lanes followed by laser keys)
+	constexpr std::size_t kNumJudgmentKeysSZ = kNumButtonLanesSZ + kNumLaserKeysSZ;
+
+	// Key events of each key in a tick (indexed in the same order as kNumJudgmentKeysSZ)
+	using JudgmentKeyEvents = std::array<Array<KeyEvent>, kNumJudgmentKeysSZ>;
+
+	// Movements of the analog knob of each laser lane in a tick
+	using LaserKnobEvents = std::array<Array<LaserInputEvent>, kson::kNumLaserLanesSZ>;
+
+	// Judgment of all lanes
+	// Note: This class does not depend on graphics or audio, so it is also used for re-simulating replays.
+	class JudgmentMain
+	{
+	private:
+		std::array<ButtonLaneJudgment, kson::kNumBTLanesSZ> m_btLaneJudgments;
+		std::array<ButtonLaneJudgment, kson::kNumFXLanesSZ> m_fxLaneJudgments;
+		std::array<LaserLaneJudgment, kson::kNumLaserLanesSZ> m_laserLaneJudgments;
+		const int32 m_scoreFactorMax;
+
+		std::array<bool, kNumLaserKeysSZ> m_laserKeyPressed = {};
+		std::array<Array<LaserInputEvent>, kson::kNumLaserLanesSZ> m_laserInputEvents;
+
+		void collectLaserInputEvents(const JudgmentKeyEvents& keyEvents, const LaserKnobEvents& knobEvents);
+
+	public:
+		JudgmentMain(const kson::ChartData& chartData, const TempoMap& tempoMap, double playSpeed);
+
+		void update(const JudgmentKeyEvents& keyEvents, const LaserKnobEvents& knobEvents, kson::Pulse currentPulse, double currentTimeSec, GameStatus& gameStatusRef);
+
+		int32 score() const;
+
+		// See ButtonLaneJudgment::chipNoteResult()
+		Optional<JudgmentResult> fxChipNoteResult(std::size_t laneIdx, kson::Pulse y, double currentTimeSec) const;
+
+		// Hash of the judgment results of all notes (for comparing re-simulated plays)
+		uint64 judgmentDigest() const;
+	};
+}
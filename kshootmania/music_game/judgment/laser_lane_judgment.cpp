@@ -0,0 +1,534 @@
+﻿#include "laser_lane_judgment.hpp"
+
+namespace MusicGame::Judgment
+{
+	namespace
+	{
+		// Speed of the cursor moved by the laser keys (lane widths per second)
+		constexpr double kKeyCursorSpeed = 3.0;
+
+		// The cursor catches the laser within this distance
+		constexpr double kCursorCatchDistance = 0.1;
+
+		// A knob movement keeps its direction for this duration (the knob reports only discrete deltas)
+		constexpr double kKnobDirectionHoldSec = 0.1;
+
+		// The judgment runs behind the current time by this delay, so that the input events delivered late are not reordered
+		constexpr double kInputDelaySec = 0.005;
+
+		enum class PointType
+		{
+			kSectionEnd,
+			kSectionStart,
+			kSlamWindowStart,
+			kSlam,
+			kTick,
+			kSlamWindowEnd,
+		};
+
+		int32 Sign(double value)
+		{
+			return (value > 0.0) - (value < 0.0);
+		}
+
+		// Whether the difference between the cursor and the laser changes its sign (or reaches zero)
+		bool Crosses(double prevDiff, double diff)
+		{
+			return (prevDiff < 0.0 && diff >= 0.0) || (prevDiff > 0.0 && diff <= 0.0);
+		}
+
+		LaserNoteTable CreateNoteTable(const kson::ByPulse<kson::LaserSection>& lane, const TempoMap& tempoMap, double timingWindowScale)
+		{
+			using namespace TimingWindow;
+
+			LaserNoteTable table;
+			table.sectionPointOffsets.reserve(lane.size() + 1U);
+
+			std::vector<kson::Pulse> tickCandidatePulses;
+			for (const auto& [y, laserSection] : lane)
+			{
+				if (laserSection.v.empty())
+				{
+					continue;
+				}
+
+				table.sectionPointOffsets.push_back(table.pointPulses.size());
+				bool hasSlam = false;
+				for (const auto& [ry, point] : laserSection.v)
+				{
+					table.pointPulses.push_back(y + ry);
+					table.pointValues.push_back(point.v);
+					table.pointFinalValues.push_back(point.vf);
+
+					if (point.v != point.vf)
+					{
+						table.slamPulses.push_back(y + ry);
+						table.slamValues.push_back(point.v);
+						table.slamFinalValues.push_back(point.vf);
+						table.slamDirections.push_back(point.v < point.vf ? 1 : -1);
+						hasSlam = true;
+					}
+				}
+
+				// Ticks are placed on the same grid as the long notes
+				// (determined by the BPM at the start of the section, and BPM changes during the section are ignored)
+				const bool halvesCombo = tempoMap.tempoAt(y) >= kHalveComboBPMThreshold;
+				const kson::RelPulse pulseInterval = halvesCombo ? (kson::kResolution4 / 8) : (kson::kResolution4 / 16);
+				const kson::Pulse endPulse = y + laserSection.v.rbegin()->first;
+				const std::size_t numCandidatesBefore = tickCandidatePulses.size();
+				for (kson::Pulse pulse = (y + pulseInterval - 1) / pulseInterval * pulseInterval; pulse < endPulse; pulse += pulseInterval)
+				{
+					tickCandidatePulses.push_back(pulse);
+				}
+
+				// Short sections without slams have a tick at the start so that they are judged at least once
+				if (tickCandidatePulses.size() == numCandidatesBefore && !hasSlam)
+				{
+					tickCandidatePulses.push_back(y);
+				}
+			}
+			table.sectionPointOffsets.push_back(table.pointPulses.size());
+
+			// Note: All arrays are sorted because the sections in a lane do not overlap, so each conversion is a single pass
+			table.pointSecs = tempoMap.convert(table.pointPulses);
+			table.slamSecs = tempoMap.convert(table.slamPulses);
+			const std::vector<double> tickCandidateSecs = tempoMap.convert(tickCandidatePulses);
+
+			table.slamWindowStartSecs.reserve(table.slamSecs.size());
+			table.slamWindowEndSecs.reserve(table.slamSecs.size());
+			for (const double slamSec : table.slamSecs)
+			{
+				table.slamWindowStartSecs.push_back(slamSec - LaserNote::kWindowSecSlamEarly * timingWindowScale);
+				table.slamWindowEndSecs.push_back(slamSec + LaserNote::kWindowSecSlamLate * timingWindowScale);
+			}
+
+			// Ticks within the windows of slams are omitted because the slams are judged instead
+			std::size_t slamIdx = 0U;
+			for (std::size_t i = 0U; i < tickCandidatePulses.size(); ++i)
+			{
+				const double sec = tickCandidateSecs[i];
+				while (slamIdx < table.slamSecs.size() && table.slamWindowEndSecs[slamIdx] < sec)
+				{
+					++slamIdx;
+				}
+				if (slamIdx < table.slamSecs.size() && table.slamWindowStartSecs[slamIdx] <= sec)
+				{
+					continue;
+				}
+				table.tickPulses.push_back(tickCandidatePulses[i]);
+				table.tickSecs.push_back(sec);
+			}
+
+			table.tickResults.assign(table.tickPulses.size(), JudgmentResult::kUnspecified);
+			table.slamResults.assign(table.slamSecs.size(), JudgmentResult::kUnspecified);
+
+			return table;
+		}
+
+		int32 ScoreValueMax(const LaserNoteTable& table)
+		{
+			return static_cast<int32>(table.tickPulses.size() + table.slamSecs.size()) * kScoreValueCritical;
+		}
+	}
+
+	std::pair<double, int32> LaserLaneJudgment::laserValueAt(double timeSec) const
+	{
+		assert(m_currentSectionIdx.has_value());
+
+		const std::size_t pointIdx = m_pointCursor;
+		if (pointIdx + 1U >= m_noteTable.sectionPointOffsets[*m_currentSectionIdx + 1U])
+		{
+			// After the last point of the section
+			return { m_noteTable.pointFinalValues[pointIdx], 0 };
+		}
+
+		// Note: The value is interpolated in seconds instead of pulses, so that no tempo lookup is needed per query
+		const double startSec = m_noteTable.pointSecs[pointIdx];
+		const double endSec = m_noteTable.pointSecs[pointIdx + 1U];
+		const double startValue = m_noteTable.pointFinalValues[pointIdx];
+		const double endValue = m_noteTable.pointValues[pointIdx + 1U];
+		const double rate = (endSec > startSec) ? Clamp((timeSec - startSec) / (endSec - startSec), 0.0, 1.0) : 1.0;
+		return { startValue + (endValue - startValue) * rate, Sign(endValue - startValue) };
+	}
+
+	int32 LaserLaneJudgment::inputDirection(double timeSec) const
+	{
+		if (m_keyDirection != 0)
+		{
+			return m_keyDirection;
+		}
+		if (timeSec - m_knobMovedTimeSec <= kKnobDirectionHoldSec * m_timingWindowScale)
+		{
+			return m_knobDirection;
+		}
+		return 0;
+	}
+
+	void LaserLaneJudgment::moveCursorLinearly(double timeSec)
+	{
+		const auto [laserX, laserDirection] = laserValueAt(timeSec);
+		if (m_isCursorOnLaser)
+		{
+			m_cursorX = laserX;
+		}
+		else
+		{
+			// Note: Both the cursor and the laser move linearly and the input direction is constant within a step,
+			//       so a crossing is detected at the end of the step regardless of where the step starts
+			const double prevDiff = m_cursorX - m_laserX;
+			const double keyCursorSpeed = kKeyCursorSpeed / m_timingWindowScale;
+			m_cursorX = Clamp(m_cursorX + m_keyDirection * keyCursorSpeed * (timeSec - m_judgedTimeSec), 0.0, 1.0);
+			if (Crosses(prevDiff, m_cursorX - laserX) && (laserDirection == 0 || inputDirection(timeSec) == laserDirection))
+			{
+				m_isCursorOnLaser = true;
+				m_cursorX = laserX;
+			}
+		}
+		m_laserX = laserX;
+		m_laserDirection = laserDirection;
+		m_judgedTimeSec = timeSec;
+	}
+
+	void LaserLaneJudgment::moveCursor(double timeSec)
+	{
+		// Step also at the time when the cursor reaches the edge of the lane and when the knob direction expires,
+		// so that the crossing is judged exactly at the same times regardless of how the time range is divided into ticks
+		double edgeSec = std::numeric_limits<double>::infinity();
+		if (!m_isCursorOnLaser && m_keyDirection != 0)
+		{
+			const double edgeX = (m_keyDirection > 0) ? 1.0 : 0.0;
+			edgeSec = m_judgedTimeSec + Abs(edgeX - m_cursorX) / (kKeyCursorSpeed / m_timingWindowScale);
+		}
+		const double knobDirectionEndSec = m_knobMovedTimeSec + kKnobDirectionHoldSec * m_timingWindowScale;
+		for (const double stepSec : { Min(edgeSec, knobDirectionEndSec), Max(edgeSec, knobDirectionEndSec) })
+		{
+			if (m_judgedTimeSec < stepSec && stepSec < timeSec)
+			{
+				moveCursorLinearly(stepSec);
+			}
+		}
+		moveCursorLinearly(timeSec);
+	}
+
+	void LaserLaneJudgment::advanceTo(double timeSec)
+	{
+		if (timeSec <= m_judgedTimeSec)
+		{
+			return;
+		}
+
+		if (!m_currentSectionIdx.has_value())
+		{
+			m_judgedTimeSec = timeSec;
+			return;
+		}
+
+		// Step at each point of the laser, so that the laser moves linearly in each step
+		const std::size_t pointEnd = m_noteTable.sectionPointOffsets[*m_currentSectionIdx + 1U];
+		while (m_pointCursor + 1U < pointEnd && m_noteTable.pointSecs[m_pointCursor + 1U] < timeSec)
+		{
+			moveCursor(m_noteTable.pointSecs[m_pointCursor + 1U]);
+			++m_pointCursor;
+
+			// The laser jumps at a slam (the cursor follows it only if it is on the laser)
+			m_laserX = m_noteTable.pointFinalValues[m_pointCursor];
+			if (m_isCursorOnLaser)
+			{
+				m_cursorX = m_laserX;
+			}
+		}
+		moveCursor(timeSec);
+	}
+
+	void LaserLaneJudgment::updateCursorOnLaser(double timeSec)
+	{
+		using namespace TimingWindow;
+
+		if (!m_currentSectionIdx.has_value())
+		{
+			return;
+		}
+
+		const int32 direction = inputDirection(timeSec);
+		const bool isDirectionMatched = m_laserDirection == 0 || direction == m_laserDirection;
+		if (m_isCursorOnLaser)
+		{
+			if (isDirectionMatched)
+			{
+				m_directionMismatchStartSec = none;
+			}
+			else if (!m_directionMismatchStartSec.has_value())
+			{
+				m_directionMismatchStartSec = timeSec;
+			}
+			else if (timeSec - *m_directionMismatchStartSec > LaserNote::kWindowSecDirectionLenience * m_timingWindowScale)
+			{
+				m_isCursorOnLaser = false;
+				m_directionMismatchStartSec = none;
+			}
+		}
+		else if (isDirectionMatched && Abs(m_cursorX - m_laserX) < kCursorCatchDistance)
+		{
+			m_isCursorOnLaser = true;
+			m_cursorX = m_laserX;
+		}
+	}
+
+	void LaserLaneJudgment::processInputEvent(const LaserInputEvent& inputEvent)
+	{
+		// Note: An event delivered later than the input delay is judged at the judged time
+		const double timeSec = Max(inputEvent.timeSec, m_judgedTimeSec);
+		advanceTo(timeSec);
+
+		if (inputEvent.keyDirection.has_value())
+		{
+			m_keyDirection = *inputEvent.keyDirection;
+		}
+
+		if (inputEvent.knobDelta != 0.0)
+		{
+			m_knobDirection = Sign(inputEvent.knobDelta);
+			m_knobMovedTimeSec = timeSec;
+
+			if (m_currentSectionIdx.has_value() && !m_isCursorOnLaser)
+			{
+				const double prevDiff = m_cursorX - m_laserX;
+				m_cursorX = Clamp(m_cursorX + inputEvent.knobDelta, 0.0, 1.0);
+				if (Crosses(prevDiff, m_cursorX - m_laserX) && (m_laserDirection == 0 || m_knobDirection == m_laserDirection))
+				{
+					m_isCursorOnLaser = true;
+					m_cursorX = m_laserX;
+				}
+			}
+		}
+
+		updateCursorOnLaser(timeSec);
+		judgePendingSlam(timeSec);
+	}
+
+	void LaserLaneJudgment::judgePendingSlam(double timeSec)
+	{
+		while (m_slamCursor < m_noteTable.slamSecs.size() && m_isSlamWindowOpened && inputDirection(timeSec) == m_noteTable.slamDirections[m_slamCursor])
+		{
+			m_noteTable.slamResults[m_slamCursor] = JudgmentResult::kCritical;
+			m_scoreValue += kScoreValueCritical;
+
+			// The cursor is moved onto the laser by the slam
+			if (m_currentSectionIdx.has_value())
+			{
+				m_isCursorOnLaser = true;
+				m_cursorX = m_laserX;
+				m_directionMismatchStartSec = none;
+			}
+
+			moveToNextSlam(timeSec);
+		}
+	}
+
+	void LaserLaneJudgment::startSection(double timeSec)
+	{
+		advanceTo(timeSec);
+
+		const std::size_t sectionIdx = m_sectionCursor;
+		++m_sectionCursor;
+		m_currentSectionIdx = sectionIdx;
+		m_pointCursor = m_noteTable.sectionPointOffsets[sectionIdx];
+
+		// The cursor appears on the laser
+		m_cursorX = m_noteTable.pointValues[m_pointCursor];
+		m_laserX = m_cursorX;
+		m_laserDirection = laserValueAt(timeSec).second;
+		m_isCursorOnLaser = true;
+		m_directionMismatchStartSec = none;
+
+		updateCursorOnLaser(timeSec);
+	}
+
+	void LaserLaneJudgment::endSection(double timeSec)
+	{
+		advanceTo(timeSec);
+
+		m_currentSectionIdx = none;
+		m_isCursorOnLaser = false;
+	}
+
+	void LaserLaneJudgment::judgeTick(double timeSec)
+	{
+		advanceTo(timeSec);
+		updateCursorOnLaser(timeSec);
+
+		const bool isCritical = m_currentSectionIdx.has_value() && m_isCursorOnLaser;
+		m_noteTable.tickResults[m_tickCursor] = isCritical ? JudgmentResult::kCritical : JudgmentResult::kError;
+		if (isCritical)
+		{
+			m_scoreValue += kScoreValueCritical;
+		}
+		++m_tickCursor;
+	}
+
+	void LaserLaneJudgment::processSlamWindowStart(double timeSec)
+	{
+		advanceTo(timeSec);
+		updateCursorOnLaser(timeSec);
+
+		m_isSlamWindowOpened = true;
+		judgePendingSlam(timeSec);
+	}
+
+	void LaserLaneJudgment::processSlam(double timeSec)
+	{
+		advanceTo(timeSec);
+
+		// The cursor does not follow the slam until it is judged
+		m_isSlamPassed = true;
+		if (m_currentSectionIdx.has_value())
+		{
+			m_cursorX = m_noteTable.slamValues[m_slamCursor];
+			m_laserX = m_noteTable.slamFinalValues[m_slamCursor];
+			m_isCursorOnLaser = false;
+			m_directionMismatchStartSec = none;
+		}
+	}
+
+	void LaserLaneJudgment::processSlamWindowEnd(double timeSec)
+	{
+		advanceTo(timeSec);
+		updateCursorOnLaser(timeSec);
+
+		m_noteTable.slamResults[m_slamCursor] = JudgmentResult::kError;
+		moveToNextSlam(timeSec);
+	}
+
+	void LaserLaneJudgment::moveToNextSlam(double timeSec)
+	{
+		++m_slamCursor;
+
+		// Note: The windows of consecutive slams may overlap
+		m_isSlamWindowOpened = m_slamCursor < m_noteTable.slamSecs.size() && m_noteTable.slamWindowStartSecs[m_slamCursor] <= timeSec;
+		m_isSlamPassed = m_slamCursor < m_noteTable.slamSecs.size() && m_noteTable.slamSecs[m_slamCursor] <= timeSec;
+	}
+
+	LaserLaneJudgment::LaserLaneJudgment(const kson::ByPulse<kson::LaserSection>& lane, const TempoMap& tempoMap, double playSpeed)
+		: m_timingWindowScale(playSpeed)
+		, m_noteTable(CreateNoteTable(lane, tempoMap, playSpeed))
+		, m_scoreValueMax(ScoreValueMax(m_noteTable))
+	{
+	}
+
+	void LaserLaneJudgment::update(std::span<const LaserInputEvent> inputEvents, double currentTimeSec, LaserLaneStatus& laneStatusRef)
+	{
+		m_pendingInputEvents.insert(m_pendingInputEvents.end(), inputEvents.begin(), inputEvents.end());
+
+		const double judgeUntilSec = currentTimeSec - kInputDelaySec * m_timingWindowScale;
+		std::size_t inputEventIdx = 0U;
+		while (true)
+		{
+			// Find the earliest point to be judged (points at the same time are processed in the order of PointType)
+			double pointSec = std::numeric_limits<double>::infinity();
+			PointType pointType = PointType::kSectionEnd;
+			const auto consider = [&pointSec, &pointType](double sec, PointType type)
+			{
+				if (sec < pointSec)
+				{
+					pointSec = sec;
+					pointType = type;
+				}
+			};
+			if (m_currentSectionIdx.has_value())
+			{
+				consider(m_noteTable.pointSecs[m_noteTable.sectionPointOffsets[*m_currentSectionIdx + 1U] - 1U], PointType::kSectionEnd);
+			}
+			else if (m_sectionCursor < m_noteTable.numSections())
+			{
+				consider(m_noteTable.pointSecs[m_noteTable.sectionPointOffsets[m_sectionCursor]], PointType::kSectionStart);
+			}
+			if (m_slamCursor < m_noteTable.slamSecs.size())
+			{
+				if (!m_isSlamWindowOpened)
+				{
+					consider(m_noteTable.slamWindowStartSecs[m_slamCursor], PointType::kSlamWindowStart);
+				}
+				if (!m_isSlamPassed)
+				{
+					consider(m_noteTable.slamSecs[m_slamCursor], PointType::kSlam);
+				}
+			}
+			if (m_tickCursor < m_noteTable.tickSecs.size())
+			{
+				consider(m_noteTable.tickSecs[m_tickCursor], PointType::kTick);
+			}
+			if (m_slamCursor < m_noteTable.slamSecs.size())
+			{
+				consider(m_noteTable.slamWindowEndSecs[m_slamCursor], PointType::kSlamWindowEnd);
+			}
+
+			// Input events at the same time as a point are processed first
+			if (inputEventIdx < m_pendingInputEvents.size() && m_pendingInputEvents[inputEventIdx].timeSec <= pointSec)
+			{
+				const LaserInputEvent& inputEvent = m_pendingInputEvents[inputEventIdx];
+				if (inputEvent.timeSec > judgeUntilSec)
+				{
+					break;
+				}
+				processInputEvent(inputEvent);
+				++inputEventIdx;
+				continue;
+			}
+
+			if (pointSec > judgeUntilSec)
+			{
+				break;
+			}
+
+			switch (pointType)
+			{
+			case PointType::kSectionEnd:
+				endSection(pointSec);
+				break;
+
+			case PointType::kSectionStart:
+				startSection(pointSec);
+				break;
+
+			case PointType::kSlamWindowStart:
+				processSlamWindowStart(pointSec);
+				break;
+
+			case PointType::kSlam:
+				processSlam(pointSec);
+				break;
+
+			case PointType::kTick:
+				judgeTick(pointSec);
+				break;
+
+			case PointType::kSlamWindowEnd:
+				processSlamWindowEnd(pointSec);
+				break;
+			}
+		}
+
+		// Note: Only the events within the input delay remain, so the array does not grow while the cursor is held on a laser
+		m_pendingInputEvents.erase(m_pendingInputEvents.begin(), m_pendingInputEvents.begin() + inputEventIdx);
+
+		// Move the cursor up to the judged time for graphics
+		advanceTo(judgeUntilSec);
+		laneStatusRef.cursorX = m_currentSectionIdx.has_value() ? MakeOptional(m_cursorX) : none;
+		laneStatusRef.isCursorOnLaser = m_currentSectionIdx.has_value() && m_isCursorOnLaser;
+	}
+
+	const LaserNoteTable& LaserLaneJudgment::noteTable() const
+	{
+		return m_noteTable;
+	}
+
+	int32 LaserLaneJudgment::scoreValue() const
+	{
+		return m_scoreValue;
+	}
+
+	int32 LaserLaneJudgment::scoreValueMax() const
+	{
+		return m_scoreValueMax;
+	}
+}
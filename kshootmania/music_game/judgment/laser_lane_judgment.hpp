@@ -0,0 +1,151 @@
+﻿#pragma once
+#include "music_game/game_defines.hpp"
+#include "music_game/game_status.hpp"
+#include "kson/chart_data.hpp"
+#include "music_game/tempo_map.hpp"
+
+namespace MusicGame::Judgment
+{
+	// Input to the laser cursor of a lane, mapped onto the chart time
+	struct LaserInputEvent
+	{
+		double timeSec = 0.0;
+
+		// Direction of the laser keys held after this event (-1: left, 0: none or both, 1: right)
+		// (none if this event does not come from the keys)
+		Optional<int32> keyDirection = none;
+
+		// Movement of the cursor by an analog knob (1.0 is the width of the lane)
+		double knobDelta = 0.0;
+	};
+
+	// Laser notes of the lane in structure-of-arrays layout (indexed in pulse order)
+	struct LaserNoteTable
+	{
+		// Points of all sections (the points of the i-th section are in [sectionPointOffsets[i], sectionPointOffsets[i + 1]))
+		std::vector<kson::Pulse> pointPulses;
+		std::vector<double> pointSecs;
+		std::vector<double> pointValues; // Value before the slam (kson::GraphValue::v)
+		std::vector<double> pointFinalValues; // Value after the slam (kson::GraphValue::vf)
+
+		std::vector<std::size_t> sectionPointOffsets;
+
+		// Ticks judged by whether the cursor is on the laser
+		std::vector<kson::Pulse> tickPulses;
+		std::vector<double> tickSecs;
+		std::vector<JudgmentResult> tickResults;
+
+		// Slams judged by whether the cursor is moved toward the slam direction within the window
+		std::vector<kson::Pulse> slamPulses;
+		std::vector<double> slamSecs;
+		std::vector<double> slamWindowStartSecs;
+		std::vector<double> slamWindowEndSecs;
+		std::vector<double> slamValues;
+		std::vector<double> slamFinalValues;
+		std::vector<int32> slamDirections;
+		std::vector<JudgmentResult> slamResults;
+
+		std::size_t numSections() const
+		{
+			return sectionPointOffsets.size() - 1U;
+		}
+	};
+
+	class LaserLaneJudgment
+	{
+	private:
+		// Play speed (timing windows and the cursor speed are defined in real time, so they are scaled into the chart time)
+		const double m_timingWindowScale;
+
+		LaserNoteTable m_noteTable;
+
+		// Input events not judged yet (they are judged with a small delay, so that late events are not reordered)
+		Array<LaserInputEvent> m_pendingInputEvents;
+
+		// Time up to which the lane has been judged
+		double m_judgedTimeSec = kPastTimeSec;
+
+		// Index of the next section to start
+		std::size_t m_sectionCursor = 0U;
+
+		// Index of the section being judged
+		Optional<std::size_t> m_currentSectionIdx = none;
+
+		// Index of the point starting the segment of the laser at the judged time (moves forward only)
+		std::size_t m_pointCursor = 0U;
+
+		// Index of the next tick to be judged
+		std::size_t m_tickCursor = 0U;
+
+		// Index of the first slam not judged yet
+		std::size_t m_slamCursor = 0U;
+		bool m_isSlamWindowOpened = false;
+		bool m_isSlamPassed = false;
+
+		double m_cursorX = 0.0;
+
+		// Whether the cursor is following the laser
+		bool m_isCursorOnLaser = false;
+
+		// Laser value and direction at the judged time
+		double m_laserX = 0.0;
+		int32 m_laserDirection = 0;
+
+		// Time when the cursor started to be moved in the direction opposite to the laser
+		Optional<double> m_directionMismatchStartSec = none;
+
+		int32 m_keyDirection = 0;
+		int32 m_knobDirection = 0;
+		double m_knobMovedTimeSec = kPastTimeSec;
+
+		int32 m_scoreValue = 0;
+
+		const int32 m_scoreValueMax;
+
+		// Laser value and direction at the time in the segment of the point cursor
+		std::pair<double, int32> laserValueAt(double timeSec) const;
+
+		int32 inputDirection(double timeSec) const;
+
+		// Moves the cursor to the time within the segment of the point cursor in a single linear step
+		void moveCursorLinearly(double timeSec);
+
+		// Moves the cursor to the time within the segment of the point cursor
+		void moveCursor(double timeSec);
+
+		void advanceTo(double timeSec);
+
+		void updateCursorOnLaser(double timeSec);
+
+		void processInputEvent(const LaserInputEvent& inputEvent);
+
+		void judgePendingSlam(double timeSec);
+
+		void startSection(double timeSec);
+
+		void endSection(double timeSec);
+
+		void judgeTick(double timeSec);
+
+		void processSlamWindowStart(double timeSec);
+
+		void processSlam(double timeSec);
+
+		void processSlamWindowEnd(double timeSec);
+
+		void moveToNextSlam(double timeSec);
+
+	public:
+		LaserLaneJudgment(const kson::ByPulse<kson::LaserSection>& lane, const TempoMap& tempoMap, double playSpeed = 1.0);
+
+		// Note: The judgment runs slightly behind the current time so that the input events captured on another thread
+		//       are always judged in chronological order, which makes the result independent of the tick rate
+		void update(std::span<const LaserInputEvent> inputEvents, double currentTimeSec, LaserLaneStatus& laneStatusRef);
+
+		const LaserNoteTable& noteTable() const;
+
+		int32 scoreValue() const;
+
+		int32 scoreValueMax() const;
+	};
+}
@@ -0,0 +1,133 @@
+﻿#include "replay_data.hpp"
+
+namespace MusicGame::Replay
+{
+	namespace
+	{
+		constexpr std::array<char, 4> kMagic = { 'K', 'S', 'M', 'R' };
+		constexpr uint32 kFormatVersion = 1U;
+
+		// Note: Lane index and press/release are packed into one byte, so that an event is stored in 9 bytes
+		uint8 PackLaneIdxAndPressed(const ReplayEvent& event)
+		{
+			return static_cast<uint8>((event.laneIdx << 1) | (event.isPressed ? 1 : 0));
+		}
+	}
+
+	bool SaveReplayFile(FilePathView filePath, const ReplayData& replayData)
+	{
+		BinaryWriter writer(filePath);
+		if (!writer)
+		{
+			return false;
+		}
+
+		const std::string chartFilePath = replayData.chartFilePath.toUTF8();
+		writer.write(kMagic);
+		writer.write(kFormatVersion);
+		writer.write(static_cast<uint32>(chartFilePath.size()));
+		writer.write(chartFilePath.data(), static_cast<int64>(chartFilePath.size()));
+		writer.write(replayData.chartMD5.value);
+		writer.write(replayData.playSpeed);
+		writer.write(replayData.score);
+		writer.write(replayData.judgmentDigest);
+		writer.write(replayData.playEndSec);
+		writer.write(static_cast<uint64>(replayData.events.size()));
+		for (const auto& event : replayData.events)
+		{
+			writer.write(PackLaneIdxAndPressed(event));
+			writer.write(event.timeSec);
+		}
+		writer.write(static_cast<uint64>(replayData.knobEvents.size()));
+		for (const auto& event : replayData.knobEvents)
+		{
+			writer.write(event.laneIdx);
+			writer.write(event.delta);
+			writer.write(event.timeSec);
+		}
+		return true;
+	}
+
+	Optional<ReplayData> LoadReplayFile(FilePathView filePath)
+	{
+		BinaryReader reader(filePath);
+		if (!reader)
+		{
+			return none;
+		}
+
+		std::array<char, 4> magic;
+		uint32 version;
+		if (!reader.read(magic) || magic != kMagic || !reader.read(version) || version != kFormatVersion)
+		{
+			return none;
+		}
+
+		ReplayData replayData;
+		uint32 chartFilePathSize;
+		if (!reader.read(chartFilePathSize))
+		{
+			return none;
+		}
+		std::string chartFilePath(chartFilePathSize, '\0');
+		if (reader.read(chartFilePath.data(), static_cast<int64>(chartFilePathSize)) != static_cast<int64>(chartFilePathSize))
+		{
+			return none;
+		}
+		replayData.chartFilePath = Unicode::FromUTF8(chartFilePath);
+
+		uint64 numEvents;
+		if (!reader.read(replayData.chartMD5.value)
+			|| !reader.read(replayData.playSpeed)
+			|| !reader.read(replayData.score)
+			|| !reader.read(replayData.judgmentDigest)
+			|| !reader.read(replayData.playEndSec)
+			|| !reader.read(numEvents))
+		{
+			return none;
+		}
+
+		constexpr int64 kEventBytes = sizeof(uint8) + sizeof(double);
+		if (numEvents > static_cast<uint64>(reader.size() / kEventBytes))
+		{
+			return none;
+		}
+
+		replayData.events.reserve(static_cast<std::size_t>(numEvents));
+		for (uint64 i = 0U; i < numEvents; ++i)
+		{
+			uint8 packed;
+			double timeSec;
+			if (!reader.read(packed) || !reader.read(timeSec))
+			{
+				return none;
+			}
+			replayData.events.push_back({ .laneIdx = static_cast<uint8>(packed >> 1), .isPressed = (packed & 1U) != 0U, .timeSec = timeSec });
+		}
+
+		uint64 numKnobEvents;
+		if (!reader.read(numKnobEvents))
+		{
+			return none;
+		}
+
+		constexpr int64 kKnobEventBytes = sizeof(uint8) + sizeof(double) * 2;
+		if (numKnobEvents > static_cast<uint64>(reader.size() / kKnobEventBytes))
+		{
+			return none;
+		}
+
+		replayData.knobEvents.reserve(static_cast<std::size_t>(numKnobEvents));
+		for (uint64 i = 0U; i < numKnobEvents; ++i)
+		{
+			ReplayKnobEvent event;
+			if (!reader.read(event.laneIdx) || !reader.read(event.delta) || !reader.read(event.timeSec))
+			{
+				return none;
+			}
+			replayData.knobEvents.push_back(event);
+		}
+
+		return replayData;
+	}
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+namespace MusicGame::Replay
+{
+	struct ReplayEvent
+	{
+		// Index of the key (BT lanes, FX lanes and laser keys in the order of Judgment::kNumJudgmentKeysSZ)
+		uint8 laneIdx = 0;
+
+		bool isPressed = false;
+
+		// Time on the chart (the audio clock)
+		double timeSec = 0.0;
+	};
+
+	struct ReplayKnobEvent
+	{
+		// Index of the laser lane
+		uint8 laneIdx = 0;
+
+		// Movement of the cursor after filtering (1.0 is the width of the lane)
+		double delta = 0.0;
+
+		// Time on the chart (the audio clock)
+		double timeSec = 0.0;
+	};
+
+	struct ReplayData
+	{
+		FilePath chartFilePath;
+
+		// Used to detect that the chart has been modified after recording
+		MD5Value chartMD5;
+
+		double playSpeed = 1.0;
+
+		// In chronological order
+		Array<ReplayEvent> events;
+		Array<ReplayKnobEvent> knobEvents;
+
+		// Result of the recorded play (for verifying re-simulation)
+		int32 score = 0;
+		uint64 judgmentDigest = 0U;
+
+		// Time on the chart of the last tick of the recorded play
+		double playEndSec = 0.0;
+	};
+
+	bool SaveReplayFile(FilePathView filePath, const ReplayData& replayData);
+
+	Optional<ReplayData> LoadReplayFile(FilePathView filePath);
+}
@@ -0,0 +1,200 @@
+﻿#include "replay_simulator.hpp"
+#include "music_game/game_defines.hpp"
+#include "music_game/frame_timing.hpp"
+#include "music_game/judgment/judgment_main.hpp"
+#include "music_game/audio/bgm.hpp"
+#include "music_game/audio/audio_effect_main.hpp"
+#include "music_game/audio/se_scheduler.hpp"
+#include "kson/io/ksh_io.hpp"
+
+namespace MusicGame::Replay
+{
+	namespace
+	{
+		// Duration rendered at once when measuring the DSP load
+		constexpr double kDSPRenderIntervalSec = 0.01;
+
+		// Tick rate of the second simulation to check the tick rate independence of the judgment
+		// (not a divisor of kSimulationTickRateHz, so that the ticks of both simulations do not line up)
+		constexpr double kTickRateCheckHz = 240.0;
+	}
+
+	ReplaySimulationResult SimulateReplay(const kson::ChartData& chartData, const ReplayData& replayData, bool measureDSPLoad, double tickRateHz)
+	{
+		const kson::TimingCache timingCache = kson::CreateTimingCache(chartData.beat);
+		const TempoMap tempoMap(chartData.beat, timingCache);
+		TempoMap::Cursor tempoMapCursor(tempoMap);
+
+		Judgment::JudgmentMain judgmentMain(chartData, tempoMap, replayData.playSpeed);
+		GameStatus gameStatus;
+		Judgment::JudgmentKeyEvents keyEvents;
+		Judgment::LaserKnobEvents knobEvents;
+
+		// Audio effects driven by the re-simulated input (only if the DSP load is measured)
+		std::unique_ptr<Audio::BGM> bgm;
+		std::unique_ptr<Audio::AudioEffectMain> audioEffectMain;
+		std::unique_ptr<FrameTimingCalculator> frameTimingCalculator;
+		if (measureDSPLoad)
+		{
+			const FilePath bgmFilePath = FileSystem::ParentPath(replayData.chartFilePath) + U"/" + Unicode::FromUTF8(chartData.audio.bgm.filename);
+			bgm = std::make_unique<Audio::BGM>(bgmFilePath, false, replayData.playSpeed, true);
+			audioEffectMain = std::make_unique<Audio::AudioEffectMain>(chartData);
+			frameTimingCalculator = std::make_unique<FrameTimingCalculator>(tempoMap);
+
+			// Note: The stream is needed for registering audio effects
+			while (!bgm->isStreamReady())
+			{
+				bgm->update();
+				System::Sleep(1ms);
+			}
+		}
+
+		const auto& events = replayData.events;
+		const auto& replayKnobEvents = replayData.knobEvents;
+		const double tickSec = replayData.playSpeed / tickRateHz;
+		const int64 dspRenderIntervalTicks = Max(static_cast<int64>(Math::Round(kDSPRenderIntervalSec * tickRateHz)), int64{ 1 });
+		const double startSec = Min({ events.empty() ? 0.0 : events.front().timeSec, replayKnobEvents.empty() ? 0.0 : replayKnobEvents.front().timeSec, 0.0 });
+
+		// Note: The simulation stops at the same time as the recorded play, so that aborted plays are also reproduced
+		const double endSec = replayData.playEndSec;
+
+		std::size_t eventIdx = 0U;
+		std::size_t knobEventIdx = 0U;
+		int64 tickIdx = 0;
+		while (true)
+		{
+			// Note: The last tick is clamped to the end time, so that the notes are judged up to exactly the same time as the recorded play
+			const double currentTimeSec = Min(startSec + static_cast<double>(tickIdx) * tickSec, endSec);
+
+			for (auto& laneKeyEvents : keyEvents)
+			{
+				laneKeyEvents.clear();
+			}
+			while (eventIdx < events.size() && events[eventIdx].timeSec <= currentTimeSec)
+			{
+				const ReplayEvent& event = events[eventIdx];
+				if (event.laneIdx < Judgment::kNumJudgmentKeysSZ)
+				{
+					keyEvents[event.laneIdx].push_back({
+						.isPressed = event.isPressed,
+						.timeSec = event.timeSec,
+						.pulse = tempoMap.secToPulse(event.timeSec),
+					});
+				}
+				++eventIdx;
+			}
+
+			for (auto& laneKnobEvents : knobEvents)
+			{
+				laneKnobEvents.clear();
+			}
+			while (knobEventIdx < replayKnobEvents.size() && replayKnobEvents[knobEventIdx].timeSec <= currentTimeSec)
+			{
+				const ReplayKnobEvent& event = replayKnobEvents[knobEventIdx];
+				if (event.laneIdx < kson::kNumLaserLanesSZ)
+				{
+					knobEvents[event.laneIdx].push_back({
+						.timeSec = event.timeSec,
+						.knobDelta = event.delta,
+					});
+				}
+				++knobEventIdx;
+			}
+
+			judgmentMain.update(keyEvents, knobEvents, tempoMapCursor.secToPulse(currentTimeSec), currentTimeSec, gameStatus);
+
+			if (measureDSPLoad)
+			{
+				const FrameTiming frameTiming = frameTimingCalculator->calculate(currentTimeSec, 0.0, Audio::SEScheduler::kLookaheadSec);
+				std::array<Optional<bool>, kson::kNumFXLanesSZ> longFXPressed;
+				for (std::size_t i = 0U; i < kson::kNumFXLanesSZ; ++i)
+				{
+					longFXPressed[i] = gameStatus.fxLaneStatus[i].longNotePressed;
+				}
+				audioEffectMain->update(*bgm, chartData, timingCache, tempoMap, frameTiming, {
+					.longFXPressed = longFXPressed,
+				});
+
+				if (currentTimeSec >= 0.0 && tickIdx % dspRenderIntervalTicks == 0)
+				{
+					// Note: The rendered duration is in the output time, so it does not depend on the play speed
+					bgm->decodeHeadless(static_cast<double>(dspRenderIntervalTicks) / tickRateHz);
+				}
+			}
+
+			++tickIdx;
+
+			if (currentTimeSec >= endSec)
+			{
+				break;
+			}
+		}
+
+		return {
+			.score = judgmentMain.score(),
+			.judgmentDigest = judgmentMain.judgmentDigest(),
+			.numTicks = tickIdx,
+			.dspLoadReportLines = measureDSPLoad ? bgm->dspLoadReportLines() : Array<String>{},
+		};
+	}
+
+	bool RunReplaySimulations(const Array<FilePath>& replayFilePaths, bool measureDSPLoad)
+	{
+		// Note: Charts are cached so that many replays of the same chart can be simulated quickly
+		HashTable<FilePath, kson::ChartData> chartDataCache;
+
+		bool isAllMatched = true;
+		int64 totalTicks = 0;
+		Stopwatch totalStopwatch(StartImmediately::Yes);
+		for (const auto& replayFilePath : replayFilePaths)
+		{
+			const Optional<ReplayData> replayData = LoadReplayFile(replayFilePath);
+			if (!replayData.has_value())
+			{
+				Console << U"[Replay] {}: could not load the replay file"_fmt(replayFilePath);
+				isAllMatched = false;
+				continue;
+			}
+
+			if (MD5::FromFile(replayData->chartFilePath) != replayData->chartMD5)
+			{
+				Console << U"[Replay] {}: the chart has been modified or not found ({})"_fmt(replayFilePath, replayData->chartFilePath);
+				isAllMatched = false;
+				continue;
+			}
+
+			if (!chartDataCache.contains(replayData->chartFilePath))
+			{
+				chartDataCache.emplace(replayData->chartFilePath, kson::LoadKSHChartData(replayData->chartFilePath.narrow()));
+			}
+
+			Stopwatch stopwatch(StartImmediately::Yes);
+			const kson::ChartData& chartData = chartDataCache.at(replayData->chartFilePath);
+			const ReplaySimulationResult result = SimulateReplay(chartData, *replayData, measureDSPLoad);
+			const bool isMatched = result.score == replayData->score && result.judgmentDigest == replayData->judgmentDigest;
+			const double elapsedMs = stopwatch.msF();
+
+			// The same input log must give the same judgment at another tick rate
+			const ReplaySimulationResult tickRateCheckResult = SimulateReplay(chartData, *replayData, false, kTickRateCheckHz);
+			const bool isTickRateMatched = tickRateCheckResult.score == result.score && tickRateCheckResult.judgmentDigest == result.judgmentDigest;
+
+			isAllMatched = isAllMatched && isMatched && isTickRateMatched;
+			totalTicks += result.numTicks;
+
+			Console << U"[Replay] {}: {} score:{} (recorded:{}) ticks:{} time:{:.1f}ms"_fmt(
+				replayFilePath, isMatched ? U"OK" : U"MISMATCH", result.score, replayData->score, result.numTicks, elapsedMs);
+			Console << U"    tick rate check ({}Hz): {} score:{} digest:{:016X} (at {}Hz: {:016X})"_fmt(
+				kTickRateCheckHz, isTickRateMatched ? U"OK" : U"MISMATCH", tickRateCheckResult.score, tickRateCheckResult.judgmentDigest, kSimulationTickRateHz, result.judgmentDigest);
+			for (const auto& line : result.dspLoadReportLines)
+			{
+				Console << U"    " << line;
+			}
+		}
+
+		const double totalSec = totalStopwatch.sF();
+		Console << U"[Replay] {} replays, {} ticks in {:.2f}s ({:.0f} ticks/s)"_fmt(
+			replayFilePaths.size(), totalTicks, totalSec, totalSec > 0.0 ? totalTicks / totalSec : 0.0);
+
+		return isAllMatched;
+	}
+}
@@ -0,0 +1,28 @@
+﻿#pragma once
+#include "replay_data.hpp"
+#include "music_game/game_defines.hpp"
+#include "kson/chart_data.hpp"
+
+namespace MusicGame::Replay
+{
+	struct ReplaySimulationResult
+	{
+		int32 score = 0;
+		uint64 judgmentDigest = 0U;
+
+		int64 numTicks = 0;
+
+		// Empty if the DSP load is not measured
+		Array<String> dspLoadReportLines;
+	};
+
+	// Re-simulates the judgment of a replay without graphics or audio
+	// Note: The ticks are processed at tickRateHz (the same rate as the game by default) but without waiting.
+	// Note: If measureDSPLoad is true, the BGM is also rendered through the audio effects without an output device
+	//       (ksmaudio::InitHeadless() must be called beforehand).
+	ReplaySimulationResult SimulateReplay(const kson::ChartData& chartData, const ReplayData& replayData, bool measureDSPLoad = false, double tickRateHz = kSimulationTickRateHz);
+
+	// Re-simulates the replay files and prints the results to the console (returns false if any of them does not match the record)
+	// Note: Each replay is also simulated at another tick rate to check that the judgment does not depend on the tick rate.
+	bool RunReplaySimulations(const Array<FilePath>& replayFilePaths, bool measureDSPLoad = false);
+}
@@ -0,0 +1,144 @@
+﻿#include "tempo_map.hpp"
+
+namespace MusicGame
+{
+	TempoMap::Cursor::Cursor(const TempoMap& tempoMap)
+		: m_pTempoMap(&tempoMap)
+	{
+	}
+
+	kson::Pulse TempoMap::Cursor::secToPulse(double sec)
+	{
+		const auto& secs = m_pTempoMap->m_segmentSecs;
+		while (m_segmentIdx + 1U < secs.size() && sec >= secs[m_segmentIdx + 1U])
+		{
+			++m_segmentIdx;
+		}
+		while (m_segmentIdx > 0U && sec < secs[m_segmentIdx]) [[unlikely]]
+		{
+			--m_segmentIdx;
+		}
+		return m_pTempoMap->secToPulseInSegment(m_segmentIdx, sec);
+	}
+
+	double TempoMap::Cursor::pulseToSec(kson::Pulse pulse)
+	{
+		const auto& pulses = m_pTempoMap->m_segmentPulses;
+		while (m_segmentIdx + 1U < pulses.size() && pulse >= pulses[m_segmentIdx + 1U])
+		{
+			++m_segmentIdx;
+		}
+		while (m_segmentIdx > 0U && pulse < pulses[m_segmentIdx]) [[unlikely]]
+		{
+			--m_segmentIdx;
+		}
+		return m_pTempoMap->pulseToSecInSegment(m_segmentIdx, pulse);
+	}
+
+	double TempoMap::Cursor::currentTempo() const
+	{
+		return m_pTempoMap->m_segmentBPMs[m_segmentIdx];
+	}
+
+	std::size_t TempoMap::segmentIdxAtPulse(kson::Pulse pulse) const
+	{
+		// Note: Pulses before the first segment belong to the first segment (same as kson)
+		const auto itr = std::upper_bound(m_segmentPulses.begin(), m_segmentPulses.end(), pulse);
+		return itr == m_segmentPulses.begin() ? 0U : static_cast<std::size_t>(itr - m_segmentPulses.begin()) - 1U;
+	}
+
+	std::size_t TempoMap::segmentIdxAtSec(double sec) const
+	{
+		const auto itr = std::upper_bound(m_segmentSecs.begin(), m_segmentSecs.end(), sec);
+		return itr == m_segmentSecs.begin() ? 0U : static_cast<std::size_t>(itr - m_segmentSecs.begin()) - 1U;
+	}
+
+	double TempoMap::pulseToSecInSegment(std::size_t segmentIdx, kson::Pulse pulse) const
+	{
+		return m_segmentSecs[segmentIdx] + static_cast<double>(pulse - m_segmentPulses[segmentIdx]) * m_segmentSecPerPulse[segmentIdx];
+	}
+
+	kson::Pulse TempoMap::secToPulseInSegment(std::size_t segmentIdx, double sec) const
+	{
+		// Note: Truncated toward zero in the same way as kson::SecToPulse()
+		return m_segmentPulses[segmentIdx] + static_cast<kson::Pulse>((sec - m_segmentSecs[segmentIdx]) / m_segmentSecPerPulse[segmentIdx]);
+	}
+
+	TempoMap::TempoMap(const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache)
+	{
+		assert(!beatInfo.bpm.empty());
+
+		const std::size_t numSegments = beatInfo.bpm.size();
+		m_segmentPulses.reserve(numSegments);
+		m_segmentSecs.reserve(numSegments);
+		m_segmentBPMs.reserve(numSegments);
+		m_segmentSecPerPulse.reserve(numSegments);
+		for (const auto& [y, bpm] : beatInfo.bpm)
+		{
+			m_segmentPulses.push_back(y);
+
+			// Note: The base time of each segment is taken from kson so that the error is not accumulated
+			m_segmentSecs.push_back(kson::PulseToSec(y, beatInfo, timingCache));
+			m_segmentBPMs.push_back(bpm);
+			m_segmentSecPerPulse.push_back(60.0 / (bpm * kson::kResolution));
+		}
+	}
+
+	double TempoMap::pulseToSec(kson::Pulse pulse) const
+	{
+		return pulseToSecInSegment(segmentIdxAtPulse(pulse), pulse);
+	}
+
+	kson::Pulse TempoMap::secToPulse(double sec) const
+	{
+		return secToPulseInSegment(segmentIdxAtSec(sec), sec);
+	}
+
+	double TempoMap::tempoAt(kson::Pulse pulse) const
+	{
+		return m_segmentBPMs[segmentIdxAtPulse(pulse)];
+	}
+
+	void TempoMap::convert(std::span<const kson::Pulse> pulses, std::span<double> secs) const
+	{
+		assert(pulses.size() == secs.size());
+
+		Cursor cursor(*this);
+		for (std::size_t i = 0U; i < pulses.size(); ++i)
+		{
+			secs[i] = cursor.pulseToSec(pulses[i]);
+		}
+	}
+
+	std::vector<double> TempoMap::convert(std::span<const kson::Pulse> pulses) const
+	{
+		std::vector<double> secs(pulses.size());
+		convert(pulses, secs);
+		return secs;
+	}
+
+	std::size_t TempoMap::numSegments() const
+	{
+		return m_segmentPulses.size();
+	}
+
+	double MaxTempoMapErrorSec(const TempoMap& tempoMap, std::span<const kson::Pulse> pulses, const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache)
+	{
+		double maxErrorSec = 0.0;
+		const std::vector<double> secs = tempoMap.convert(pulses);
+		for (std::size_t i = 0U; i < pulses.size(); ++i)
+		{
+			const double expectedSec = kson::PulseToSec(pulses[i], beatInfo, timingCache);
+			maxErrorSec = Max(maxErrorSec, Abs(secs[i] - expectedSec));
+
+			// Round trip (a difference of one pulse is allowed because of the truncation)
+			const kson::Pulse pulse = tempoMap.secToPulse(expectedSec);
+			const kson::Pulse expectedPulse = kson::SecToPulse(expectedSec, beatInfo, timingCache);
+			if (Abs(pulse - expectedPulse) > 1)
+			{
+				maxErrorSec = Max(maxErrorSec, Abs(tempoMap.pulseToSec(pulse) - tempoMap.pulseToSec(expectedPulse)));
+			}
+		}
+		return maxErrorSec;
+	}
+}
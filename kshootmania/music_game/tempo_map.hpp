@@ -0,0 +1,72 @@
+﻿#pragma once
+#include <span>
+#include "kson/chart_data.hpp"
+#include "kson/util/timing_utils.hpp"
+
+namespace MusicGame
+{
+	// Piecewise-linear map between pulses and seconds, stored in contiguous arrays of tempo segments
+	// Note: Conversions match kson::PulseToSec()/kson::SecToPulse() without searching std::map, within the rounding error of double for
+	//       pulseToSec() and within one pulse for secToPulse() (the truncation may differ when the time falls right on a pulse boundary).
+	class TempoMap
+	{
+	public:
+		// Keeps the current segment so that monotonic queries (e.g., once per frame) are amortized O(1)
+		// Note: Backward queries also work, but they walk the segments backward.
+		class Cursor
+		{
+		private:
+			const TempoMap* m_pTempoMap;
+			std::size_t m_segmentIdx = 0U;
+
+		public:
+			explicit Cursor(const TempoMap& tempoMap);
+
+			kson::Pulse secToPulse(double sec);
+
+			double pulseToSec(kson::Pulse pulse);
+
+			// Tempo of the segment at the last query
+			double currentTempo() const;
+		};
+
+	private:
+		// Segment i begins at m_segmentPulses[i] (= m_segmentSecs[i]) and has the tempo m_segmentBPMs[i]
+		std::vector<kson::Pulse> m_segmentPulses;
+		std::vector<double> m_segmentSecs;
+		std::vector<double> m_segmentBPMs;
+
+		// Seconds per pulse of each segment (precomputed to avoid division)
+		std::vector<double> m_segmentSecPerPulse;
+
+		std::size_t segmentIdxAtPulse(kson::Pulse pulse) const;
+
+		std::size_t segmentIdxAtSec(double sec) const;
+
+		double pulseToSecInSegment(std::size_t segmentIdx, kson::Pulse pulse) const;
+
+		kson::Pulse secToPulseInSegment(std::size_t segmentIdx, double sec) const;
+
+	public:
+		TempoMap(const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache);
+
+		// O(log n) (use Cursor for monotonic queries)
+		double pulseToSec(kson::Pulse pulse) const;
+
+		kson::Pulse secToPulse(double sec) const;
+
+		double tempoAt(kson::Pulse pulse) const;
+
+		// Converts many pulses at once (e.g., at load time)
+		// Note: It is fastest if the pulses are sorted, because the segment is searched by a cursor.
+		void convert(std::span<const kson::Pulse> pulses, std::span<double> secs) const;
+
+		std::vector<double> convert(std::span<const kson::Pulse> pulses) const;
+
+		std::size_t numSegments() const;
+	};
+
+	// Compares the conversion results with kson and returns the maximum error in seconds
+	// (a difference of one pulse in secToPulse() is not counted as an error; used for validation in --benchmark)
+	double MaxTempoMapErrorSec(const TempoMap& tempoMap, std::span<const kson::Pulse> pulses, const kson::BeatInfo& beatInfo, const kson::TimingCache& timingCache);
+}
@@ -2,11 +2,37 @@
 
 namespace
 {
+	constexpr int32 kPlaySpeedPercentMin = 50;
+	constexpr int32 kPlaySpeedPercentMax = 150;
+
+	// Dead zone in 1/1000 of the lane width, and smoothing time constant in milliseconds
+	constexpr int32 kLaserKnobDeadZoneMax = 100;
+	constexpr int32 kLaserKnobSmoothingMsMax = 100;
+
+	LaserKnobSettings MakeLaserKnobSettings()
+	{
+		return {
+			.inputType = ConfigIni::GetInt(ConfigIni::Key::kLaserInputType, ConfigIni::Value::LaserInputType::kKeyboard),
+			.mouseDirectionX = ConfigIni::GetInt(ConfigIni::Key::kLaserMouseDirectionX, 1) == 0 ? -1 : 1,
+			.mouseDirectionY = ConfigIni::GetInt(ConfigIni::Key::kLaserMouseDirectionY, 1) == 0 ? -1 : 1,
+			.sensitivity = ConfigIni::GetInt(ConfigIni::Key::kLaserSignalSensitivity, 4),
+			.swapLaserLR = ConfigIni::GetBool(ConfigIni::Key::kSwapLaserLR),
+			.deadZone = Clamp(ConfigIni::GetInt(ConfigIni::Key::kLaserKnobDeadZone, 0), 0, kLaserKnobDeadZoneMax) / 1000.0,
+			.smoothingSec = Clamp(ConfigIni::GetInt(ConfigIni::Key::kLaserKnobSmoothing, 0), 0, kLaserKnobSmoothingMsMax) / 1000.0,
+		};
+	}
+
 	MusicGame::GameCreateInfo MakeGameCreateInfo(const PlaySceneArgs& args)
 	{
+		const int32 playSpeedPercent = Clamp(ConfigIni::GetInt(ConfigIni::Key::kPlaySpeed, 100), kPlaySpeedPercentMin, kPlaySpeedPercentMax);
 		return {
 			.chartFilePath = args.chartFilePath,
 			.enableAssistTick = ConfigIni::GetBool(ConfigIni::Key::kAssistTick),
+			.preloadBGM = ConfigIni::GetBool(ConfigIni::Key::kPreloadBGM),
+			.playSpeed = playSpeedPercent / 100.0,
+			.saveReplay = ConfigIni::GetBool(ConfigIni::Key::kSaveReplay),
+			.laserKnobSettings = MakeLaserKnobSettings(),
+			.parallelDrawList = ConfigIni::GetBool(ConfigIni::Key::kParallelDrawList, true),
 		};
 	}
 }
@@ -28,6 +28,41 @@ namespace
 		}
 		return ScreenUtils::Scaled(Vec2{ 0.0, Cos(Math::HalfPi * timeSec / kShakeDurationSec) * kShakeHeight * (direction == kUp ? -1 : 1) });
 	}
+
+	// Number of items preloaded for preview above and below the cursor
+	constexpr int32 kPreviewNeighbourRange = 2;
+
+	SelectPreview::PreviewInfo ToPreviewInfo(const SelectMenuSongItemChartInfo& chartInfo)
+	{
+		return {
+			.filePath = chartInfo.previewBGMFilePath,
+			.offsetSec = chartInfo.previewBGMOffsetSec,
+			.durationSec = chartInfo.previewBGMDurationSec,
+		};
+	}
+
+	Optional<SelectPreview::PreviewInfo> NeighbourPreviewInfo(const SelectMenuItem& item, int32 difficultyIdx)
+	{
+		const SelectMenuSongItemInfo* const pSongInfo = dynamic_cast<const SelectMenuSongItemInfo*>(item.info.get());
+		if (item.itemType != SelectMenuItem::kSong || pSongInfo == nullptr)
+		{
+			return none;
+		}
+
+		// Use the chart of the same difficulty if exists, otherwise the first chart found
+		if (0 <= difficultyIdx && difficultyIdx < kNumDifficulties && pSongInfo->chartInfos[difficultyIdx].has_value())
+		{
+			return ToPreviewInfo(*pSongInfo->chartInfos[difficultyIdx]);
+		}
+		for (const auto& chartInfo : pSongInfo->chartInfos)
+		{
+			if (chartInfo.has_value())
+			{
+				return ToPreviewInfo(*chartInfo);
+			}
+		}
+		return none;
+	}
 }
 
 void SelectMenu::decideSongItem()
@@ -207,6 +242,7 @@ bool SelectMenu::openDirectory(FilePathView directoryPath)
 	}
 
 	refreshGraphics(SelectMenuGraphics::kAll);
+	requestPreview();
 
 	return true;
 }
@@ -233,6 +269,35 @@ void SelectMenu::refreshGraphics(SelectMenuGraphics::RefreshType type)
 	m_shakeStopwatch.restart();
 }
 
+void SelectMenu::requestPreview()
+{
+	if (m_menu.empty())
+	{
+		m_preview.request(none, {});
+		return;
+	}
+
+	const auto pChartInfo = cursorChartInfoPtr();
+	const Optional<SelectPreview::PreviewInfo> cursorInfo = pChartInfo ? MakeOptional(ToPreviewInfo(*pChartInfo)) : none;
+
+	// Order by distance from the cursor so that the nearest items are decoded first
+	Array<SelectPreview::PreviewInfo> neighbourInfos;
+	const int32 cursor = m_menu.cursor();
+	for (int32 distance = 1; distance <= kPreviewNeighbourRange; ++distance)
+	{
+		for (const int32 idx : { cursor + distance, cursor - distance })
+		{
+			const auto info = NeighbourPreviewInfo(m_menu.atCyclic(idx), m_difficultyMenu.cursor());
+			if (info.has_value() && info != cursorInfo && !neighbourInfos.contains(*info))
+			{
+				neighbourInfos.push_back(*info);
+			}
+		}
+	}
+
+	m_preview.request(cursorInfo, neighbourInfos);
+}
+
 SelectMenu::SelectMenu(std::function<void(FilePathView)> moveToPlaySceneFunc)
 	: m_menu(MenuHelper::MakeArrayWithVerticalMenu<SelectMenuItem>(MenuHelper::ButtonFlags::kArrowOrLaser, IsCyclicMenu::Yes, 0.05, 0.3))
 	, m_difficultyMenu(this)
@@ -255,14 +320,18 @@ void SelectMenu::update()
 	if (m_menu.isCursorChanged())
 	{
 		refreshGraphics(m_menu.isCursorIncremented() ? SelectMenuGraphics::kCursorDown : SelectMenuGraphics::kCursorUp);
+		requestPreview();
 	}
 
 	m_difficultyMenu.update();
 	if (m_difficultyMenu.isCursorChanged())
 	{
 		refreshGraphics(SelectMenuGraphics::kAll);
+		requestPreview();
 	}
 
+	m_preview.update();
+
 	// TODO: Delete this debug code
 	m_debugStr.clear();
 	const auto pCursorItem = m_menu.empty() ? nullptr : &m_menu.cursorValue();
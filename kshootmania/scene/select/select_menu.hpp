@@ -4,6 +4,7 @@
 #include "select_menu_item.hpp"
 #include "select_difficulty_menu.hpp"
 #include "select_menu_graphics.hpp"
+#include "select_preview.hpp"
 
 class SelectMenu
 {
@@ -16,6 +17,8 @@ private:
 
 	SelectMenuGraphics m_graphics;
 
+	SelectPreview m_preview;
+
 	SelectMenuShakeDirection m_shakeDirection = SelectMenuShakeDirection::kUnspecified;
 	Stopwatch m_shakeStopwatch;
 
@@ -34,6 +37,8 @@ private:
 
 	void refreshGraphics(SelectMenuGraphics::RefreshType type);
 
+	void requestPreview();
+
 public:
 	explicit SelectMenu(std::function<void(FilePathView)> moveToPlaySceneFunc); // TODO: Restore previous selection
 
@@ -0,0 +1,189 @@
+﻿#include "select_preview.hpp"
+
+namespace
+{
+	constexpr std::size_t kNumWorkers = 2U;
+	constexpr std::size_t kCacheMaxBytes = 64U * 1024U * 1024U;
+
+	// Note: Failed decodes are cached as empty entries that count no bytes, so the number of entries is also limited
+	constexpr std::size_t kCacheMaxEntries = 256U;
+	constexpr double kCrossfadeSec = 0.3;
+}
+
+void SelectPreview::workerMain()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_isTerminating || !m_jobQueue.empty(); });
+			if (m_isTerminating)
+			{
+				return;
+			}
+			job = std::move(m_jobQueue.front());
+			m_jobQueue.pop_front();
+			m_runningJobs.push_back(job);
+		}
+
+		std::shared_ptr<const ksmaudio::WAVImage> wavImage = ksmaudio::DecodedAudioCache::LoadSegment(job.info.filePath.toUTF8(), job.info.offsetSec, job.info.durationSec, job.cancelFlag.get());
+
+		std::lock_guard lock(m_mutex);
+		m_runningJobs.remove_if([&job](const Job& j) { return j.cancelFlag == job.cancelFlag; });
+		if (!job.cancelFlag->load())
+		{
+			storeCacheLocked(job.info, std::move(wavImage));
+		}
+	}
+}
+
+const SelectPreview::CacheEntry* SelectPreview::findCacheLocked(const PreviewInfo& info)
+{
+	const auto itr = std::find_if(m_cache.begin(), m_cache.end(), [&info](const CacheEntry& entry) { return entry.info == info; });
+	if (itr == m_cache.end())
+	{
+		return nullptr;
+	}
+
+	// Move to front (most recently used)
+	if (itr != m_cache.begin())
+	{
+		CacheEntry entry = std::move(*itr);
+		m_cache.erase(itr);
+		m_cache.push_front(std::move(entry));
+	}
+	return &m_cache.front();
+}
+
+void SelectPreview::storeCacheLocked(const PreviewInfo& info, std::shared_ptr<const ksmaudio::WAVImage>&& wavImage)
+{
+	m_cacheBytes += wavImage != nullptr ? wavImage->size() : 0U;
+	m_cache.push_front({ .info = info, .wavImage = std::move(wavImage) });
+
+	// Evict least recently used entries
+	// Note: Images still referenced by the playing streams are kept alive by shared_ptr.
+	while ((m_cacheBytes > kCacheMaxBytes || m_cache.size() > kCacheMaxEntries) && m_cache.size() > 1U)
+	{
+		const auto& back = m_cache.back();
+		m_cacheBytes -= back.wavImage != nullptr ? back.wavImage->size() : 0U;
+		m_cache.pop_back();
+	}
+}
+
+void SelectPreview::switchTo(const Optional<PreviewInfo>& info, std::shared_ptr<const ksmaudio::WAVImage>&& wavImage)
+{
+	if (m_playingStream != nullptr)
+	{
+		m_playingStream->fadeVolume(0.0, kCrossfadeSec);
+		m_fadingOutStreams.push_back(std::move(m_playingStream));
+	}
+
+	m_playingInfo = info;
+	if (wavImage != nullptr)
+	{
+		m_playingStream = std::make_unique<ksmaudio::Stream>(std::move(wavImage), true/* loop */);
+		m_playingStream->setVolume(0.0);
+		m_playingStream->play();
+		m_playingStream->fadeVolume(1.0, kCrossfadeSec);
+	}
+}
+
+SelectPreview::SelectPreview()
+{
+	m_workers.reserve(kNumWorkers);
+	for (std::size_t i = 0U; i < kNumWorkers; ++i)
+	{
+		m_workers.emplace_back([this] { workerMain(); });
+	}
+}
+
+SelectPreview::~SelectPreview()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_isTerminating = true;
+		for (const auto& job : m_runningJobs)
+		{
+			job.cancelFlag->store(true);
+		}
+	}
+	m_condition.notify_all();
+
+	for (auto& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void SelectPreview::request(const Optional<PreviewInfo>& cursorInfo, const Array<PreviewInfo>& neighbourInfos)
+{
+	m_requestedInfo = cursorInfo;
+
+	Array<PreviewInfo> wantedInfos;
+	if (cursorInfo.has_value())
+	{
+		wantedInfos.push_back(*cursorInfo);
+	}
+	wantedInfos.append(neighbourInfos);
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		// Cancel stale decodes
+		for (const auto& job : m_runningJobs)
+		{
+			if (!wantedInfos.contains(job.info))
+			{
+				job.cancelFlag->store(true);
+			}
+		}
+		m_jobQueue.clear();
+
+		// Enqueue in priority order (cursor item first)
+		for (const auto& info : wantedInfos)
+		{
+			const bool isCached = std::any_of(m_cache.begin(), m_cache.end(), [&info](const CacheEntry& entry) { return entry.info == info; });
+			const bool isRunning = m_runningJobs.any([&info](const Job& job) { return job.info == info && !job.cancelFlag->load(); });
+			const bool isQueued = std::any_of(m_jobQueue.begin(), m_jobQueue.end(), [&info](const Job& job) { return job.info == info; });
+			if (!isCached && !isRunning && !isQueued)
+			{
+				m_jobQueue.push_back({ .info = info, .cancelFlag = std::make_shared<std::atomic<bool>>(false) });
+			}
+		}
+	}
+	m_condition.notify_all();
+}
+
+void SelectPreview::update()
+{
+	// Start playing the requested preview once it is decoded
+	if (m_requestedInfo != m_playingInfo)
+	{
+		if (!m_requestedInfo.has_value())
+		{
+			switchTo(none, nullptr);
+		}
+		else
+		{
+			std::shared_ptr<const ksmaudio::WAVImage> wavImage;
+			bool found = false;
+			{
+				std::lock_guard lock(m_mutex);
+				if (const CacheEntry* pEntry = findCacheLocked(*m_requestedInfo))
+				{
+					wavImage = pEntry->wavImage;
+					found = true;
+				}
+			}
+
+			if (found)
+			{
+				switchTo(m_requestedInfo, std::move(wavImage));
+			}
+		}
+	}
+
+	// Release streams whose fade-out has finished
+	m_fadingOutStreams.remove_if([](const std::unique_ptr<ksmaudio::Stream>& stream) { return !stream->isFadingVolume(); });
+}
@@ -0,0 +1,76 @@
+﻿#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "ksmaudio/ksmaudio.hpp"
+
+// Song preview player of the select scene
+// Note: Preview segments are decoded on worker threads into a bounded memory cache, so that cursor movement never blocks the main thread.
+class SelectPreview
+{
+public:
+	struct PreviewInfo
+	{
+		FilePath filePath;
+		double offsetSec = 0.0;
+		double durationSec = 15.0;
+
+		bool operator==(const PreviewInfo&) const = default;
+	};
+
+private:
+	struct Job
+	{
+		PreviewInfo info;
+		std::shared_ptr<std::atomic<bool>> cancelFlag;
+	};
+
+	struct CacheEntry
+	{
+		PreviewInfo info;
+
+		// Note: nullptr if decoding failed (cached to avoid retrying, and evicted by the limit of the number of entries)
+		std::shared_ptr<const ksmaudio::WAVImage> wavImage;
+	};
+
+	// Shared with worker threads (guarded by m_mutex)
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<Job> m_jobQueue;
+	Array<Job> m_runningJobs;
+	std::deque<CacheEntry> m_cache; // Most recently used first
+	std::size_t m_cacheBytes = 0U;
+	bool m_isTerminating = false;
+
+	std::vector<std::thread> m_workers;
+
+	// Used only in the main thread
+	Optional<PreviewInfo> m_requestedInfo;
+	Optional<PreviewInfo> m_playingInfo;
+	std::unique_ptr<ksmaudio::Stream> m_playingStream;
+	Array<std::unique_ptr<ksmaudio::Stream>> m_fadingOutStreams;
+
+	void workerMain();
+
+	const CacheEntry* findCacheLocked(const PreviewInfo& info);
+
+	void storeCacheLocked(const PreviewInfo& info, std::shared_ptr<const ksmaudio::WAVImage>&& wavImage);
+
+	void switchTo(const Optional<PreviewInfo>& info, std::shared_ptr<const ksmaudio::WAVImage>&& wavImage);
+
+public:
+	SelectPreview();
+
+	~SelectPreview();
+
+	SelectPreview(const SelectPreview&) = delete;
+
+	SelectPreview& operator=(const SelectPreview&) = delete;
+
+	// Requests the preview of the cursor item (none to stop)
+	// Note: The neighbours are decoded in advance, and any other pending decodes are cancelled.
+	void request(const Optional<PreviewInfo>& cursorInfo, const Array<PreviewInfo>& neighbourInfos);
+
+	void update();
+};
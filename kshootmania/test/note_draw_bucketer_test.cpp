@@ -0,0 +1,147 @@
+// Tests of the bucketing of the note draw list
+//
+// Usage:
+//   kshootmania_note_draw_bucketer_test [case names...]
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "test_runner.hpp"
+#include "music_game/graphics/highway/note/note_draw_bucketer.hpp"
+
+namespace
+{
+	using namespace MusicGame::Graphics;
+
+	using Key = NoteDrawBucketer::BucketKey;
+
+	// Consecutive quads with the same key share a bucket, and a different key starts a new one
+	void TestMerge()
+	{
+		NoteDrawBucketer bucketer;
+		const Key a = { .target = NoteDrawTarget::kAdditive, .blend = NoteDrawBlend::kAdditive, .textureID = 1U };
+		const Key b = { .target = NoteDrawTarget::kAdditive, .blend = NoteDrawBlend::kAdditive, .textureID = 2U };
+		const Key c = { .target = NoteDrawTarget::kAdditive, .blend = NoteDrawBlend::kDefault, .textureID = 2U };
+
+		CHECK(bucketer.addQuad(a).isNewBucket);
+		CHECK(!bucketer.addQuad(a).isNewBucket);
+		CHECK(bucketer.addQuad(b).isNewBucket); // Texture differs
+		CHECK(bucketer.addQuad(c).isNewBucket); // Blend state differs
+		CHECK(bucketer.addQuad(c).bucketIdx == 2U);
+
+		// Returning to a previous key of the same target starts a new bucket, so that the order within the target is kept
+		const auto result = bucketer.addQuad(a);
+		CHECK(result.isNewBucket && result.bucketIdx == 3U);
+
+		CHECK(bucketer.numQuads() == 6U);
+		CHECK(bucketer.numBuckets() == 4U);
+		CHECK(bucketer.bucketNumQuads(0U) == 2U);
+		CHECK(bucketer.bucketNumQuads(2U) == 2U);
+
+		// a, b: additive / c: default / a: additive
+		CHECK(bucketer.numStateChanges() == 3U);
+	}
+
+	// A bucket is split when its vertices would exceed the range of the 16-bit indices
+	void TestSplitAtMaxVertices()
+	{
+		constexpr std::size_t kMaxQuads = NoteDrawBucketer::kMaxVerticesPerBucket / NoteDrawBucketer::kVerticesPerQuad;
+
+		NoteDrawBucketer bucketer;
+		const Key key = { .target = NoteDrawTarget::kInvMultiply, .blend = NoteDrawBlend::kSubtractive, .textureID = 7U };
+		for (std::size_t i = 0U; i < kMaxQuads; ++i)
+		{
+			const auto result = bucketer.addQuad(key);
+			CHECK(result.bucketIdx == 0U && result.isNewBucket == (i == 0U));
+		}
+		CHECK(bucketer.numBuckets() == 1U);
+		CHECK(bucketer.bucketNumQuads(0U) * NoteDrawBucketer::kVerticesPerQuad == NoteDrawBucketer::kMaxVerticesPerBucket);
+
+		const auto result = bucketer.addQuad(key);
+		CHECK(result.isNewBucket && result.bucketIdx == 1U);
+		CHECK(bucketer.numBuckets() == 2U);
+		CHECK(bucketer.bucketNumQuads(1U) == 1U);
+		CHECK(bucketer.numQuads() == kMaxQuads + 1U);
+
+		// Both halves share the state, so no extra state change is needed
+		CHECK(bucketer.numStateChanges() == 1U);
+	}
+
+	// Submitting the buckets in order draws the quads of each target in the order they were added
+	void TestPerTargetOrder()
+	{
+		NoteDrawBucketer bucketer;
+		std::vector<std::pair<Key, std::size_t>> quads; // (key, bucket index)
+
+		// Note: A fixed LCG, so that the sequence is the same on every platform
+		std::uint32_t seed = 12345U;
+		const auto next = [&seed](std::uint32_t n)
+		{
+			seed = seed * 1664525U + 1013904223U;
+			return (seed >> 16) % n;
+		};
+		for (int i = 0; i < 10000; ++i)
+		{
+			const Key key = {
+				.target = static_cast<NoteDrawTarget>(next(2U)),
+				.blend = static_cast<NoteDrawBlend>(next(3U)),
+				.textureID = next(4U),
+			};
+			quads.emplace_back(key, bucketer.addQuad(key).bucketIdx);
+		}
+		CHECK(bucketer.numQuads() == quads.size());
+
+		for (std::size_t target = 0U; target < static_cast<std::size_t>(NoteDrawTarget::kNumTargets); ++target)
+		{
+			std::size_t prevBucketIdx = 0U;
+			for (const auto& [key, bucketIdx] : quads)
+			{
+				if (static_cast<std::size_t>(key.target) != target)
+				{
+					continue;
+				}
+
+				// Each quad is in a bucket of its own key, and never in a bucket before that of the previous quad of the target
+				CHECK(bucketer.bucketKey(bucketIdx) == key);
+				CHECK(bucketIdx >= prevBucketIdx);
+				prevBucketIdx = bucketIdx;
+			}
+		}
+
+		std::size_t numQuadsInBuckets = 0U;
+		for (std::size_t i = 0U; i < bucketer.numBuckets(); ++i)
+		{
+			numQuadsInBuckets += bucketer.bucketNumQuads(i);
+		}
+		CHECK(numQuadsInBuckets == quads.size());
+	}
+
+	// The bucketer can be reused after clear()
+	void TestClear()
+	{
+		NoteDrawBucketer bucketer;
+		const Key key = { .target = NoteDrawTarget::kAdditive, .blend = NoteDrawBlend::kDefault, .textureID = 3U };
+		bucketer.addQuad(key);
+		bucketer.addQuad({ .target = NoteDrawTarget::kInvMultiply, .blend = NoteDrawBlend::kDefault, .textureID = 3U });
+
+		bucketer.clear();
+		CHECK(bucketer.numQuads() == 0U);
+		CHECK(bucketer.numBuckets() == 0U);
+		CHECK(bucketer.numStateChanges() == 0U);
+
+		const auto result = bucketer.addQuad(key);
+		CHECK(result.isNewBucket && result.bucketIdx == 0U);
+	}
+
+	const TestRunner::CaseTable<std::function<void()>> kCases = {
+		{ "merge", TestMerge },
+		{ "split_at_max_vertices", TestSplitAtMaxVertices },
+		{ "per_target_order", TestPerTargetOrder },
+		{ "clear", TestClear },
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	return TestRunner::RunCheckCases(kCases, std::vector<std::string>(argv + 1, argv + argc));
+}
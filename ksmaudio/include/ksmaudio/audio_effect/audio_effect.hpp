@@ -2,7 +2,6 @@
 #include <array>
 #include <memory>
 #include <cassert>
-#include "bass.h"
 #include "audio_effect_param.hpp"
 
 namespace ksmaudio::AudioEffect
@@ -6,10 +6,12 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <concepts>
-#include "bass.h"
+#include <vector>
+#include <string>
 #include "audio_effect.hpp"
+#include "audio_effect_host.hpp"
 #include "param_controller.hpp"
-#include "ksmaudio/stream.hpp"
+#include "ksmaudio/dsp_load_stats.hpp"
 
 namespace ksmaudio::AudioEffect
 {
@@ -17,9 +19,10 @@ namespace ksmaudio::AudioEffect
     class AudioEffectBus
     {
 	private:
-		Stream* m_pStream;
+		IAudioEffectHost* m_pHost;
 		std::vector<std::unique_ptr<AudioEffect::IAudioEffect>> m_audioEffects;
-		std::vector<HDSP> m_hDSPs;
+		std::vector<IAudioEffectHost::Handle> m_handles;
+		std::vector<std::unique_ptr<DSPLoadStats>> m_loadStats;
 		std::vector<ParamController> m_paramControllers;
 		std::vector<std::string> m_names;
 		std::unordered_map<std::string, std::size_t> m_nameIdxDict;
@@ -28,7 +31,7 @@ namespace ksmaudio::AudioEffect
 	public:
 		AudioEffectBus() = default;
 
-		explicit AudioEffectBus(Stream* pStream);
+		explicit AudioEffectBus(IAudioEffectHost* pHost);
 
 		~AudioEffectBus();
 
@@ -48,7 +51,7 @@ namespace ksmaudio::AudioEffect
 				return;
 			}
 
-			m_audioEffects.push_back(std::make_unique<T>(m_pStream->sampleRate(), m_pStream->numChannels()));
+			m_audioEffects.push_back(std::make_unique<T>(m_pHost->sampleRate(), m_pHost->numChannels()));
 			const auto& audioEffect = m_audioEffects.back();
 
 			for (const auto& [paramID, valueSet] : params)
@@ -65,8 +68,9 @@ namespace ksmaudio::AudioEffect
 			m_names.push_back(name);
 			m_nameIdxDict.emplace(name, m_audioEffects.size() - 1U);
 
-			const HDSP hDSP = m_pStream->addAudioEffect(audioEffect.get(), 0); // TODO: priority
-			m_hDSPs.push_back(hDSP);
+			const auto& loadStats = m_loadStats.emplace_back(std::make_unique<DSPLoadStats>());
+			const IAudioEffectHost::Handle handle = m_pHost->addAudioEffect(audioEffect.get(), 0, loadStats.get()); // TODO: priority
+			m_handles.push_back(handle);
 
 			m_paramControllers.emplace_back(params, paramChanges);
 		}
@@ -88,5 +92,10 @@ namespace ksmaudio::AudioEffect
 				audioEffect->setBypass(bypass);
 			}
 		}
+
+		// Returns pairs of the audio effect name and its DSP load
+		std::vector<std::pair<std::string, DSPLoadSnapshot>> loadSnapshots() const;
+
+		void resetLoadStats();
     };
 }
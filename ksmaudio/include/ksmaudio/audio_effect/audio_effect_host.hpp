@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "audio_effect.hpp"
+#include "ksmaudio/dsp_load_stats.hpp"
+
+namespace ksmaudio::AudioEffect
+{
+	// Audio source that audio effects are attached to (implemented by Stream)
+	// Note: This interface does not depend on BASS, so that AudioEffectBus can also be run by an offline host (e.g., in tests).
+	class IAudioEffectHost
+	{
+	public:
+		// Identifies an attached audio effect (HDSP for Stream)
+		using Handle = std::uint32_t;
+
+		virtual ~IAudioEffectHost() = default;
+
+		virtual std::size_t sampleRate() const = 0;
+
+		virtual std::size_t numChannels() const = 0;
+
+		// Note: pLoadStats can be nullptr, and must be valid until the audio effect is removed.
+		virtual Handle addAudioEffect(IAudioEffect* pAudioEffect, int priority, DSPLoadStats* pLoadStats) = 0;
+
+		virtual void removeAudioEffect(Handle handle) = 0;
+	};
+}
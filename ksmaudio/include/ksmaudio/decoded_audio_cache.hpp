@@ -0,0 +1,34 @@
+﻿#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "ksmaudio/in_memory_pcm.hpp"
+
+// On-disk cache of decoded audio (32-bit float WAV images) keyed by the content hash of the source file
+// Note: Cached files are memory-mapped, so that the second and later loads need neither decoding nor copying.
+namespace ksmaudio::DecodedAudioCache
+{
+	struct Stats
+	{
+		std::uint64_t numHits = 0U;
+		std::uint64_t numMisses = 0U;
+		std::uint64_t numEvictions = 0U;
+	};
+
+	// Enables the cache
+	// Note: Least recently used files are removed when the total size exceeds maxBytes.
+	// Note: The content hash of each source file is computed once per process and reused while its size and last write time are unchanged.
+	void Init(const std::string& directoryPath, std::uint64_t maxBytes);
+
+	// Returns the decoded audio of the file
+	// (decoded without caching if the cache is not enabled, nullptr on failure)
+	// Note: This function is thread-safe.
+	std::shared_ptr<const WAVImage> Load(const std::string& filePath);
+
+	// Returns the decoded audio of a part of the file (e.g., for song previews)
+	// (cached separately for each pair of offsetSec and durationSec, nullptr on failure or when cancelled via pCancel)
+	// Note: This function is thread-safe.
+	std::shared_ptr<const WAVImage> LoadSegment(const std::string& filePath, double offsetSec, double durationSec, const std::atomic<bool>* pCancel = nullptr);
+
+	Stats GetStats();
+}
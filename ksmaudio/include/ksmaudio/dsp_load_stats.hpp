@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ksmaudio
+{
+	struct DSPLoadSnapshot
+	{
+		std::uint64_t numBlocks = 0U;
+
+		// Number of blocks whose processing time exceeded the block duration
+		std::uint64_t numOverruns = 0U;
+
+		// Load ratios (processing time / block duration)
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	// Note: record() is called from the audio thread, and snapshot() is called from the main thread.
+	//       All members are atomics, so that no lock is taken on the audio thread.
+	class DSPLoadStats
+	{
+	public:
+		static constexpr double kBucketWidth = 0.02;
+		static constexpr std::size_t kNumBuckets = 100U; // 0% - 200%, and the last bucket is for overflow
+
+	private:
+		std::array<std::atomic<std::uint64_t>, kNumBuckets + 1U> m_buckets = {};
+		std::atomic<std::uint64_t> m_numOverruns = 0U;
+		std::atomic<double> m_maxLoad = 0.0;
+
+	public:
+		DSPLoadStats() = default;
+
+		DSPLoadStats(const DSPLoadStats&) = delete;
+
+		DSPLoadStats& operator=(const DSPLoadStats&) = delete;
+
+		void record(double elapsedSec, double blockSec);
+
+		DSPLoadSnapshot snapshot() const;
+
+		void reset();
+	};
+
+	std::string DSPLoadSnapshotToString(const DSPLoadSnapshot& snapshot);
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+namespace ksmaudio
+{
+	// Read-only memory block holding a WAV image
+	// (either owned in the heap or memory-mapped from the decoded audio cache)
+	class WAVImage
+	{
+	public:
+		virtual ~WAVImage() = default;
+
+		virtual const std::uint8_t* data() const = 0;
+
+		virtual std::size_t size() const = 0;
+
+		// Peak memory usage while the image was decoded in this process (0 if it was only loaded from the cache)
+		virtual std::size_t decodePeakBytes() const = 0;
+	};
+
+	std::shared_ptr<const WAVImage> MakeWAVImage(std::vector<std::uint8_t>&& bytes, std::size_t decodePeakBytes = 0U);
+
+	// Decodes the whole audio file into a 32-bit float WAV image in memory.
+	// The returned image can be played by BASS_StreamCreateFile(TRUE, ...) without any decoding cost during playback.
+	// Note: The audio is resampled to kSampleRate if the file has a different sample rate.
+	// Note: Returns an empty vector on failure.
+	// Note: If pPeakBytes is not nullptr, the peak memory usage of decoding is stored in it.
+	//       It is larger than the returned image when resampled, because the source image is kept until resampling is finished.
+	std::vector<std::uint8_t> DecodeToInMemoryWAV(const std::string& filePath, std::size_t* pPeakBytes = nullptr);
+
+	// Decodes a part of the audio file into a 32-bit float WAV image in memory (e.g., for song previews)
+	// Note: Returns an empty vector on failure or when cancelled via pCancel.
+	std::vector<std::uint8_t> DecodeSegmentToInMemoryWAV(const std::string& filePath, double offsetSec, double durationSec, const std::atomic<bool>* pCancel = nullptr);
+}
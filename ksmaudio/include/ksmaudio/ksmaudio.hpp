@@ -1,7 +1,12 @@
 #pragma once
 #include "stream.hpp"
 #include "stream_with_effects.hpp"
+#include "dsp_load_stats.hpp"
+#include "decoded_audio_cache.hpp"
+#include "resampler.hpp"
+#include "time_stretcher.hpp"
 #include "sample.hpp"
+#include "se_mixer.hpp"
 #include "audio_effect/all.hpp"
 
 namespace ksmaudio
@@ -13,5 +18,8 @@ namespace ksmaudio
 
 	void Init(void* hWnd);
 
+	// Initializes without an output device (only decode-only streams can be used)
+	void InitHeadless();
+
 	void Terminate();
 }
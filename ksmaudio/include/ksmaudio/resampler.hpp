@@ -0,0 +1,68 @@
+﻿#pragma once
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+namespace ksmaudio
+{
+	// Quality/CPU presets of the resampler
+	enum class ResamplerQuality : std::int32_t
+	{
+		kLow = 0, // 16 taps
+		kMedium, // 32 taps
+		kHigh, // 64 taps
+	};
+
+	// Windowed-sinc polyphase resampler
+	// Note: The filter coefficients are precomputed for a fixed number of phases and linearly interpolated between adjacent phases,
+	//       so that any pair of sample rates can be converted without a drift in the length.
+	class PolyphaseResampler
+	{
+	public:
+		static constexpr std::size_t kNumPhases = 256U;
+
+	private:
+		const std::uint32_t m_srcRate;
+		const std::uint32_t m_dstRate;
+		const std::size_t m_numTaps;
+
+		// (kNumPhases + 1) rows of m_numTaps coefficients
+		std::vector<float> m_coefs;
+
+		void processChannel(const float* pPaddedSrc, float* pDst, std::size_t numDstFrames, std::size_t dstStride) const;
+
+	public:
+		PolyphaseResampler(std::uint32_t srcRate, std::uint32_t dstRate, ResamplerQuality quality);
+
+		std::size_t numOutputFrames(std::size_t numSrcFrames) const;
+
+		// Resamples the whole interleaved PCM at once
+		std::vector<float> processInterleaved(const float* pSrc, std::size_t numSrcFrames, std::size_t numChannels) const;
+
+		// Resamples the whole interleaved PCM into pDst, which must hold numOutputFrames(numSrcFrames) * numChannels samples
+		// Note: Only a single channel is buffered at a time (see workBytes()), so that the output can be written directly into its final place.
+		void processInterleaved(const float* pSrc, std::size_t numSrcFrames, std::size_t numChannels, float* pDst) const;
+
+		// Size of the temporary buffer allocated by processInterleaved()
+		std::size_t workBytes(std::size_t numSrcFrames) const;
+	};
+
+	struct ResamplerBenchmarkResult
+	{
+		// Seconds of audio processed per second of CPU time (for one channel)
+		double realtimeFactor = 0.0;
+
+		// Signal-to-error ratio of a 1 kHz sine wave
+		double snrDB = 0.0;
+
+		// Attenuation of a tone above the output Nyquist frequency (only for downsampling)
+		std::optional<double> aliasRejectionDB;
+	};
+
+	ResamplerBenchmarkResult BenchmarkResampler(std::uint32_t srcRate, std::uint32_t dstRate, ResamplerQuality quality, double durationSec = 10.0);
+
+	// Quality used when decoded audio is converted to kSampleRate
+	void SetResamplerQuality(ResamplerQuality quality);
+
+	ResamplerQuality GetResamplerQuality();
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "bass.h"
+
+namespace ksmaudio
+{
+	// Mixer for short sound effects (e.g., assist ticks, key sounds)
+	// Note: Sounds are preloaded as PCM and mixed into a single BASS stream by a fixed pool of voices.
+	//       Since the stream goes through the same output buffer as the BGM, sound effects have the same latency as the music.
+	class SEMixer
+	{
+	public:
+		using SoundID = std::int32_t;
+
+		static constexpr SoundID kInvalidSoundID = -1;
+
+		static constexpr std::size_t kMaxSounds = 64U;
+
+		static constexpr std::size_t kNumOutputChannels = 2U;
+
+	private:
+		struct PlayCommand
+		{
+			SoundID soundID;
+			float gain;
+
+			// Output frame index to start at (0 to start immediately)
+			std::uint64_t startFrame;
+		};
+
+		struct Voice
+		{
+			SoundID soundID = kInvalidSoundID;
+			std::size_t frameIdx = 0U;
+			float gain = 1.0f;
+
+			// Offset from the beginning of the current block (for sample-accurate start)
+			std::size_t delayFrames = 0U;
+		};
+
+		static constexpr std::size_t kCommandQueueSize = 256U;
+
+		static constexpr std::size_t kMaxScheduledCommands = 256U;
+
+		const std::size_t m_sampleRate;
+
+		// Interleaved stereo PCM of each sound
+		// Note: Reserved in the constructor so that the audio thread never sees a reallocation.
+		std::vector<std::vector<float>> m_sounds;
+
+		// Single-producer (main thread) single-consumer (audio thread) queue
+		std::array<PlayCommand, kCommandQueueSize> m_commandQueue;
+		std::atomic<std::size_t> m_commandQueueHead = 0U; // Written by the audio thread
+		std::atomic<std::size_t> m_commandQueueTail = 0U; // Written by the main thread
+
+		// Used only in the audio thread
+		std::vector<Voice> m_voices;
+		std::vector<PlayCommand> m_scheduledCommands;
+		std::uint64_t m_renderedFrames = 0U;
+
+		std::atomic<std::uint64_t> m_numStolenVoices = 0U;
+
+		HSTREAM m_hStream = 0;
+
+		static DWORD CALLBACK StreamProc(HSTREAM handle, void* buffer, DWORD length, void* user);
+
+		void startVoice(const PlayCommand& command, std::size_t delayFrames);
+
+		void mix(float* pData, std::size_t numFrames);
+
+	public:
+		// Note: If decodeOnly is true, the mix is not played on the output device. It is rendered by decode() instead, so that
+		//       the output clock (playbackFrame()) is advanced by the caller (e.g., by the simulated frames of a headless benchmark).
+		SEMixer(std::size_t sampleRate, std::size_t numVoices, bool decodeOnly = false);
+
+		~SEMixer();
+
+		SEMixer(const SEMixer&) = delete;
+
+		SEMixer& operator=(const SEMixer&) = delete;
+
+		// Returns kInvalidSoundID on failure
+		// Note: filePath must be in UTF-8. Must be called from the main thread.
+		SoundID loadSound(const std::string& filePath);
+
+		// Note: If all voices are in use, the voice playing for the longest time is stolen.
+		void play(SoundID soundID, float gain = 1.0f);
+
+		// Starts playing the sound exactly at the specified output frame (see playbackFrame())
+		// Note: Sounds scheduled at a frame already rendered are started immediately.
+		void playAt(SoundID soundID, std::uint64_t startFrame, float gain = 1.0f);
+
+		// Output frame index currently being heard (the number of frames rendered by decode() if decodeOnly is true)
+		std::uint64_t playbackFrame() const;
+
+		// Renders the mix of a decode-only mixer into interleaved stereo PCM, and returns the number of rendered frames
+		std::size_t decode(float* pBuffer, std::size_t numFrames);
+
+		std::size_t sampleRate() const;
+
+		// Number of voices stolen since the mixer was created
+		std::uint64_t numStolenVoices() const;
+	};
+}
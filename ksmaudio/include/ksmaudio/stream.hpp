@@ -1,21 +1,104 @@
 #pragma once
 #include <string>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
 #include "bass.h"
 #include "ksmaudio/audio_effect/audio_effect.hpp"
+#include "ksmaudio/audio_effect/audio_effect_host.hpp"
+#include "ksmaudio/dsp_load_stats.hpp"
+#include "ksmaudio/in_memory_pcm.hpp"
+#include "ksmaudio/time_stretcher.hpp"
 
 namespace ksmaudio
 {
-	class Stream
+	class Stream : public AudioEffect::IAudioEffectHost
 	{
+	public:
+		struct DSPCallbackContext
+		{
+			AudioEffect::IAudioEffect* pAudioEffect;
+			DSPLoadStats* pLoadStats; // Can be nullptr
+			double secPerSample;
+		};
+
+		// State of time-stretching, shared with the stream callback
+		struct TimeStretchContext
+		{
+			// Decoding stream of the source, which is read by the stream callback
+			const HSTREAM hSourceStream;
+
+			TimeStretcher timeStretcher;
+
+			// Note: Taken by seeking, and tried by the stream callback (which never blocks on it)
+			std::mutex mutex;
+
+			std::vector<float> sourceBuffer;
+			bool isSourceEnded = false;
+
+			// Source position at the last seek, and the output position at that time
+			double seekBaseSec = 0.0;
+			double outputBaseSec = 0.0;
+
+			DSPLoadStats loadStats;
+			double secPerSample = 0.0;
+
+			TimeStretchContext(HSTREAM hSourceStream, std::size_t numChannels, std::size_t sampleRate, double speed);
+
+			~TimeStretchContext();
+		};
+
 	private:
+		// Decoded audio data in memory (nullptr if the stream is read from the file)
+		const std::shared_ptr<const WAVImage> m_preloadedWAV;
+
+		// nullptr if the stream is played at the original speed
+		const std::unique_ptr<TimeStretchContext> m_timeStretch;
+
 		const HSTREAM m_hStream;
 		const BASS_CHANNELINFO m_info;
+		const double m_secPerSample;
+
+		std::unordered_map<HDSP, std::unique_ptr<DSPCallbackContext>> m_dspCallbackContexts;
+
+		// Total processing time of all DSPs, measured between the begin/end marker DSPs
+		DSPLoadStats m_totalLoadStats;
+		std::chrono::steady_clock::time_point m_blockBeginTime;
+		const HDSP m_hBeginMarkerDSP;
+		const HDSP m_hEndMarkerDSP;
+
+		static void CALLBACK BeginMarkerDSP(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user);
+
+		static void CALLBACK EndMarkerDSP(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user);
+
+		static DWORD CALLBACK TimeStretchStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user);
 
 	public:
 		// TODO: filePath encoding problem
-		explicit Stream(const std::string& filePath);
+		// Note: If preload is true, the whole file is decoded to PCM in the constructor and played from memory.
+		//       The decoded data is taken from DecodedAudioCache if it is enabled.
+		//       Files whose sample rate is not kSampleRate are always preloaded, because they are resampled when decoded.
+		// Note: If speed is not 1, the audio is time-stretched before all audio effects, and the positions are in the source time.
+		// Note: If decodeOnly is true, the stream is not played on the output device. The audio (including all audio effects) is
+		//       rendered by decode() instead, which is used to measure the DSP load headlessly.
+		explicit Stream(const std::string& filePath, bool preload = false, double speed = 1.0, bool decodeOnly = false);
+
+		// Plays the decoded audio in memory
+		explicit Stream(std::shared_ptr<const WAVImage> wavImage, bool loop = false);
+
+		virtual ~Stream();
+
+		// Note: The DSP callbacks hold the pointer to this instance, so it must not be copied or moved.
+		Stream(const Stream&) = delete;
 
-		~Stream();
+		Stream& operator=(const Stream&) = delete;
+
+		Stream(Stream&&) = delete;
+
+		Stream& operator=(Stream&&) = delete;
 
 		void play() const;
 
@@ -25,20 +108,44 @@ namespace ksmaudio
 
 		void updateManually() const;
 
+		// Renders the audio of a decode-only stream through all audio effects, and returns the number of rendered frames
+		std::size_t decode(float* pBuffer, std::size_t numFrames) const;
+
+		void setVolume(double volume) const;
+
+		// Changes the volume gradually (processed by BASS, so no per-frame update is needed)
+		void fadeVolume(double volume, double durationSec) const;
+
+		bool isFadingVolume() const;
+
 		double posSec() const;
 
 		void seekPosSec(double timeSec) const;
 
 		double durationSec() const;
 
-		HDSP addAudioEffect(AudioEffect::IAudioEffect* pAudioEffect, int priority) const;
+		// Returns the HDSP of the audio effect
+		virtual Handle addAudioEffect(AudioEffect::IAudioEffect* pAudioEffect, int priority, DSPLoadStats* pLoadStats) override;
 
-		void removeAudioEffect(HDSP hDSP) const;
+		virtual void removeAudioEffect(Handle hDSP) override;
 
-		std::size_t sampleRate() const;
+		virtual std::size_t sampleRate() const override;
 
-		std::size_t numChannels() const;
+		virtual std::size_t numChannels() const override;
 
 		double latencySec() const;
+
+		// Size of the decoded audio data in memory (0 if not preloaded)
+		std::size_t preloadedBytes() const;
+
+		// Peak memory usage while decoding for preloading (0 if not decoded in this process, e.g., taken from DecodedAudioCache)
+		std::size_t preloadPeakBytes() const;
+
+		const DSPLoadStats& totalLoadStats() const;
+
+		// Processing time of time-stretching (nullptr if not time-stretched)
+		const DSPLoadStats* timeStretchLoadStats() const;
+
+		void resetLoadStats();
 	};
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <unordered_map>
+#include "stream.hpp"
 #include "audio_effect/audio_effect_bus.hpp"
 
 namespace ksmaudio
@@ -14,7 +15,7 @@ namespace ksmaudio
 
 	public:
 		// TODO: filePath encoding problem
-		explicit StreamWithEffects(const std::string& filePath);
+		explicit StreamWithEffects(const std::string& filePath, bool preload = false, double speed = 1.0, bool decodeOnly = false);
 
 		void play() const;
 
@@ -24,6 +25,8 @@ namespace ksmaudio
 
 		void updateManually() const;
 
+		std::size_t decode(float* pBuffer, std::size_t numFrames) const;
+
 		double posSec() const;
 
 		void seekPosSec(double timeSec) const;
@@ -36,7 +39,20 @@ namespace ksmaudio
 
 		double latencySec() const;
 
+		std::size_t preloadedBytes() const;
+
+		std::size_t preloadPeakBytes() const;
+
 		// Note: The pointer is valid until this StreamWithEffects instance is destroyed.
 		AudioEffect::AudioEffectBus* emplaceAudioEffectBus();
+
+		// DSP load of all audio effects in total
+		DSPLoadSnapshot totalLoadSnapshot() const;
+
+		// DSP load of each audio effect (names are prefixed with the bus index, e.g. "0/retrigger")
+		// Note: "time_stretch" is added at the beginning if the stream is time-stretched.
+		std::vector<std::pair<std::string, DSPLoadSnapshot>> audioEffectLoadSnapshots() const;
+
+		void resetLoadStats();
 	};
 }
@@ -0,0 +1,84 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace ksmaudio
+{
+	// WSOLA (waveform similarity overlap-add) time-stretcher that changes the playback speed without changing the pitch
+	// Note: Source frame (speed * n) is centered at output frame n, so the source position can be derived from the output position.
+	// Note: All buffers are allocated in the constructor, so that it can be used in the audio thread without any allocation.
+	class TimeStretcher
+	{
+	private:
+		const std::size_t m_numChannels;
+		const double m_speed;
+
+		// Length of a segment, and synthesis hop (half the segment length)
+		const std::size_t m_segmentFrames;
+		const std::size_t m_hopFrames;
+
+		// Maximum offset of the segment from the nominal position
+		const std::size_t m_searchFrames;
+
+		// Hann window of the segment length
+		std::vector<float> m_window;
+
+		// Capacities of the input and output buffers in frames
+		const std::size_t m_inputCapacityFrames;
+		const std::size_t m_outputCapacityFrames;
+
+		// Input frames (interleaved, and mixed down to mono for the similarity search)
+		// Note: These are linear buffers compacted after each segment (instead of ring buffers) because the similarity search needs contiguous frames.
+		std::vector<float> m_input;
+		std::vector<float> m_inputMono;
+		std::size_t m_numInputFrames = 0U;
+
+		// Source frame index of m_input[0] (including the zero padding at the beginning)
+		std::uint64_t m_inputBeginFrame = 0U;
+
+		// Index of the next segment
+		std::uint64_t m_segmentIdx = 0U;
+
+		// Latter half of the previous segment (mono), which the next segment should resemble
+		std::vector<float> m_reference;
+		bool m_hasReference = false;
+
+		// Overlap-add buffer of one segment length
+		std::vector<float> m_overlapAdd;
+
+		// Ring buffer of the completed output frames (interleaved)
+		std::vector<float> m_output;
+		std::size_t m_outputReadFrame = 0U;
+		std::size_t m_numOutputFrames = 0U;
+
+		bool m_isFlushed = false;
+
+		double nominalSegmentBeginFrame(std::uint64_t segmentIdx) const;
+
+		std::size_t findBestOffset(std::size_t nominalIdx) const;
+
+		void processSegment();
+
+		// Adds source frames (silence if pData is nullptr)
+		void pushFrames(const float* pData, std::size_t numFrames);
+
+	public:
+		TimeStretcher(std::size_t numChannels, std::size_t sampleRate, double speed);
+
+		void reset();
+
+		// Adds source frames
+		void pushInput(const float* pData, std::size_t numFrames);
+
+		// Adds silence after the last frame so that all remaining output can be read
+		void flush();
+
+		// Reads output frames (returns the number of frames written)
+		std::size_t popOutput(float* pData, std::size_t maxFrames);
+
+		// Number of source frames required to produce the next output
+		std::size_t numInputFramesNeeded() const;
+
+		double speed() const;
+	};
+}
@@ -2,16 +2,16 @@
 
 namespace ksmaudio::AudioEffect
 {
-	AudioEffectBus::AudioEffectBus(Stream* pStream)
-		: m_pStream(pStream)
+	AudioEffectBus::AudioEffectBus(IAudioEffectHost* pHost)
+		: m_pHost(pHost)
 	{
 	}
 
 	AudioEffectBus::~AudioEffectBus()
     {
-		for (const auto& hDSP : m_hDSPs)
+		for (const auto& handle : m_handles)
 		{
-			m_pStream->removeAudioEffect(hDSP);
+			m_pHost->removeAudioEffect(handle);
 		}
     }
 
@@ -64,4 +64,23 @@ namespace ksmaudio::AudioEffect
 			m_audioEffects[i]->updateStatus(status, isOn);
 		}
 	}
+
+	std::vector<std::pair<std::string, DSPLoadSnapshot>> AudioEffectBus::loadSnapshots() const
+	{
+		std::vector<std::pair<std::string, DSPLoadSnapshot>> snapshots;
+		snapshots.reserve(m_loadStats.size());
+		for (std::size_t i = 0U; i < m_loadStats.size(); ++i)
+		{
+			snapshots.emplace_back(m_names[i], m_loadStats[i]->snapshot());
+		}
+		return snapshots;
+	}
+
+	void AudioEffectBus::resetLoadStats()
+	{
+		for (const auto& loadStats : m_loadStats)
+		{
+			loadStats->reset();
+		}
+	}
 }
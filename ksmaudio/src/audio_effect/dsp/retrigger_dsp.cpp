@@ -1,4 +1,5 @@
 #include "ksmaudio/audio_effect/dsp/retrigger_dsp.hpp"
+#include <utility>
 
 namespace ksmaudio::AudioEffect
 {
@@ -0,0 +1,419 @@
+﻿#include "ksmaudio/decoded_audio_cache.hpp"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <unordered_map>
+#include <cstdio>
+#include <windows.h>
+#include "ksmaudio/ksmaudio.hpp"
+#include "ksmaudio/resampler.hpp"
+
+namespace ksmaudio::DecodedAudioCache
+{
+	namespace
+	{
+		constexpr std::size_t kHashReadBlockBytes = 1U << 20;
+
+		std::mutex s_mutex;
+		std::filesystem::path s_directoryPath;
+		std::uint64_t s_maxBytes = 0U;
+		bool s_enabled = false;
+
+		// Total size of the cache files, counted by the last scan of the directory and the writes since then
+		// Note: The directory is scanned only when this exceeds s_maxBytes, so that writing a file does not need a scan.
+		std::uint64_t s_totalBytes = 0U;
+
+		// Content hashes of the source files already hashed in this process
+		// Note: The hash is reused while the size and the last write time of the file are unchanged.
+		struct FileHashMemoEntry
+		{
+			std::uint64_t size;
+			std::filesystem::file_time_type lastWriteTime;
+			std::uint64_t hash;
+		};
+		std::unordered_map<std::string, FileHashMemoEntry> s_fileHashMemo;
+
+		std::atomic<std::uint64_t> s_numHits = 0U;
+		std::atomic<std::uint64_t> s_numMisses = 0U;
+		std::atomic<std::uint64_t> s_numEvictions = 0U;
+
+		std::filesystem::path UTF8ToPath(const std::string& str)
+		{
+			return std::filesystem::path(std::u8string(str.begin(), str.end()));
+		}
+
+		class MappedWAVImage : public WAVImage
+		{
+		private:
+			HANDLE m_hFile = INVALID_HANDLE_VALUE;
+			HANDLE m_hMapping = nullptr;
+			const std::uint8_t* m_pData = nullptr;
+			std::size_t m_size = 0U;
+			const std::size_t m_decodePeakBytes;
+
+		public:
+			explicit MappedWAVImage(const std::filesystem::path& path, std::size_t decodePeakBytes = 0U)
+				: m_decodePeakBytes(decodePeakBytes)
+			{
+				// Note: FILE_SHARE_DELETE is specified so that the file can be evicted while it is mapped
+				m_hFile = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (m_hFile == INVALID_HANDLE_VALUE)
+				{
+					return;
+				}
+
+				LARGE_INTEGER fileSize;
+				if (!GetFileSizeEx(m_hFile, &fileSize) || fileSize.QuadPart == 0)
+				{
+					return;
+				}
+
+				m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (m_hMapping == nullptr)
+				{
+					return;
+				}
+
+				m_pData = static_cast<const std::uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+				if (m_pData != nullptr)
+				{
+					m_size = static_cast<std::size_t>(fileSize.QuadPart);
+				}
+			}
+
+			virtual ~MappedWAVImage()
+			{
+				if (m_pData != nullptr)
+				{
+					UnmapViewOfFile(m_pData);
+				}
+				if (m_hMapping != nullptr)
+				{
+					CloseHandle(m_hMapping);
+				}
+				if (m_hFile != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(m_hFile);
+				}
+			}
+
+			MappedWAVImage(const MappedWAVImage&) = delete;
+
+			MappedWAVImage& operator=(const MappedWAVImage&) = delete;
+
+			bool isValid() const
+			{
+				return m_pData != nullptr;
+			}
+
+			virtual const std::uint8_t* data() const override
+			{
+				return m_pData;
+			}
+
+			virtual std::size_t size() const override
+			{
+				return m_size;
+			}
+
+			virtual std::size_t decodePeakBytes() const override
+			{
+				return m_decodePeakBytes;
+			}
+		};
+
+		// 64-bit FNV-1a hash of the file content (combined with the file size)
+		// (false if the file cannot be read or the hashing is cancelled via pCancel)
+		bool HashFile(const std::filesystem::path& path, const std::atomic<bool>* pCancel, std::uint64_t* pHash)
+		{
+			std::ifstream ifs(path, std::ios::binary);
+			if (!ifs)
+			{
+				return false;
+			}
+
+			std::uint64_t hash = 14695981039346656037ULL;
+			std::uint64_t totalBytes = 0U;
+			std::vector<char> buffer(kHashReadBlockBytes);
+			while (ifs)
+			{
+				if (pCancel != nullptr && pCancel->load(std::memory_order_relaxed))
+				{
+					return false;
+				}
+
+				ifs.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+				const auto readBytes = static_cast<std::size_t>(ifs.gcount());
+				for (std::size_t i = 0U; i < readBytes; ++i)
+				{
+					hash ^= static_cast<std::uint8_t>(buffer[i]);
+					hash *= 1099511628211ULL;
+				}
+				totalBytes += readBytes;
+			}
+
+			*pHash = hash ^ (totalBytes * 0x9E3779B97F4A7C15ULL);
+			return true;
+		}
+
+		// Returns the content hash of the file, reading the file only if it has not been hashed with the same size and last write time
+		bool MemoizedHashFile(const std::string& filePath, const std::atomic<bool>* pCancel, std::uint64_t* pHash)
+		{
+			const std::filesystem::path path = UTF8ToPath(filePath);
+			std::error_code ec;
+			const std::uint64_t size = std::filesystem::file_size(path, ec);
+			if (ec)
+			{
+				return false;
+			}
+			const std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(path, ec);
+			if (ec)
+			{
+				return false;
+			}
+
+			{
+				std::lock_guard lock(s_mutex);
+				const auto it = s_fileHashMemo.find(filePath);
+				if (it != s_fileHashMemo.end() && it->second.size == size && it->second.lastWriteTime == lastWriteTime)
+				{
+					*pHash = it->second.hash;
+					return true;
+				}
+			}
+
+			if (!HashFile(path, pCancel, pHash))
+			{
+				return false;
+			}
+
+			std::lock_guard lock(s_mutex);
+			s_fileHashMemo.insert_or_assign(filePath, FileHashMemoEntry{ .size = size, .lastWriteTime = lastWriteTime, .hash = *pHash });
+			return true;
+		}
+
+		// Decoded data depends on the resampler settings as well as the file content
+		std::uint64_t CombineDecodeSettings(std::uint64_t hash)
+		{
+			hash ^= (static_cast<std::uint64_t>(kSampleRate) << 8U) | static_cast<std::uint64_t>(GetResamplerQuality());
+			hash *= 1099511628211ULL;
+			return hash;
+		}
+
+		std::filesystem::path CacheFilePath(std::uint64_t hash)
+		{
+			char filename[32];
+			std::snprintf(filename, sizeof(filename), "%016llx.wav", static_cast<unsigned long long>(hash));
+			return s_directoryPath / filename;
+		}
+
+		bool WriteFile(const std::filesystem::path& path, const std::vector<std::uint8_t>& bytes)
+		{
+			std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+			if (!ofs)
+			{
+				return false;
+			}
+			ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			return static_cast<bool>(ofs);
+		}
+
+		// Scans the directory and removes least recently used files until the total size fits in the limit
+		// Note: The caller must lock s_mutex.
+		void EvictLocked(const std::filesystem::path& keepPath)
+		{
+			struct Entry
+			{
+				std::filesystem::path path;
+				std::filesystem::file_time_type lastWriteTime;
+				std::uint64_t size;
+			};
+
+			std::vector<Entry> entries;
+			std::uint64_t totalBytes = 0U;
+			std::error_code ec;
+			for (const auto& dirEntry : std::filesystem::directory_iterator(s_directoryPath, ec))
+			{
+				if (!dirEntry.is_regular_file(ec) || dirEntry.path().extension() != ".wav")
+				{
+					continue;
+				}
+				const std::uint64_t size = dirEntry.file_size(ec);
+				entries.push_back({ dirEntry.path(), dirEntry.last_write_time(ec), size });
+				totalBytes += size;
+			}
+
+			if (totalBytes <= s_maxBytes)
+			{
+				s_totalBytes = totalBytes;
+				return;
+			}
+
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastWriteTime < b.lastWriteTime; });
+			for (const auto& entry : entries)
+			{
+				if (totalBytes <= s_maxBytes)
+				{
+					break;
+				}
+				if (entry.path == keepPath)
+				{
+					continue;
+				}
+				if (std::filesystem::remove(entry.path, ec))
+				{
+					totalBytes -= entry.size;
+					++s_numEvictions;
+				}
+			}
+			s_totalBytes = totalBytes;
+		}
+
+		std::shared_ptr<const WAVImage> MapFile(const std::filesystem::path& path, std::size_t decodePeakBytes = 0U)
+		{
+			auto image = std::make_shared<MappedWAVImage>(path, decodePeakBytes);
+			if (!image->isValid())
+			{
+				return nullptr;
+			}
+			return image;
+		}
+
+		// Mixes the segment range into the hash so that each segment has its own cache file
+		std::uint64_t CombineSegment(std::uint64_t hash, double offsetSec, double durationSec)
+		{
+			for (const double value : { offsetSec, durationSec })
+			{
+				hash ^= std::bit_cast<std::uint64_t>(value);
+				hash *= 1099511628211ULL;
+			}
+			return hash;
+		}
+
+		// Note: combineKey mixes the parameters other than the file content into the hash, and decode decodes the file on a cache miss.
+		template <typename CombineKeyFunc, typename DecodeFunc>
+		std::shared_ptr<const WAVImage> LoadImpl(const std::string& filePath, const std::atomic<bool>* pCancel, CombineKeyFunc combineKey, DecodeFunc decode)
+		{
+			bool enabled;
+			{
+				std::lock_guard lock(s_mutex);
+				enabled = s_enabled;
+			}
+
+			std::uint64_t hash;
+			if (!enabled || !MemoizedHashFile(filePath, pCancel, &hash))
+			{
+				if (pCancel != nullptr && pCancel->load())
+				{
+					return nullptr;
+				}
+
+				std::size_t peakBytes = 0U;
+				std::vector<std::uint8_t> bytes = decode(&peakBytes);
+				return MakeWAVImage(std::move(bytes), peakBytes);
+			}
+
+			const std::filesystem::path cacheFilePath = CacheFilePath(combineKey(CombineDecodeSettings(hash)));
+			std::error_code ec;
+			if (std::filesystem::exists(cacheFilePath, ec))
+			{
+				if (auto image = MapFile(cacheFilePath))
+				{
+					// Update the timestamp for LRU eviction
+					std::filesystem::last_write_time(cacheFilePath, std::filesystem::file_time_type::clock::now(), ec);
+					++s_numHits;
+					return image;
+				}
+			}
+
+			++s_numMisses;
+			std::size_t peakBytes = 0U;
+			std::vector<std::uint8_t> bytes = decode(&peakBytes);
+			if (bytes.empty())
+			{
+				return nullptr;
+			}
+
+			// Write to a temporary file first so that a partially written file is never mapped by another thread
+			std::filesystem::path tempFilePath = cacheFilePath;
+			tempFilePath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+			if (!WriteFile(tempFilePath, bytes))
+			{
+				std::filesystem::remove(tempFilePath, ec);
+				return MakeWAVImage(std::move(bytes), peakBytes);
+			}
+			std::filesystem::rename(tempFilePath, cacheFilePath, ec);
+			if (ec)
+			{
+				std::filesystem::remove(tempFilePath, ec);
+				return MakeWAVImage(std::move(bytes), peakBytes);
+			}
+
+			{
+				std::lock_guard lock(s_mutex);
+				s_totalBytes += bytes.size();
+				if (s_totalBytes > s_maxBytes)
+				{
+					EvictLocked(cacheFilePath);
+				}
+			}
+
+			if (auto image = MapFile(cacheFilePath, peakBytes))
+			{
+				return image;
+			}
+			return MakeWAVImage(std::move(bytes), peakBytes);
+		}
+	}
+
+	void Init(const std::string& directoryPath, std::uint64_t maxBytes)
+	{
+		std::lock_guard lock(s_mutex);
+
+		std::error_code ec;
+		s_directoryPath = UTF8ToPath(directoryPath);
+		std::filesystem::create_directories(s_directoryPath, ec);
+		s_maxBytes = maxBytes;
+		s_enabled = maxBytes > 0U && std::filesystem::is_directory(s_directoryPath, ec);
+		if (s_enabled)
+		{
+			EvictLocked({});
+		}
+	}
+
+	std::shared_ptr<const WAVImage> Load(const std::string& filePath)
+	{
+		return LoadImpl(
+			filePath,
+			nullptr,
+			[](std::uint64_t hash) { return hash; },
+			[&filePath](std::size_t* pPeakBytes) { return DecodeToInMemoryWAV(filePath, pPeakBytes); });
+	}
+
+	std::shared_ptr<const WAVImage> LoadSegment(const std::string& filePath, double offsetSec, double durationSec, const std::atomic<bool>* pCancel)
+	{
+		if (pCancel != nullptr && pCancel->load())
+		{
+			return nullptr;
+		}
+
+		return LoadImpl(
+			filePath,
+			pCancel,
+			[offsetSec, durationSec](std::uint64_t hash) { return CombineSegment(hash, offsetSec, durationSec); },
+			[&](std::size_t*) { return DecodeSegmentToInMemoryWAV(filePath, offsetSec, durationSec, pCancel); });
+	}
+
+	Stats GetStats()
+	{
+		return {
+			.numHits = s_numHits.load(),
+			.numMisses = s_numMisses.load(),
+			.numEvictions = s_numEvictions.load(),
+		};
+	}
+}
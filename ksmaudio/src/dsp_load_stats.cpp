@@ -0,0 +1,105 @@
+#include "ksmaudio/dsp_load_stats.hpp"
+#include <cstdio>
+
+namespace ksmaudio
+{
+	namespace
+	{
+		double PercentileFromBuckets(const std::array<std::uint64_t, DSPLoadStats::kNumBuckets + 1U>& buckets, std::uint64_t numBlocks, double percentile, double maxLoad)
+		{
+			if (numBlocks == 0U)
+			{
+				return 0.0;
+			}
+
+			const auto threshold = static_cast<std::uint64_t>(static_cast<double>(numBlocks) * percentile);
+			std::uint64_t sum = 0U;
+			for (std::size_t i = 0U; i < buckets.size(); ++i)
+			{
+				sum += buckets[i];
+				if (sum > threshold)
+				{
+					if (i == DSPLoadStats::kNumBuckets)
+					{
+						// Overflow bucket
+						return maxLoad;
+					}
+
+					// Upper bound of the bucket (never exceeds the maximum actually measured)
+					const double upper = static_cast<double>(i + 1U) * DSPLoadStats::kBucketWidth;
+					return upper < maxLoad ? upper : maxLoad;
+				}
+			}
+			return maxLoad;
+		}
+	}
+
+	void DSPLoadStats::record(double elapsedSec, double blockSec)
+	{
+		if (blockSec <= 0.0)
+		{
+			return;
+		}
+
+		const double load = elapsedSec / blockSec;
+		std::size_t bucketIdx = static_cast<std::size_t>(load / kBucketWidth);
+		if (bucketIdx > kNumBuckets)
+		{
+			bucketIdx = kNumBuckets;
+		}
+		m_buckets[bucketIdx].fetch_add(1U, std::memory_order_relaxed);
+		if (load > 1.0)
+		{
+			m_numOverruns.fetch_add(1U, std::memory_order_relaxed);
+		}
+
+		double prevMax = m_maxLoad.load(std::memory_order_relaxed);
+		while (load > prevMax && !m_maxLoad.compare_exchange_weak(prevMax, load, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	DSPLoadSnapshot DSPLoadStats::snapshot() const
+	{
+		std::array<std::uint64_t, kNumBuckets + 1U> buckets;
+		std::uint64_t numBlocks = 0U;
+		for (std::size_t i = 0U; i < buckets.size(); ++i)
+		{
+			buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+			numBlocks += buckets[i];
+		}
+
+		const double maxLoad = m_maxLoad.load(std::memory_order_relaxed);
+		return {
+			.numBlocks = numBlocks,
+			.numOverruns = m_numOverruns.load(std::memory_order_relaxed),
+			.p50 = PercentileFromBuckets(buckets, numBlocks, 0.50, maxLoad),
+			.p95 = PercentileFromBuckets(buckets, numBlocks, 0.95, maxLoad),
+			.p99 = PercentileFromBuckets(buckets, numBlocks, 0.99, maxLoad),
+			.max = maxLoad,
+		};
+	}
+
+	void DSPLoadStats::reset()
+	{
+		for (auto& bucket : m_buckets)
+		{
+			bucket.store(0U, std::memory_order_relaxed);
+		}
+		m_numOverruns.store(0U, std::memory_order_relaxed);
+		m_maxLoad.store(0.0, std::memory_order_relaxed);
+	}
+
+	std::string DSPLoadSnapshotToString(const DSPLoadSnapshot& snapshot)
+	{
+		char buf[128];
+		std::snprintf(buf, sizeof(buf), "blocks=%llu overruns=%llu p50=%.1f%% p95=%.1f%% p99=%.1f%% max=%.1f%%",
+			static_cast<unsigned long long>(snapshot.numBlocks),
+			static_cast<unsigned long long>(snapshot.numOverruns),
+			snapshot.p50 * 100.0,
+			snapshot.p95 * 100.0,
+			snapshot.p99 * 100.0,
+			snapshot.max * 100.0);
+		return buf;
+	}
+}
@@ -0,0 +1,308 @@
+﻿#include "ksmaudio/in_memory_pcm.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "bass.h"
+#include "ksmaudio/ksmaudio.hpp"
+#include "ksmaudio/resampler.hpp"
+
+namespace ksmaudio
+{
+	namespace
+	{
+		constexpr std::size_t kWAVHeaderSize = 44U;
+
+		constexpr std::size_t kMaxDecodeThreads = 4U;
+
+		// Files shorter than this are decoded in a single thread
+		constexpr double kMinParallelDecodeSec = 30.0;
+
+		constexpr DWORD kDecodeBlockBytes = 1U << 20;
+
+		// Smaller block for segment decoding so that cancellation is responsive
+		constexpr DWORD kSegmentDecodeBlockBytes = 1U << 16;
+
+		HSTREAM OpenDecodeStream(const std::string& filePath)
+		{
+			return BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT | BASS_STREAM_PRESCAN);
+		}
+
+		// Returns whether seeking is sample-accurate (with BASS_STREAM_PRESCAN) so that the file can be decoded in parallel chunks
+		bool SupportsParallelDecode(DWORD ctype)
+		{
+			switch (ctype)
+			{
+			case BASS_CTYPE_STREAM_OGG:
+			case BASS_CTYPE_STREAM_MP1:
+			case BASS_CTYPE_STREAM_MP2:
+			case BASS_CTYPE_STREAM_MP3:
+			case BASS_CTYPE_STREAM_WAV_PCM:
+			case BASS_CTYPE_STREAM_WAV_FLOAT:
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+		template <typename T>
+		void WriteLE(std::uint8_t* pDst, T value)
+		{
+			for (std::size_t i = 0U; i < sizeof(T); ++i)
+			{
+				pDst[i] = static_cast<std::uint8_t>(value >> (i * 8U));
+			}
+		}
+
+		void WriteWAVHeader(std::uint8_t* pDst, std::uint32_t sampleRate, std::uint16_t numChannels, std::uint32_t dataBytes)
+		{
+			constexpr std::uint16_t kFormatIEEEFloat = 3U;
+			constexpr std::uint16_t kBitsPerSample = 32U;
+			const std::uint16_t blockAlign = static_cast<std::uint16_t>(numChannels * sizeof(float));
+
+			std::memcpy(pDst, "RIFF", 4);
+			WriteLE<std::uint32_t>(pDst + 4, static_cast<std::uint32_t>(kWAVHeaderSize - 8U + dataBytes));
+			std::memcpy(pDst + 8, "WAVEfmt ", 8);
+			WriteLE<std::uint32_t>(pDst + 16, 16U);
+			WriteLE<std::uint16_t>(pDst + 20, kFormatIEEEFloat);
+			WriteLE<std::uint16_t>(pDst + 22, numChannels);
+			WriteLE<std::uint32_t>(pDst + 24, sampleRate);
+			WriteLE<std::uint32_t>(pDst + 28, sampleRate * blockAlign);
+			WriteLE<std::uint16_t>(pDst + 32, blockAlign);
+			WriteLE<std::uint16_t>(pDst + 34, kBitsPerSample);
+			std::memcpy(pDst + 36, "data", 4);
+			WriteLE<std::uint32_t>(pDst + 40, dataBytes);
+		}
+
+		// Converts the decoded audio to kSampleRate so that all audio effects run at the same sample rate
+		// Note: The source and the resampled images coexist during resampling, and *pPeakBytes is set to their total size (plus the work buffer of the resampler).
+		std::vector<std::uint8_t> ResampleWAVImage(std::vector<std::uint8_t>&& image, std::uint32_t srcRate, std::uint16_t numChannels, std::size_t* pPeakBytes)
+		{
+			if (srcRate == kSampleRate || srcRate == 0U || numChannels == 0U)
+			{
+				if (pPeakBytes != nullptr)
+				{
+					*pPeakBytes = image.size();
+				}
+				return std::move(image);
+			}
+
+			const std::size_t numSrcFrames = (image.size() - kWAVHeaderSize) / (numChannels * sizeof(float));
+			const PolyphaseResampler resampler(srcRate, kSampleRate, GetResamplerQuality());
+			const std::uint64_t dataBytes = static_cast<std::uint64_t>(resampler.numOutputFrames(numSrcFrames)) * numChannels * sizeof(float);
+			if (dataBytes > UINT32_MAX - kWAVHeaderSize)
+			{
+				return {};
+			}
+
+			// Resample directly from the source image into the destination image without intermediate copies
+			// Note: The sample data starts at a multiple of 4 bytes from the beginning of a heap block, so it is aligned for float.
+			std::vector<std::uint8_t> resampled(kWAVHeaderSize + static_cast<std::size_t>(dataBytes));
+			WriteWAVHeader(resampled.data(), kSampleRate, numChannels, static_cast<std::uint32_t>(dataBytes));
+			const float* const pSrc = reinterpret_cast<const float*>(image.data() + kWAVHeaderSize);
+			float* const pDst = reinterpret_cast<float*>(resampled.data() + kWAVHeaderSize);
+			resampler.processInterleaved(pSrc, numSrcFrames, numChannels, pDst);
+
+			if (pPeakBytes != nullptr)
+			{
+				*pPeakBytes = image.size() + resampled.size() + resampler.workBytes(numSrcFrames);
+			}
+			return resampled;
+		}
+
+		class HeapWAVImage : public WAVImage
+		{
+		private:
+			const std::vector<std::uint8_t> m_bytes;
+
+			const std::size_t m_decodePeakBytes;
+
+		public:
+			HeapWAVImage(std::vector<std::uint8_t>&& bytes, std::size_t decodePeakBytes)
+				: m_bytes(std::move(bytes))
+				, m_decodePeakBytes(decodePeakBytes)
+			{
+			}
+
+			virtual const std::uint8_t* data() const override
+			{
+				return m_bytes.data();
+			}
+
+			virtual std::size_t size() const override
+			{
+				return m_bytes.size();
+			}
+
+			virtual std::size_t decodePeakBytes() const override
+			{
+				return m_decodePeakBytes;
+			}
+		};
+
+		// Returns false if cancelled
+		bool DecodeRange(HSTREAM hStream, std::uint8_t* pDst, std::uint64_t numBytes, const std::atomic<bool>* pCancel = nullptr)
+		{
+			std::uint64_t pos = 0U;
+			while (pos < numBytes)
+			{
+				if (pCancel != nullptr && pCancel->load(std::memory_order_relaxed))
+				{
+					return false;
+				}
+
+				const DWORD blockBytes = static_cast<DWORD>(std::min<std::uint64_t>(numBytes - pos, pCancel != nullptr ? kSegmentDecodeBlockBytes : kDecodeBlockBytes));
+				const DWORD readBytes = BASS_ChannelGetData(hStream, pDst + pos, blockBytes);
+				if (readBytes == static_cast<DWORD>(-1) || readBytes == 0U)
+				{
+					break;
+				}
+				pos += readBytes;
+			}
+
+			if (pos < numBytes)
+			{
+				// Fill the rest with silence if the decoder ended early
+				std::memset(pDst + pos, 0, static_cast<std::size_t>(numBytes - pos));
+			}
+			return true;
+		}
+	}
+
+	std::shared_ptr<const WAVImage> MakeWAVImage(std::vector<std::uint8_t>&& bytes, std::size_t decodePeakBytes)
+	{
+		if (bytes.empty())
+		{
+			return nullptr;
+		}
+		return std::make_shared<HeapWAVImage>(std::move(bytes), decodePeakBytes);
+	}
+
+	std::vector<std::uint8_t> DecodeToInMemoryWAV(const std::string& filePath, std::size_t* pPeakBytes)
+	{
+		const HSTREAM hStream = OpenDecodeStream(filePath);
+		if (hStream == 0)
+		{
+			return {};
+		}
+
+		BASS_CHANNELINFO info;
+		BASS_ChannelGetInfo(hStream, &info);
+
+		const std::uint64_t frameBytes = info.chans * sizeof(float);
+		std::uint64_t dataBytes = BASS_ChannelGetLength(hStream, BASS_POS_BYTE);
+		if (dataBytes == static_cast<QWORD>(-1) || frameBytes == 0U || dataBytes > UINT32_MAX - kWAVHeaderSize)
+		{
+			// Length unknown or too large for a WAV image
+			BASS_StreamFree(hStream);
+			return {};
+		}
+		dataBytes -= dataBytes % frameBytes;
+
+		std::vector<std::uint8_t> image(kWAVHeaderSize + static_cast<std::size_t>(dataBytes));
+		WriteWAVHeader(image.data(), info.freq, static_cast<std::uint16_t>(info.chans), static_cast<std::uint32_t>(dataBytes));
+		std::uint8_t* const pData = image.data() + kWAVHeaderSize;
+
+		const double durationSec = BASS_ChannelBytes2Seconds(hStream, dataBytes);
+		std::size_t numChunks = 1U;
+		if (SupportsParallelDecode(info.ctype) && durationSec >= kMinParallelDecodeSec)
+		{
+			numChunks = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1U, kMaxDecodeThreads);
+		}
+
+		// Split into chunks aligned to the frame size
+		const std::uint64_t chunkBytes = (dataBytes / numChunks) / frameBytes * frameBytes;
+
+		// Note: Each worker opens its own decoder because a BASS channel cannot be decoded from multiple positions at once.
+		//       The first chunk is decoded in the calling thread with the stream opened above.
+		std::vector<std::thread> workers;
+		workers.reserve(numChunks - 1U);
+		std::atomic<bool> workerFailed = false;
+		for (std::size_t i = 1U; i < numChunks; ++i)
+		{
+			const std::uint64_t begin = chunkBytes * i;
+			const std::uint64_t end = (i == numChunks - 1U) ? dataBytes : chunkBytes * (i + 1U);
+			workers.emplace_back([&filePath, &workerFailed, pData, begin, end]
+			{
+				const HSTREAM hChunkStream = OpenDecodeStream(filePath);
+				if (hChunkStream == 0 || !BASS_ChannelSetPosition(hChunkStream, begin, BASS_POS_BYTE))
+				{
+					workerFailed = true;
+					BASS_StreamFree(hChunkStream);
+					return;
+				}
+				DecodeRange(hChunkStream, pData + begin, end - begin);
+				BASS_StreamFree(hChunkStream);
+			});
+		}
+
+		DecodeRange(hStream, pData, numChunks == 1U ? dataBytes : chunkBytes);
+		BASS_StreamFree(hStream);
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		if (workerFailed)
+		{
+			// Fall back to decoding the rest in a single thread
+			const HSTREAM hRestStream = OpenDecodeStream(filePath);
+			if (hRestStream == 0 || !BASS_ChannelSetPosition(hRestStream, chunkBytes, BASS_POS_BYTE))
+			{
+				BASS_StreamFree(hRestStream);
+				return {};
+			}
+			DecodeRange(hRestStream, pData + chunkBytes, dataBytes - chunkBytes);
+			BASS_StreamFree(hRestStream);
+		}
+
+		return ResampleWAVImage(std::move(image), info.freq, static_cast<std::uint16_t>(info.chans), pPeakBytes);
+	}
+
+	std::vector<std::uint8_t> DecodeSegmentToInMemoryWAV(const std::string& filePath, double offsetSec, double durationSec, const std::atomic<bool>* pCancel)
+	{
+		// Note: BASS_STREAM_PRESCAN is not specified here because it scans the whole file.
+		//       Seeking can be slightly inaccurate for some codecs, but it does not matter for previews.
+		const HSTREAM hStream = BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+		if (hStream == 0)
+		{
+			return {};
+		}
+
+		BASS_CHANNELINFO info;
+		BASS_ChannelGetInfo(hStream, &info);
+
+		const std::uint64_t frameBytes = info.chans * sizeof(float);
+		const QWORD lengthBytes = BASS_ChannelGetLength(hStream, BASS_POS_BYTE);
+		std::uint64_t beginBytes = BASS_ChannelSeconds2Bytes(hStream, std::max(offsetSec, 0.0));
+		std::uint64_t dataBytes = BASS_ChannelSeconds2Bytes(hStream, std::max(durationSec, 0.0));
+		if (frameBytes == 0U || (lengthBytes != static_cast<QWORD>(-1) && beginBytes >= lengthBytes))
+		{
+			BASS_StreamFree(hStream);
+			return {};
+		}
+		if (lengthBytes != static_cast<QWORD>(-1))
+		{
+			dataBytes = std::min<std::uint64_t>(dataBytes, lengthBytes - beginBytes);
+		}
+		dataBytes -= dataBytes % frameBytes;
+		if (dataBytes == 0U || dataBytes > UINT32_MAX - kWAVHeaderSize || (beginBytes > 0U && !BASS_ChannelSetPosition(hStream, beginBytes, BASS_POS_BYTE)))
+		{
+			BASS_StreamFree(hStream);
+			return {};
+		}
+
+		std::vector<std::uint8_t> image(kWAVHeaderSize + static_cast<std::size_t>(dataBytes));
+		WriteWAVHeader(image.data(), info.freq, static_cast<std::uint16_t>(info.chans), static_cast<std::uint32_t>(dataBytes));
+		const bool completed = DecodeRange(hStream, image.data() + kWAVHeaderSize, dataBytes, pCancel);
+		BASS_StreamFree(hStream);
+
+		if (!completed)
+		{
+			return {};
+		}
+		return ResampleWAVImage(std::move(image), info.freq, static_cast<std::uint16_t>(info.chans), nullptr);
+	}
+}
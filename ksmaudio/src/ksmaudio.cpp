@@ -12,6 +12,12 @@ namespace ksmaudio
 		BASS_SetConfig(BASS_CONFIG_UPDATETHREADS, kUpdateThreads);
 	}
 
+	void InitHeadless()
+	{
+		BASS_Init(0/* no sound */, kSampleRate, 0, nullptr, nullptr);
+		BASS_SetConfig(BASS_CONFIG_FLOATDSP, TRUE);
+	}
+
 	void Terminate()
 	{
 		BASS_Free();
@@ -0,0 +1,269 @@
+﻿#include "ksmaudio/resampler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define KSMAUDIO_RESAMPLER_SSE
+#endif
+
+namespace ksmaudio
+{
+	namespace
+	{
+		struct QualityPreset
+		{
+			std::size_t numTaps;
+
+			// Kaiser window parameter
+			double beta;
+
+			// Cutoff frequency relative to the lower Nyquist frequency
+			double rolloff;
+		};
+
+		constexpr QualityPreset kQualityPresets[] = {
+			{ .numTaps = 16U, .beta = 5.0, .rolloff = 0.88 }, // kLow
+			{ .numTaps = 32U, .beta = 7.0, .rolloff = 0.92 }, // kMedium
+			{ .numTaps = 64U, .beta = 9.0, .rolloff = 0.95 }, // kHigh
+		};
+
+		std::atomic<ResamplerQuality> s_quality = ResamplerQuality::kMedium;
+
+		const QualityPreset& GetPreset(ResamplerQuality quality)
+		{
+			const auto idx = std::clamp(static_cast<std::size_t>(quality), std::size_t{ 0U }, std::size(kQualityPresets) - 1U);
+			return kQualityPresets[idx];
+		}
+
+		// Zeroth-order modified Bessel function of the first kind
+		double BesselI0(double x)
+		{
+			double sum = 1.0;
+			double term = 1.0;
+			for (int k = 1; k < 32; ++k)
+			{
+				term *= (x / (2.0 * k)) * (x / (2.0 * k));
+				sum += term;
+				if (term < sum * 1e-12)
+				{
+					break;
+				}
+			}
+			return sum;
+		}
+
+		double Sinc(double x)
+		{
+			if (std::abs(x) < 1e-9)
+			{
+				return 1.0;
+			}
+			return std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+		}
+
+		// Dot product of the source samples and two adjacent phases of the coefficients, interpolated by t
+		float InterpolatedDot(const float* pSrc, const float* pCoefs0, const float* pCoefs1, std::size_t numTaps, float t)
+		{
+#ifdef KSMAUDIO_RESAMPLER_SSE
+			// Note: numTaps is always a multiple of 8
+			__m128 sum0a = _mm_setzero_ps();
+			__m128 sum0b = _mm_setzero_ps();
+			__m128 sum1a = _mm_setzero_ps();
+			__m128 sum1b = _mm_setzero_ps();
+			for (std::size_t i = 0U; i < numTaps; i += 8U)
+			{
+				const __m128 srcA = _mm_loadu_ps(pSrc + i);
+				const __m128 srcB = _mm_loadu_ps(pSrc + i + 4U);
+				sum0a = _mm_add_ps(sum0a, _mm_mul_ps(srcA, _mm_loadu_ps(pCoefs0 + i)));
+				sum0b = _mm_add_ps(sum0b, _mm_mul_ps(srcB, _mm_loadu_ps(pCoefs0 + i + 4U)));
+				sum1a = _mm_add_ps(sum1a, _mm_mul_ps(srcA, _mm_loadu_ps(pCoefs1 + i)));
+				sum1b = _mm_add_ps(sum1b, _mm_mul_ps(srcB, _mm_loadu_ps(pCoefs1 + i + 4U)));
+			}
+			const __m128 sum0 = _mm_add_ps(sum0a, sum0b);
+			const __m128 sum1 = _mm_add_ps(sum1a, sum1b);
+			const __m128 tv = _mm_set1_ps(t);
+			__m128 sum = _mm_add_ps(sum0, _mm_mul_ps(_mm_sub_ps(sum1, sum0), tv));
+
+			// Horizontal add
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+			return _mm_cvtss_f32(sum);
+#else
+			float sum0 = 0.0f;
+			float sum1 = 0.0f;
+			for (std::size_t i = 0U; i < numTaps; ++i)
+			{
+				sum0 += pSrc[i] * pCoefs0[i];
+				sum1 += pSrc[i] * pCoefs1[i];
+			}
+			return sum0 + (sum1 - sum0) * t;
+#endif
+		}
+
+		std::vector<float> GenerateSine(double freq, std::uint32_t sampleRate, std::size_t numFrames)
+		{
+			std::vector<float> data(numFrames);
+			for (std::size_t i = 0U; i < numFrames; ++i)
+			{
+				data[i] = static_cast<float>(std::sin(2.0 * std::numbers::pi * freq * static_cast<double>(i) / sampleRate));
+			}
+			return data;
+		}
+
+		double RMS(const float* pData, std::size_t size)
+		{
+			double sum = 0.0;
+			for (std::size_t i = 0U; i < size; ++i)
+			{
+				sum += static_cast<double>(pData[i]) * pData[i];
+			}
+			return size > 0U ? std::sqrt(sum / size) : 0.0;
+		}
+	}
+
+	PolyphaseResampler::PolyphaseResampler(std::uint32_t srcRate, std::uint32_t dstRate, ResamplerQuality quality)
+		: m_srcRate(srcRate)
+		, m_dstRate(dstRate)
+		, m_numTaps(GetPreset(quality).numTaps)
+		, m_coefs((kNumPhases + 1U) * m_numTaps)
+	{
+		const QualityPreset& preset = GetPreset(quality);
+
+		// Normalized cutoff frequency (1.0 = Nyquist frequency of the source)
+		const double cutoff = std::min(1.0, static_cast<double>(dstRate) / srcRate) * preset.rolloff;
+		const double halfTaps = static_cast<double>(m_numTaps / 2U);
+		const double i0Beta = BesselI0(preset.beta);
+		for (std::size_t phase = 0U; phase <= kNumPhases; ++phase)
+		{
+			float* pRow = m_coefs.data() + phase * m_numTaps;
+			const double frac = static_cast<double>(phase) / kNumPhases;
+			double sum = 0.0;
+			for (std::size_t k = 0U; k < m_numTaps; ++k)
+			{
+				// Distance from the output position to the source sample
+				const double d = (halfTaps - 1.0 - static_cast<double>(k)) + frac;
+				const double u = d / halfTaps;
+				const double window = std::abs(u) < 1.0 ? BesselI0(preset.beta * std::sqrt(1.0 - u * u)) / i0Beta : 0.0;
+				const double coef = cutoff * Sinc(cutoff * d) * window;
+				pRow[k] = static_cast<float>(coef);
+				sum += coef;
+			}
+
+			// Normalize the DC gain of each phase to 1
+			if (sum != 0.0)
+			{
+				for (std::size_t k = 0U; k < m_numTaps; ++k)
+				{
+					pRow[k] = static_cast<float>(pRow[k] / sum);
+				}
+			}
+		}
+	}
+
+	void PolyphaseResampler::processChannel(const float* pPaddedSrc, float* pDst, std::size_t numDstFrames, std::size_t dstStride) const
+	{
+		// Note: The source position of each output frame is computed with integers, so that no error is accumulated.
+		for (std::size_t i = 0U; i < numDstFrames; ++i)
+		{
+			const std::uint64_t num = static_cast<std::uint64_t>(i) * m_srcRate;
+			const std::size_t srcIdx = static_cast<std::size_t>(num / m_dstRate);
+			const double phasePos = static_cast<double>(num % m_dstRate) * kNumPhases / m_dstRate;
+			const std::size_t phase = std::min(static_cast<std::size_t>(phasePos), kNumPhases - 1U);
+			const float t = static_cast<float>(phasePos - static_cast<double>(phase));
+			const float* pCoefs0 = m_coefs.data() + phase * m_numTaps;
+			pDst[i * dstStride] = InterpolatedDot(pPaddedSrc + srcIdx, pCoefs0, pCoefs0 + m_numTaps, m_numTaps, t);
+		}
+	}
+
+	std::size_t PolyphaseResampler::numOutputFrames(std::size_t numSrcFrames) const
+	{
+		return static_cast<std::size_t>((static_cast<std::uint64_t>(numSrcFrames) * m_dstRate + m_srcRate - 1U) / m_srcRate);
+	}
+
+	std::vector<float> PolyphaseResampler::processInterleaved(const float* pSrc, std::size_t numSrcFrames, std::size_t numChannels) const
+	{
+		std::vector<float> dst(numOutputFrames(numSrcFrames) * numChannels);
+		processInterleaved(pSrc, numSrcFrames, numChannels, dst.data());
+		return dst;
+	}
+
+	void PolyphaseResampler::processInterleaved(const float* pSrc, std::size_t numSrcFrames, std::size_t numChannels, float* pDst) const
+	{
+		const std::size_t numDstFrames = numOutputFrames(numSrcFrames);
+
+		// Deinterleave each channel into a zero-padded buffer so that the filter can read beyond both ends
+		const std::size_t padding = m_numTaps / 2U;
+		std::vector<float> padded(numSrcFrames + m_numTaps);
+		for (std::size_t ch = 0U; ch < numChannels; ++ch)
+		{
+			std::fill(padded.begin(), padded.end(), 0.0f);
+			for (std::size_t i = 0U; i < numSrcFrames; ++i)
+			{
+				padded[padding + i] = pSrc[i * numChannels + ch];
+			}
+
+			// The first tap corresponds to (srcIdx - padding + 1)
+			processChannel(padded.data() + 1U, pDst + ch, numDstFrames, numChannels);
+		}
+	}
+
+	std::size_t PolyphaseResampler::workBytes(std::size_t numSrcFrames) const
+	{
+		return (numSrcFrames + m_numTaps) * sizeof(float);
+	}
+
+	ResamplerBenchmarkResult BenchmarkResampler(std::uint32_t srcRate, std::uint32_t dstRate, ResamplerQuality quality, double durationSec)
+	{
+		const PolyphaseResampler resampler(srcRate, dstRate, quality);
+		const std::size_t numSrcFrames = static_cast<std::size_t>(durationSec * srcRate);
+		ResamplerBenchmarkResult result;
+
+		// Speed and accuracy in the passband
+		{
+			constexpr double kTestFreq = 1000.0;
+			const std::vector<float> src = GenerateSine(kTestFreq, srcRate, numSrcFrames);
+			const auto beginTime = std::chrono::steady_clock::now();
+			const std::vector<float> dst = resampler.processInterleaved(src.data(), src.size(), 1U);
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - beginTime;
+			result.realtimeFactor = elapsed.count() > 0.0 ? durationSec / elapsed.count() : 0.0;
+
+			// Compare with the ideal sine wave (excluding both ends affected by the zero padding)
+			const std::vector<float> expected = GenerateSine(kTestFreq, dstRate, dst.size());
+			const std::size_t margin = std::min<std::size_t>(dstRate / 10U, dst.size() / 4U);
+			std::vector<float> error(dst.size() - margin * 2U);
+			for (std::size_t i = 0U; i < error.size(); ++i)
+			{
+				error[i] = dst[margin + i] - expected[margin + i];
+			}
+			const double errorRMS = RMS(error.data(), error.size());
+			const double signalRMS = RMS(expected.data() + margin, error.size());
+			result.snrDB = errorRMS > 0.0 ? 20.0 * std::log10(signalRMS / errorRMS) : 200.0;
+		}
+
+		// Aliasing of a tone between the output and the source Nyquist frequencies
+		if (srcRate > dstRate)
+		{
+			const double aliasFreq = (srcRate + dstRate) / 4.0;
+			const std::vector<float> src = GenerateSine(aliasFreq, srcRate, numSrcFrames);
+			const std::vector<float> dst = resampler.processInterleaved(src.data(), src.size(), 1U);
+			const double outRMS = RMS(dst.data(), dst.size());
+			const double inRMS = RMS(src.data(), src.size());
+			result.aliasRejectionDB = outRMS > 0.0 ? 20.0 * std::log10(inRMS / outRMS) : 200.0;
+		}
+
+		return result;
+	}
+
+	void SetResamplerQuality(ResamplerQuality quality)
+	{
+		s_quality.store(quality);
+	}
+
+	ResamplerQuality GetResamplerQuality()
+	{
+		return s_quality.load();
+	}
+}
@@ -0,0 +1,259 @@
+#include "ksmaudio/se_mixer.hpp"
+#include <algorithm>
+#include <cstring>
+#include "ksmaudio/resampler.hpp"
+
+namespace ksmaudio
+{
+	namespace
+	{
+		constexpr DWORD kDecodeBlockBytes = 1U << 16;
+
+		// Decodes the whole file into interleaved stereo PCM at the specified sample rate
+		std::vector<float> DecodeToStereoPCM(const std::string& filePath, std::size_t sampleRate)
+		{
+			const HSTREAM hStream = BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+			if (hStream == 0)
+			{
+				return {};
+			}
+
+			BASS_CHANNELINFO info;
+			BASS_ChannelGetInfo(hStream, &info);
+			if (info.chans == 0U || info.freq == 0U)
+			{
+				BASS_StreamFree(hStream);
+				return {};
+			}
+
+			std::vector<float> source;
+			std::vector<float> block(kDecodeBlockBytes / sizeof(float));
+			while (true)
+			{
+				const DWORD readBytes = BASS_ChannelGetData(hStream, block.data(), kDecodeBlockBytes);
+				if (readBytes == static_cast<DWORD>(-1) || readBytes == 0U)
+				{
+					break;
+				}
+				source.insert(source.end(), block.begin(), block.begin() + readBytes / sizeof(float));
+			}
+			BASS_StreamFree(hStream);
+
+			// Convert to stereo (mono is duplicated, channels after the second are discarded)
+			const std::size_t numSourceFrames = source.size() / info.chans;
+			std::vector<float> stereo(numSourceFrames * SEMixer::kNumOutputChannels);
+			for (std::size_t i = 0U; i < numSourceFrames; ++i)
+			{
+				stereo[i * 2U] = source[i * info.chans];
+				stereo[i * 2U + 1U] = source[i * info.chans + (info.chans >= 2U ? 1U : 0U)];
+			}
+
+			if (info.freq == sampleRate || numSourceFrames == 0U)
+			{
+				return stereo;
+			}
+
+			const PolyphaseResampler resampler(info.freq, static_cast<std::uint32_t>(sampleRate), GetResamplerQuality());
+			return resampler.processInterleaved(stereo.data(), numSourceFrames, SEMixer::kNumOutputChannels);
+		}
+	}
+
+	DWORD CALLBACK SEMixer::StreamProc(HSTREAM handle, void* buffer, DWORD length, void* user)
+	{
+		const auto pMixer = reinterpret_cast<SEMixer*>(user);
+		const auto pData = reinterpret_cast<float*>(buffer);
+		pMixer->mix(pData, length / sizeof(float) / kNumOutputChannels);
+		return length;
+	}
+
+	void SEMixer::startVoice(const PlayCommand& command, std::size_t delayFrames)
+	{
+		// Find a free voice, or steal the voice playing for the longest time
+		Voice* pVoice = nullptr;
+		for (auto& voice : m_voices)
+		{
+			if (voice.soundID == kInvalidSoundID)
+			{
+				pVoice = &voice;
+				break;
+			}
+			if (pVoice == nullptr || voice.frameIdx > pVoice->frameIdx)
+			{
+				pVoice = &voice;
+			}
+		}
+
+		if (pVoice == nullptr) [[unlikely]]
+		{
+			return;
+		}
+
+		if (pVoice->soundID != kInvalidSoundID)
+		{
+			m_numStolenVoices.fetch_add(1U, std::memory_order_relaxed);
+		}
+
+		pVoice->soundID = command.soundID;
+		pVoice->frameIdx = 0U;
+		pVoice->gain = command.gain;
+		pVoice->delayFrames = delayFrames;
+	}
+
+	void SEMixer::mix(float* pData, std::size_t numFrames)
+	{
+		std::memset(pData, 0, numFrames * kNumOutputChannels * sizeof(float));
+
+		const std::uint64_t blockBeginFrame = m_renderedFrames;
+		const std::uint64_t blockEndFrame = blockBeginFrame + numFrames;
+		m_renderedFrames = blockEndFrame;
+
+		// Receive play commands from the main thread
+		std::size_t head = m_commandQueueHead.load(std::memory_order_relaxed);
+		const std::size_t tail = m_commandQueueTail.load(std::memory_order_acquire);
+		while (head != tail)
+		{
+			if (m_scheduledCommands.size() < kMaxScheduledCommands)
+			{
+				m_scheduledCommands.push_back(m_commandQueue[head]);
+			}
+			head = (head + 1U) % kCommandQueueSize;
+		}
+		m_commandQueueHead.store(head, std::memory_order_release);
+
+		// Start the voices scheduled within this block
+		for (std::size_t i = 0U; i < m_scheduledCommands.size();)
+		{
+			const PlayCommand& command = m_scheduledCommands[i];
+			if (command.startFrame >= blockEndFrame)
+			{
+				++i;
+				continue;
+			}
+
+			const std::size_t delayFrames = command.startFrame > blockBeginFrame ? static_cast<std::size_t>(command.startFrame - blockBeginFrame) : 0U;
+			startVoice(command, delayFrames);
+			m_scheduledCommands[i] = m_scheduledCommands.back();
+			m_scheduledCommands.pop_back();
+		}
+
+		for (auto& voice : m_voices)
+		{
+			if (voice.soundID == kInvalidSoundID)
+			{
+				continue;
+			}
+
+			const std::size_t delayFrames = std::min(voice.delayFrames, numFrames);
+			voice.delayFrames = 0U;
+
+			const std::vector<float>& sound = m_sounds[static_cast<std::size_t>(voice.soundID)];
+			const std::size_t numSoundFrames = sound.size() / kNumOutputChannels;
+			const std::size_t numMixFrames = std::min(numFrames - delayFrames, numSoundFrames - voice.frameIdx);
+			const float* pSrc = sound.data() + voice.frameIdx * kNumOutputChannels;
+			float* pDst = pData + delayFrames * kNumOutputChannels;
+			for (std::size_t i = 0U; i < numMixFrames * kNumOutputChannels; ++i)
+			{
+				pDst[i] += pSrc[i] * voice.gain;
+			}
+
+			voice.frameIdx += numMixFrames;
+			if (voice.frameIdx >= numSoundFrames)
+			{
+				voice.soundID = kInvalidSoundID;
+			}
+		}
+	}
+
+	SEMixer::SEMixer(std::size_t sampleRate, std::size_t numVoices, bool decodeOnly)
+		: m_sampleRate(sampleRate)
+		, m_voices(numVoices)
+	{
+		m_sounds.reserve(kMaxSounds);
+		m_scheduledCommands.reserve(kMaxScheduledCommands);
+
+		m_hStream = BASS_StreamCreate(static_cast<DWORD>(sampleRate), static_cast<DWORD>(kNumOutputChannels), BASS_SAMPLE_FLOAT | (decodeOnly ? BASS_STREAM_DECODE : 0), StreamProc, this);
+		if (!decodeOnly)
+		{
+			BASS_ChannelPlay(m_hStream, FALSE);
+		}
+	}
+
+	SEMixer::~SEMixer()
+	{
+		BASS_StreamFree(m_hStream);
+	}
+
+	SEMixer::SoundID SEMixer::loadSound(const std::string& filePath)
+	{
+		if (m_sounds.size() >= kMaxSounds)
+		{
+			return kInvalidSoundID;
+		}
+
+		std::vector<float> pcm = DecodeToStereoPCM(filePath, m_sampleRate);
+		if (pcm.empty())
+		{
+			return kInvalidSoundID;
+		}
+
+		// Note: The audio thread reads only the sounds referenced by the play commands,
+		//       which are published after this push_back through the command queue.
+		m_sounds.push_back(std::move(pcm));
+		return static_cast<SoundID>(m_sounds.size() - 1U);
+	}
+
+	void SEMixer::play(SoundID soundID, float gain)
+	{
+		playAt(soundID, 0U, gain);
+	}
+
+	void SEMixer::playAt(SoundID soundID, std::uint64_t startFrame, float gain)
+	{
+		if (soundID < 0 || static_cast<std::size_t>(soundID) >= m_sounds.size())
+		{
+			return;
+		}
+
+		const std::size_t tail = m_commandQueueTail.load(std::memory_order_relaxed);
+		const std::size_t nextTail = (tail + 1U) % kCommandQueueSize;
+		if (nextTail == m_commandQueueHead.load(std::memory_order_acquire))
+		{
+			// Queue is full (should not happen unless the audio thread stalls)
+			return;
+		}
+
+		m_commandQueue[tail] = { .soundID = soundID, .gain = gain, .startFrame = startFrame };
+		m_commandQueueTail.store(nextTail, std::memory_order_release);
+	}
+
+	std::uint64_t SEMixer::playbackFrame() const
+	{
+		const QWORD posBytes = BASS_ChannelGetPosition(m_hStream, BASS_POS_BYTE);
+		if (posBytes == static_cast<QWORD>(-1))
+		{
+			return 0U;
+		}
+		return posBytes / (kNumOutputChannels * sizeof(float));
+	}
+
+	std::size_t SEMixer::decode(float* pBuffer, std::size_t numFrames)
+	{
+		// Note: BASS calls StreamProc() on this thread to render the data returned here
+		const DWORD readBytes = BASS_ChannelGetData(m_hStream, pBuffer, static_cast<DWORD>(numFrames * kNumOutputChannels * sizeof(float)));
+		if (readBytes == static_cast<DWORD>(-1))
+		{
+			return 0U;
+		}
+		return readBytes / sizeof(float) / kNumOutputChannels;
+	}
+
+	std::size_t SEMixer::sampleRate() const
+	{
+		return m_sampleRate;
+	}
+
+	std::uint64_t SEMixer::numStolenVoices() const
+	{
+		return m_numStolenVoices.load(std::memory_order_relaxed);
+	}
+}
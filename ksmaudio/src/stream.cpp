@@ -1,10 +1,43 @@
 #include "ksmaudio/stream.hpp"
+#include <climits>
+#include <algorithm>
+#include <cmath>
+#include "ksmaudio/ksmaudio.hpp"
+#include "ksmaudio/decoded_audio_cache.hpp"
 
 namespace
 {
-	HSTREAM LoadStream(const std::string& filePath)
+	HSTREAM LoadStream(const std::string& filePath, const std::shared_ptr<const ksmaudio::WAVImage>& preloadedWAV, DWORD flags = 0)
 	{
-		return BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_SAMPLE_FLOAT | BASS_STREAM_PRESCAN);
+		if (preloadedWAV != nullptr)
+		{
+			return BASS_StreamCreateFile(TRUE, preloadedWAV->data(), 0, preloadedWAV->size(), BASS_SAMPLE_FLOAT | flags);
+		}
+		return BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_SAMPLE_FLOAT | BASS_STREAM_PRESCAN | flags);
+	}
+
+	constexpr std::size_t kTimeStretchSourceBlockFrames = 4096U;
+
+	bool IsTimeStretched(double speed)
+	{
+		return std::abs(speed - 1.0) > 1e-6;
+	}
+
+	BASS_CHANNELINFO GetChannelInfo(HSTREAM hStream);
+
+	// Returns whether the file has a sample rate other than kSampleRate
+	bool NeedsResampling(const std::string& filePath)
+	{
+		const HSTREAM hStream = BASS_StreamCreateFile(FALSE, filePath.c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+		if (hStream == 0)
+		{
+			return false;
+		}
+
+		BASS_CHANNELINFO info;
+		BASS_ChannelGetInfo(hStream, &info);
+		BASS_StreamFree(hStream);
+		return info.freq != ksmaudio::kSampleRate;
 	}
 
 	BASS_CHANNELINFO GetChannelInfo(HSTREAM hStream)
@@ -14,20 +47,158 @@ namespace
 		return info;
 	}
 
-	void ProcessAudioEffect(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user)
+	double SecPerSample(const BASS_CHANNELINFO& info)
 	{
-		const auto pAudioEffect = reinterpret_cast<ksmaudio::AudioEffect::IAudioEffect*>(user);
+		if (info.freq == 0U || info.chans == 0U)
+		{
+			return 0.0;
+		}
+		return 1.0 / (static_cast<double>(info.freq) * info.chans);
+	}
+
+	void CALLBACK ProcessAudioEffect(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user)
+	{
+		const auto pContext = reinterpret_cast<const ksmaudio::Stream::DSPCallbackContext*>(user);
 		const auto pData = reinterpret_cast<float*>(buffer);
-		pAudioEffect->process(pData, length / sizeof(float));
+		const std::size_t dataSize = length / sizeof(float);
+		if (pContext->pLoadStats == nullptr)
+		{
+			pContext->pAudioEffect->process(pData, dataSize);
+			return;
+		}
+
+		const auto beginTime = std::chrono::steady_clock::now();
+		pContext->pAudioEffect->process(pData, dataSize);
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - beginTime;
+		pContext->pLoadStats->record(elapsed.count(), dataSize * pContext->secPerSample);
 	}
 }
 
 namespace ksmaudio
 {
+	Stream::TimeStretchContext::TimeStretchContext(HSTREAM hSourceStream, std::size_t numChannels, std::size_t sampleRate, double speed)
+		: hSourceStream(hSourceStream)
+		, timeStretcher(numChannels, sampleRate, speed)
+		, sourceBuffer(kTimeStretchSourceBlockFrames * numChannels)
+		, secPerSample(1.0 / (static_cast<double>(sampleRate) * numChannels))
+	{
+	}
+
+	Stream::TimeStretchContext::~TimeStretchContext()
+	{
+		BASS_StreamFree(hSourceStream);
+	}
+
+	namespace
+	{
+		std::unique_ptr<Stream::TimeStretchContext> CreateTimeStretchContext(const std::string& filePath, const std::shared_ptr<const WAVImage>& preloadedWAV, double speed)
+		{
+			if (!IsTimeStretched(speed))
+			{
+				return nullptr;
+			}
+
+			const HSTREAM hSourceStream = LoadStream(filePath, preloadedWAV, BASS_STREAM_DECODE);
+			if (hSourceStream == 0)
+			{
+				return nullptr;
+			}
+
+			const BASS_CHANNELINFO info = GetChannelInfo(hSourceStream);
+			return std::make_unique<Stream::TimeStretchContext>(hSourceStream, info.chans, info.freq, speed);
+		}
+
+		HSTREAM CreateTimeStretchStream(Stream::TimeStretchContext* pContext, STREAMPROC* proc, DWORD flags)
+		{
+			const BASS_CHANNELINFO info = GetChannelInfo(pContext->hSourceStream);
+			return BASS_StreamCreate(info.freq, info.chans, BASS_SAMPLE_FLOAT | flags, proc, pContext);
+		}
+	}
+
+	void CALLBACK Stream::BeginMarkerDSP(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user)
+	{
+		const auto pStream = reinterpret_cast<Stream*>(user);
+		pStream->m_blockBeginTime = std::chrono::steady_clock::now();
+	}
+
+	void CALLBACK Stream::EndMarkerDSP(HDSP handle, DWORD channel, void* buffer, DWORD length, void* user)
+	{
+		const auto pStream = reinterpret_cast<Stream*>(user);
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - pStream->m_blockBeginTime;
+		pStream->m_totalLoadStats.record(elapsed.count(), (length / sizeof(float)) * pStream->m_secPerSample);
+	}
+
+	DWORD CALLBACK Stream::TimeStretchStreamProc(HSTREAM handle, void* buffer, DWORD length, void* user)
+	{
+		const auto pContext = reinterpret_cast<TimeStretchContext*>(user);
+		const auto beginTime = std::chrono::steady_clock::now();
+
+		// Note: The audio thread must never wait for the main thread, so silence is output if seeking is in progress.
+		//       This rarely happens because the stream is paused during seeking.
+		std::unique_lock lock(pContext->mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+		{
+			std::fill_n(reinterpret_cast<float*>(buffer), length / sizeof(float), 0.0f);
+			return length;
+		}
+
+		TimeStretcher& timeStretcher = pContext->timeStretcher;
+		const std::size_t numChannels = pContext->sourceBuffer.size() / kTimeStretchSourceBlockFrames;
+		const auto pData = reinterpret_cast<float*>(buffer);
+		const std::size_t numFrames = length / sizeof(float) / numChannels;
+		std::size_t numWrittenFrames = timeStretcher.popOutput(pData, numFrames);
+		while (numWrittenFrames < numFrames)
+		{
+			if (pContext->isSourceEnded)
+			{
+				timeStretcher.flush();
+				const std::size_t numPoppedFrames = timeStretcher.popOutput(pData + numWrittenFrames * numChannels, numFrames - numWrittenFrames);
+				if (numPoppedFrames == 0U)
+				{
+					break;
+				}
+				numWrittenFrames += numPoppedFrames;
+				continue;
+			}
+
+			const std::size_t numReadFrames = std::clamp(timeStretcher.numInputFramesNeeded(), std::size_t{ 1U }, kTimeStretchSourceBlockFrames);
+			const DWORD readBytes = BASS_ChannelGetData(pContext->hSourceStream, pContext->sourceBuffer.data(), static_cast<DWORD>(numReadFrames * numChannels * sizeof(float)));
+			if (readBytes == static_cast<DWORD>(-1) || readBytes == 0U)
+			{
+				pContext->isSourceEnded = true;
+				continue;
+			}
+			timeStretcher.pushInput(pContext->sourceBuffer.data(), readBytes / sizeof(float) / numChannels);
+			numWrittenFrames += timeStretcher.popOutput(pData + numWrittenFrames * numChannels, numFrames - numWrittenFrames);
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - beginTime;
+		pContext->loadStats.record(elapsed.count(), numFrames * numChannels * pContext->secPerSample);
 
-	Stream::Stream(const std::string& filePath)
-		: m_hStream(LoadStream(filePath))
+		const DWORD writtenBytes = static_cast<DWORD>(numWrittenFrames * numChannels * sizeof(float));
+		return numWrittenFrames < numFrames ? (writtenBytes | BASS_STREAMPROC_END) : writtenBytes;
+	}
+
+	Stream::Stream(const std::string& filePath, bool preload, double speed, bool decodeOnly)
+		: m_preloadedWAV((preload || NeedsResampling(filePath)) ? DecodedAudioCache::Load(filePath) : nullptr)
+		, m_timeStretch(CreateTimeStretchContext(filePath, m_preloadedWAV, speed))
+		, m_hStream(m_timeStretch != nullptr
+			? CreateTimeStretchStream(m_timeStretch.get(), TimeStretchStreamProc, decodeOnly ? BASS_STREAM_DECODE : 0)
+			: LoadStream(filePath, m_preloadedWAV, decodeOnly ? BASS_STREAM_DECODE : 0))
 		, m_info(GetChannelInfo(m_hStream))
+		, m_secPerSample(SecPerSample(m_info))
+		, m_hBeginMarkerDSP(BASS_ChannelSetDSP(m_hStream, BeginMarkerDSP, this, INT_MAX)) // Note: DSPs with higher priority are called first
+		, m_hEndMarkerDSP(BASS_ChannelSetDSP(m_hStream, EndMarkerDSP, this, INT_MIN))
+	{
+	}
+
+	Stream::Stream(std::shared_ptr<const WAVImage> wavImage, bool loop)
+		: m_preloadedWAV(std::move(wavImage))
+		, m_hStream(m_preloadedWAV != nullptr ? LoadStream("", m_preloadedWAV, loop ? BASS_SAMPLE_LOOP : 0) : 0)
+		, m_info(GetChannelInfo(m_hStream))
+		, m_secPerSample(SecPerSample(m_info))
+		, m_hBeginMarkerDSP(BASS_ChannelSetDSP(m_hStream, BeginMarkerDSP, this, INT_MAX))
+		, m_hEndMarkerDSP(BASS_ChannelSetDSP(m_hStream, EndMarkerDSP, this, INT_MIN))
 	{
 	}
 
@@ -56,29 +227,104 @@ namespace ksmaudio
 		BASS_ChannelUpdate(m_hStream, 0);
 	}
 
+	std::size_t Stream::decode(float* pBuffer, std::size_t numFrames) const
+	{
+		const std::size_t numChannels = static_cast<std::size_t>(m_info.chans);
+		if (numChannels == 0U)
+		{
+			return 0U;
+		}
+
+		// Note: BASS applies the DSPs (i.e., all audio effects and the load measurement) to the data returned here
+		const DWORD readBytes = BASS_ChannelGetData(m_hStream, pBuffer, static_cast<DWORD>(numFrames * numChannels * sizeof(float)));
+		if (readBytes == static_cast<DWORD>(-1))
+		{
+			return 0U;
+		}
+		return readBytes / sizeof(float) / numChannels;
+	}
+
+	void Stream::setVolume(double volume) const
+	{
+		BASS_ChannelSetAttribute(m_hStream, BASS_ATTRIB_VOL, static_cast<float>(volume));
+	}
+
+	void Stream::fadeVolume(double volume, double durationSec) const
+	{
+		BASS_ChannelSlideAttribute(m_hStream, BASS_ATTRIB_VOL, static_cast<float>(volume), static_cast<DWORD>(durationSec * 1000));
+	}
+
+	bool Stream::isFadingVolume() const
+	{
+		return BASS_ChannelIsSliding(m_hStream, BASS_ATTRIB_VOL);
+	}
+
 	double Stream::posSec() const
 	{
-		return BASS_ChannelBytes2Seconds(m_hStream, BASS_ChannelGetPosition(m_hStream, BASS_POS_BYTE));
+		const double outputSec = BASS_ChannelBytes2Seconds(m_hStream, BASS_ChannelGetPosition(m_hStream, BASS_POS_BYTE));
+		if (m_timeStretch != nullptr)
+		{
+			return m_timeStretch->seekBaseSec + (outputSec - m_timeStretch->outputBaseSec) * m_timeStretch->timeStretcher.speed();
+		}
+		return outputSec;
 	}
 
 	void Stream::seekPosSec(double timeSec) const
 	{
-		BASS_ChannelSetPosition(m_hStream, BASS_ChannelSeconds2Bytes(m_hStream, timeSec), 0);
+		if (m_timeStretch == nullptr)
+		{
+			BASS_ChannelSetPosition(m_hStream, BASS_ChannelSeconds2Bytes(m_hStream, timeSec), 0);
+			return;
+		}
+
+		// Note: The user stream is paused during seeking so that the stream callback never reads the stretcher being reset
+		const bool wasPlaying = BASS_ChannelIsActive(m_hStream) == BASS_ACTIVE_PLAYING;
+		if (wasPlaying)
+		{
+			BASS_ChannelPause(m_hStream);
+		}
+		{
+			std::lock_guard lock(m_timeStretch->mutex);
+			BASS_ChannelSetPosition(m_timeStretch->hSourceStream, BASS_ChannelSeconds2Bytes(m_timeStretch->hSourceStream, timeSec), BASS_POS_BYTE);
+			m_timeStretch->timeStretcher.reset();
+			m_timeStretch->isSourceEnded = false;
+			m_timeStretch->seekBaseSec = timeSec;
+		}
+
+		// Flush the buffered output of the user stream
+		BASS_ChannelSetPosition(m_hStream, 0, BASS_POS_BYTE);
+		m_timeStretch->outputBaseSec = BASS_ChannelBytes2Seconds(m_hStream, BASS_ChannelGetPosition(m_hStream, BASS_POS_BYTE));
+		if (wasPlaying)
+		{
+			BASS_ChannelPlay(m_hStream, FALSE);
+		}
 	}
 
 	double Stream::durationSec() const
 	{
-		return BASS_ChannelBytes2Seconds(m_hStream, BASS_ChannelGetLength(m_hStream, BASS_POS_BYTE));
+		const HSTREAM hStream = m_timeStretch != nullptr ? m_timeStretch->hSourceStream : m_hStream;
+		return BASS_ChannelBytes2Seconds(hStream, BASS_ChannelGetLength(hStream, BASS_POS_BYTE));
 	}
 
-	HDSP Stream::addAudioEffect(AudioEffect::IAudioEffect* pAudioEffect, int priority) const
+	Stream::Handle Stream::addAudioEffect(AudioEffect::IAudioEffect* pAudioEffect, int priority, DSPLoadStats* pLoadStats)
 	{
-		return BASS_ChannelSetDSP(m_hStream, ProcessAudioEffect, pAudioEffect, priority);
+		auto context = std::make_unique<DSPCallbackContext>(DSPCallbackContext{
+			.pAudioEffect = pAudioEffect,
+			.pLoadStats = pLoadStats,
+			.secPerSample = m_secPerSample,
+		});
+		const HDSP hDSP = BASS_ChannelSetDSP(m_hStream, ProcessAudioEffect, context.get(), priority);
+		if (hDSP != 0)
+		{
+			m_dspCallbackContexts.emplace(hDSP, std::move(context));
+		}
+		return static_cast<Handle>(hDSP);
 	}
 
-	void Stream::removeAudioEffect(HDSP hDSP) const
+	void Stream::removeAudioEffect(Handle hDSP)
 	{
-		BASS_ChannelRemoveDSP(m_hStream, hDSP);
+		BASS_ChannelRemoveDSP(m_hStream, static_cast<HDSP>(hDSP));
+		m_dspCallbackContexts.erase(static_cast<HDSP>(hDSP));
 	}
 
 	std::size_t Stream::sampleRate() const
@@ -96,9 +342,40 @@ namespace ksmaudio
 		DWORD playbuf = BASS_ChannelGetData(m_hStream, NULL, BASS_DATA_AVAILABLE);
 		if (playbuf != (DWORD)-1)
 		{
-			return BASS_ChannelBytes2Seconds(m_hStream, playbuf);
+			// Note: The latency is converted into the source time if time-stretched
+			const double speed = m_timeStretch != nullptr ? m_timeStretch->timeStretcher.speed() : 1.0;
+			return BASS_ChannelBytes2Seconds(m_hStream, playbuf) * speed;
 		}
 		return 0.0; // TODO: return kBufferSizeMs
 	}
 
+	std::size_t Stream::preloadedBytes() const
+	{
+		return m_preloadedWAV != nullptr ? m_preloadedWAV->size() : 0U;
+	}
+
+	std::size_t Stream::preloadPeakBytes() const
+	{
+		return m_preloadedWAV != nullptr ? m_preloadedWAV->decodePeakBytes() : 0U;
+	}
+
+	const DSPLoadStats& Stream::totalLoadStats() const
+	{
+		return m_totalLoadStats;
+	}
+
+	const DSPLoadStats* Stream::timeStretchLoadStats() const
+	{
+		return m_timeStretch != nullptr ? &m_timeStretch->loadStats : nullptr;
+	}
+
+	void Stream::resetLoadStats()
+	{
+		m_totalLoadStats.reset();
+		if (m_timeStretch != nullptr)
+		{
+			m_timeStretch->loadStats.reset();
+		}
+	}
+
 }
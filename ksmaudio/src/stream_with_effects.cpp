@@ -3,8 +3,8 @@
 
 namespace ksmaudio
 {
-	StreamWithEffects::StreamWithEffects(const std::string& filePath)
-		: m_stream(filePath)
+	StreamWithEffects::StreamWithEffects(const std::string& filePath, bool preload, double speed, bool decodeOnly)
+		: m_stream(filePath, preload, speed, decodeOnly)
 	{
 	}
 
@@ -28,6 +28,11 @@ namespace ksmaudio
 		m_stream.updateManually();
 	}
 
+	std::size_t StreamWithEffects::decode(float* pBuffer, std::size_t numFrames) const
+	{
+		return m_stream.decode(pBuffer, numFrames);
+	}
+
 	double StreamWithEffects::posSec() const
 	{
 		return m_stream.posSec();
@@ -58,10 +63,51 @@ namespace ksmaudio
 		return m_stream.latencySec();
 	}
 
+	std::size_t StreamWithEffects::preloadedBytes() const
+	{
+		return m_stream.preloadedBytes();
+	}
+
+	std::size_t StreamWithEffects::preloadPeakBytes() const
+	{
+		return m_stream.preloadPeakBytes();
+	}
+
 	AudioEffect::AudioEffectBus* StreamWithEffects::emplaceAudioEffectBus()
 	{
 		// Note: It is intentional to return the internal raw pointer of unique_ptr here.
 		//       Management of the returned pointer is the responsibility of the caller.
 		return m_audioEffectBuses.emplace_back(std::make_unique<AudioEffect::AudioEffectBus>(&m_stream)).get();
 	}
+
+	DSPLoadSnapshot StreamWithEffects::totalLoadSnapshot() const
+	{
+		return m_stream.totalLoadStats().snapshot();
+	}
+
+	std::vector<std::pair<std::string, DSPLoadSnapshot>> StreamWithEffects::audioEffectLoadSnapshots() const
+	{
+		std::vector<std::pair<std::string, DSPLoadSnapshot>> snapshots;
+		if (const DSPLoadStats* pTimeStretchLoadStats = m_stream.timeStretchLoadStats())
+		{
+			snapshots.emplace_back("time_stretch", pTimeStretchLoadStats->snapshot());
+		}
+		for (std::size_t i = 0U; i < m_audioEffectBuses.size(); ++i)
+		{
+			for (auto& [name, snapshot] : m_audioEffectBuses[i]->loadSnapshots())
+			{
+				snapshots.emplace_back(std::to_string(i) + "/" + name, snapshot);
+			}
+		}
+		return snapshots;
+	}
+
+	void StreamWithEffects::resetLoadStats()
+	{
+		m_stream.resetLoadStats();
+		for (const auto& audioEffectBus : m_audioEffectBuses)
+		{
+			audioEffectBus->resetLoadStats();
+		}
+	}
 }
@@ -0,0 +1,269 @@
+﻿#include "ksmaudio/time_stretcher.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define KSMAUDIO_TIME_STRETCHER_SSE
+#endif
+
+namespace ksmaudio
+{
+	namespace
+	{
+		constexpr double kSegmentSec = 0.04;
+		constexpr double kSearchSec = 0.01;
+
+		// The offset is searched at this step first, and then refined around the best candidate
+		constexpr std::size_t kCoarseSearchStep = 4U;
+
+		float DotProduct(const float* pA, const float* pB, std::size_t size)
+		{
+			std::size_t i = 0U;
+			float sum = 0.0f;
+#ifdef KSMAUDIO_TIME_STRETCHER_SSE
+			__m128 sumA = _mm_setzero_ps();
+			__m128 sumB = _mm_setzero_ps();
+			for (; i + 8U <= size; i += 8U)
+			{
+				sumA = _mm_add_ps(sumA, _mm_mul_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i)));
+				sumB = _mm_add_ps(sumB, _mm_mul_ps(_mm_loadu_ps(pA + i + 4U), _mm_loadu_ps(pB + i + 4U)));
+			}
+			__m128 sumV = _mm_add_ps(sumA, sumB);
+			sumV = _mm_add_ps(sumV, _mm_movehl_ps(sumV, sumV));
+			sumV = _mm_add_ss(sumV, _mm_shuffle_ps(sumV, sumV, 0x55));
+			sum = _mm_cvtss_f32(sumV);
+#endif
+			for (; i < size; ++i)
+			{
+				sum += pA[i] * pB[i];
+			}
+			return sum;
+		}
+	}
+
+	TimeStretcher::TimeStretcher(std::size_t numChannels, std::size_t sampleRate, double speed)
+		: m_numChannels(numChannels)
+		, m_speed(speed)
+		, m_segmentFrames(static_cast<std::size_t>(kSegmentSec * sampleRate) / 2U * 2U)
+		, m_hopFrames(m_segmentFrames / 2U)
+		, m_searchFrames(static_cast<std::size_t>(kSearchSec * sampleRate))
+		, m_window(m_segmentFrames)
+		, m_inputCapacityFrames((m_segmentFrames + m_searchFrames * 2U) * 2U + static_cast<std::size_t>(std::ceil(m_hopFrames * speed)))
+		, m_outputCapacityFrames((static_cast<std::size_t>(std::ceil(m_inputCapacityFrames * 2U / std::max(m_hopFrames * speed, 1.0))) + 4U) * m_hopFrames)
+		, m_input(m_inputCapacityFrames * numChannels)
+		, m_inputMono(m_inputCapacityFrames)
+		, m_reference(m_hopFrames)
+		, m_overlapAdd(m_segmentFrames * numChannels)
+		, m_output(m_outputCapacityFrames * numChannels)
+	{
+		// Periodic Hann window (the sum of two windows overlapping by half is exactly 1)
+		for (std::size_t i = 0U; i < m_segmentFrames; ++i)
+		{
+			m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) / m_segmentFrames));
+		}
+		reset();
+	}
+
+	double TimeStretcher::nominalSegmentBeginFrame(std::uint64_t segmentIdx) const
+	{
+		// Note: The input starts with (m_searchFrames + m_hopFrames) frames of silence, so that this never goes below m_searchFrames.
+		//       The center of the segment is placed at (speed * center of the output segment).
+		const double padding = static_cast<double>(m_searchFrames + m_hopFrames);
+		return padding + static_cast<double>(segmentIdx * m_hopFrames) * m_speed - static_cast<double>(m_hopFrames) * (1.0 - m_speed);
+	}
+
+	std::size_t TimeStretcher::findBestOffset(std::size_t nominalIdx) const
+	{
+		if (!m_hasReference)
+		{
+			return nominalIdx;
+		}
+
+		const std::size_t minIdx = nominalIdx - std::min(nominalIdx, m_searchFrames);
+		const std::size_t maxIdx = nominalIdx + m_searchFrames;
+		const float referenceEnergy = DotProduct(m_reference.data(), m_reference.data(), m_hopFrames);
+		if (referenceEnergy <= 0.0f)
+		{
+			return nominalIdx;
+		}
+
+		// Normalized cross-correlation between the reference and the first half of the candidate segment
+		const auto similarity = [this](std::size_t idx)
+		{
+			const float* pCandidate = m_inputMono.data() + idx;
+			const float correlation = DotProduct(pCandidate, m_reference.data(), m_hopFrames);
+			const float energy = DotProduct(pCandidate, pCandidate, m_hopFrames);
+			return correlation / std::sqrt(energy + 1e-9f);
+		};
+
+		std::size_t bestIdx = nominalIdx;
+		float bestSimilarity = similarity(nominalIdx);
+		for (std::size_t idx = minIdx; idx <= maxIdx; idx += kCoarseSearchStep)
+		{
+			const float s = similarity(idx);
+			if (s > bestSimilarity)
+			{
+				bestSimilarity = s;
+				bestIdx = idx;
+			}
+		}
+
+		const std::size_t coarseBestIdx = bestIdx;
+		const std::size_t fineMinIdx = std::max(minIdx, coarseBestIdx - std::min(coarseBestIdx, kCoarseSearchStep - 1U));
+		const std::size_t fineMaxIdx = std::min(maxIdx, coarseBestIdx + kCoarseSearchStep - 1U);
+		for (std::size_t idx = fineMinIdx; idx <= fineMaxIdx; ++idx)
+		{
+			const float s = similarity(idx);
+			if (s > bestSimilarity)
+			{
+				bestSimilarity = s;
+				bestIdx = idx;
+			}
+		}
+		return bestIdx;
+	}
+
+	void TimeStretcher::processSegment()
+	{
+		const std::size_t nominalIdx = static_cast<std::size_t>(std::llround(nominalSegmentBeginFrame(m_segmentIdx)) - static_cast<long long>(m_inputBeginFrame));
+		const std::size_t idx = findBestOffset(nominalIdx);
+
+		// Overlap-add the windowed segment
+		const float* pSegment = m_input.data() + idx * m_numChannels;
+		for (std::size_t i = 0U; i < m_segmentFrames; ++i)
+		{
+			for (std::size_t ch = 0U; ch < m_numChannels; ++ch)
+			{
+				m_overlapAdd[i * m_numChannels + ch] += pSegment[i * m_numChannels + ch] * m_window[i];
+			}
+		}
+		std::copy_n(m_inputMono.begin() + idx + m_hopFrames, m_hopFrames, m_reference.begin());
+		m_hasReference = true;
+
+		// The first half is complete because no more segments overlap it
+		const std::size_t hopSamples = m_hopFrames * m_numChannels;
+		for (std::size_t i = 0U; i < m_hopFrames; ++i)
+		{
+			const std::size_t outputFrame = (m_outputReadFrame + m_numOutputFrames + i) % m_outputCapacityFrames;
+			std::copy_n(m_overlapAdd.begin() + i * m_numChannels, m_numChannels, m_output.begin() + outputFrame * m_numChannels);
+		}
+		m_numOutputFrames += m_hopFrames;
+		std::copy(m_overlapAdd.begin() + hopSamples, m_overlapAdd.end(), m_overlapAdd.begin());
+		std::fill(m_overlapAdd.begin() + hopSamples, m_overlapAdd.end(), 0.0f);
+
+		++m_segmentIdx;
+
+		// Discard the input that is no longer needed by the next search
+		const std::uint64_t nextMinFrame = static_cast<std::uint64_t>(nominalSegmentBeginFrame(m_segmentIdx)) - m_searchFrames;
+		if (nextMinFrame > m_inputBeginFrame)
+		{
+			const std::size_t numDiscarded = std::min(static_cast<std::size_t>(nextMinFrame - m_inputBeginFrame), m_numInputFrames);
+			std::copy(m_input.begin() + numDiscarded * m_numChannels, m_input.begin() + m_numInputFrames * m_numChannels, m_input.begin());
+			std::copy(m_inputMono.begin() + numDiscarded, m_inputMono.begin() + m_numInputFrames, m_inputMono.begin());
+			m_numInputFrames -= numDiscarded;
+			m_inputBeginFrame += numDiscarded;
+		}
+	}
+
+	void TimeStretcher::pushFrames(const float* pData, std::size_t numFrames)
+	{
+		const float monoScale = 1.0f / static_cast<float>(m_numChannels);
+		while (numFrames > 0U)
+		{
+			const std::size_t numCopied = std::min(numFrames, m_inputCapacityFrames - m_numInputFrames);
+			if (numCopied == 0U)
+			{
+				// Note: This does not happen as long as the output is read, because the capacities cover the range needed by a segment
+				break;
+			}
+
+			float* pInput = m_input.data() + m_numInputFrames * m_numChannels;
+			float* pInputMono = m_inputMono.data() + m_numInputFrames;
+			if (pData == nullptr)
+			{
+				std::fill_n(pInput, numCopied * m_numChannels, 0.0f);
+				std::fill_n(pInputMono, numCopied, 0.0f);
+			}
+			else
+			{
+				std::copy_n(pData, numCopied * m_numChannels, pInput);
+				for (std::size_t i = 0U; i < numCopied; ++i)
+				{
+					float sum = 0.0f;
+					for (std::size_t ch = 0U; ch < m_numChannels; ++ch)
+					{
+						sum += pData[i * m_numChannels + ch];
+					}
+					pInputMono[i] = sum * monoScale;
+				}
+				pData += numCopied * m_numChannels;
+			}
+			m_numInputFrames += numCopied;
+			numFrames -= numCopied;
+
+			while (numInputFramesNeeded() == 0U && m_outputCapacityFrames - m_numOutputFrames >= m_hopFrames)
+			{
+				processSegment();
+			}
+		}
+	}
+
+	void TimeStretcher::reset()
+	{
+		m_numInputFrames = m_searchFrames + m_hopFrames;
+		std::fill_n(m_input.begin(), m_numInputFrames * m_numChannels, 0.0f);
+		std::fill_n(m_inputMono.begin(), m_numInputFrames, 0.0f);
+		m_inputBeginFrame = 0U;
+		m_segmentIdx = 0U;
+		m_hasReference = false;
+		std::fill(m_overlapAdd.begin(), m_overlapAdd.end(), 0.0f);
+		m_outputReadFrame = 0U;
+		m_numOutputFrames = 0U;
+		m_isFlushed = false;
+	}
+
+	void TimeStretcher::pushInput(const float* pData, std::size_t numFrames)
+	{
+		pushFrames(pData, numFrames);
+	}
+
+	void TimeStretcher::flush()
+	{
+		if (m_isFlushed)
+		{
+			return;
+		}
+		m_isFlushed = true;
+
+		// Pad with silence so that the last segment is output
+		pushFrames(nullptr, m_segmentFrames + m_searchFrames * 2U);
+	}
+
+	std::size_t TimeStretcher::popOutput(float* pData, std::size_t maxFrames)
+	{
+		const std::size_t numFrames = std::min(maxFrames, m_numOutputFrames);
+
+		// Copy in two parts at most (before and after the wrap-around)
+		const std::size_t numFirstFrames = std::min(numFrames, m_outputCapacityFrames - m_outputReadFrame);
+		std::copy_n(m_output.begin() + m_outputReadFrame * m_numChannels, numFirstFrames * m_numChannels, pData);
+		std::copy_n(m_output.begin(), (numFrames - numFirstFrames) * m_numChannels, pData + numFirstFrames * m_numChannels);
+
+		m_outputReadFrame = (m_outputReadFrame + numFrames) % m_outputCapacityFrames;
+		m_numOutputFrames -= numFrames;
+		return numFrames;
+	}
+
+	std::size_t TimeStretcher::numInputFramesNeeded() const
+	{
+		// The whole search range of the next segment must be available
+		const std::uint64_t requiredEndFrame = static_cast<std::uint64_t>(std::ceil(nominalSegmentBeginFrame(m_segmentIdx))) + m_searchFrames + m_segmentFrames;
+		const std::uint64_t inputEndFrame = m_inputBeginFrame + m_numInputFrames;
+		return requiredEndFrame > inputEndFrame ? static_cast<std::size_t>(requiredEndFrame - inputEndFrame) : 0U;
+	}
+
+	double TimeStretcher::speed() const
+	{
+		return m_speed;
+	}
+}
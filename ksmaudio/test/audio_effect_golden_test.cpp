@@ -0,0 +1,260 @@
+// Golden tests of the audio effects
+//
+// Each case renders a fixed input signal through a DSP (or a chain of audio effects in AudioEffectBus) with fixed parameters,
+// and compares the output with the reference PCM checked in under test/reference.
+//
+// Usage:
+//   ksmaudio_audio_effect_test <reference dir> [case names...]               Compares with the references
+//   ksmaudio_audio_effect_test --regenerate <reference dir> [case names...]  Overwrites the references
+//
+// Note: The references are raw interleaved 32-bit float PCM (little-endian, stereo, kSampleRate).
+//       They must be regenerated (and the diff reviewed by listening) whenever the output of a DSP is changed intentionally.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ksmaudio/audio_effect/all.hpp"
+#include "ksmaudio/audio_effect/audio_effect_bus.hpp"
+#include "test_runner.hpp"
+
+namespace
+{
+	using namespace ksmaudio;
+	using namespace ksmaudio::AudioEffect;
+
+	constexpr std::size_t kSampleRate = 44100U;
+	constexpr std::size_t kNumChannels = 2U;
+	constexpr std::size_t kNumFrames = kSampleRate / 2U; // 0.5 sec
+	constexpr std::size_t kBlockFrames = 512U;
+	constexpr float kBPM = 120.0f;
+
+	// Maximum absolute difference allowed per sample (about -80 dBFS)
+	// Note: The output is not bit-exact across compilers and math libraries (e.g., std::sin, FMA contraction), so a small tolerance is needed.
+	constexpr float kTolerance = 1e-4f;
+
+	// Two tones (different in each channel) and low-level white noise from a fixed LCG
+	std::vector<float> GenerateInput()
+	{
+		std::vector<float> data(kNumFrames * kNumChannels);
+		std::uint32_t seed = 12345U;
+		for (std::size_t i = 0U; i < kNumFrames; ++i)
+		{
+			const double t = static_cast<double>(i) / kSampleRate;
+			seed = seed * 1664525U + 1013904223U;
+			const float noise = (static_cast<float>(seed >> 8) / static_cast<float>(1U << 24) - 0.5f) * 0.1f;
+			data[i * kNumChannels] = static_cast<float>(0.5 * std::sin(2.0 * 3.141592653589793 * 220.0 * t)) + noise;
+			data[i * kNumChannels + 1U] = static_cast<float>(0.4 * std::sin(2.0 * 3.141592653589793 * 330.0 * t)) - noise;
+		}
+		return data;
+	}
+
+	// Processes the input in fixed-size blocks (the first block is processed with isFirstBlock = true)
+	void ProcessInBlocks(std::vector<float>& data, const std::function<void(float*, std::size_t, std::size_t)>& processBlock)
+	{
+		for (std::size_t frame = 0U; frame < kNumFrames; frame += kBlockFrames)
+		{
+			const std::size_t numFrames = std::min(kBlockFrames, kNumFrames - frame);
+			processBlock(data.data() + frame * kNumChannels, numFrames * kNumChannels, frame);
+		}
+	}
+
+	// Runs DSP::process directly with fixed DSP parameters
+	// Note: secUntilTrigger (if any) is 0 in the first block so that the trigger fires at the beginning, and negative (ignored) afterwards.
+	template <typename DSP, typename DSPParams>
+	std::vector<float> RenderDSP(DSPParams params)
+	{
+		std::vector<float> data = GenerateInput();
+		DSP dsp(DSPCommonInfo{ kSampleRate, kNumChannels });
+		ProcessInBlocks(data, [&](float* pData, std::size_t dataSize, std::size_t frame)
+		{
+			DSPParams blockParams = params;
+			if constexpr (requires { blockParams.secUntilTrigger; })
+			{
+				blockParams.secUntilTrigger = (frame == 0U) ? 0.0f : -1.0f;
+			}
+			dsp.process(pData, dataSize, false, blockParams);
+		});
+		return data;
+	}
+
+	// Runs audio effects attached to it in the order of addition without BASS
+	class OfflineHost : public IAudioEffectHost
+	{
+	private:
+		std::vector<std::pair<Handle, IAudioEffect*>> m_audioEffects;
+		Handle m_nextHandle = 1U;
+
+	public:
+		virtual std::size_t sampleRate() const override
+		{
+			return kSampleRate;
+		}
+
+		virtual std::size_t numChannels() const override
+		{
+			return kNumChannels;
+		}
+
+		virtual Handle addAudioEffect(IAudioEffect* pAudioEffect, int, DSPLoadStats*) override
+		{
+			m_audioEffects.emplace_back(m_nextHandle, pAudioEffect);
+			return m_nextHandle++;
+		}
+
+		virtual void removeAudioEffect(Handle handle) override
+		{
+			std::erase_if(m_audioEffects, [handle](const auto& pair) { return pair.first == handle; });
+		}
+
+		void process(float* pData, std::size_t dataSize)
+		{
+			for (const auto& [handle, pAudioEffect] : m_audioEffects)
+			{
+				pAudioEffect->process(pData, dataSize);
+			}
+		}
+	};
+
+	// Runs all audio effects in a single AudioEffectBus, turning them on and off and sweeping the laser value
+	std::vector<float> RenderBusChain()
+	{
+		std::vector<float> data = GenerateInput();
+		OfflineHost host;
+		{
+			AudioEffectBus bus(&host);
+			bus.emplaceAudioEffect<Retrigger>("retrigger", { { "wave_length", "1/8" }, { "update_period", "1/4" } });
+			bus.emplaceAudioEffect<Gate>("gate", { { "wave_length", "1/16" } });
+			bus.emplaceAudioEffect<Flanger>("flanger", { { "period", "1/4" } }, { { "feedback", { { 0.25f, "30%" } } } });
+			bus.emplaceAudioEffect<Bitcrusher>("bitcrusher", { { "reduction", "0samples-20samples" } });
+			bus.emplaceAudioEffect<Wobble>("wobble", { { "wave_length", "1/12" } }, {}, { 0.3f });
+
+			ProcessInBlocks(data, [&](float* pData, std::size_t dataSize, std::size_t frame)
+			{
+				const float sec = static_cast<float>(frame) / kSampleRate;
+				const Status status{ .v = sec * 2.0f, .bpm = kBPM, .sec = sec };
+
+				// Switch the active audio effects every 0.125 sec
+				std::unordered_map<std::string, ParamValueSetDict> activeAudioEffects;
+				switch (static_cast<int>(sec / 0.125f))
+				{
+				case 0:
+					activeAudioEffects.emplace("retrigger", ParamValueSetDict{});
+					break;
+				case 1:
+					activeAudioEffects.emplace("gate", ParamValueSetDict{});
+					activeAudioEffects.emplace("bitcrusher", ParamValueSetDict{});
+					break;
+				case 2:
+					activeAudioEffects.emplace("flanger", ParamValueSetDict{});
+					activeAudioEffects.emplace("wobble", ParamValueSetDict{});
+					break;
+				default:
+					activeAudioEffects.emplace("bitcrusher", ParamValueSetDict{ { ParamID::kMix, ValueSet{ .off = 0.0f, .onMin = 0.5f, .onMax = 0.5f } } });
+					break;
+				}
+
+				bus.update(status, activeAudioEffects);
+				host.process(pData, dataSize);
+			});
+		}
+		return data;
+	}
+
+	const TestRunner::CaseTable<std::function<std::vector<float>()>> kCases = {
+		{ "retrigger", [] { return RenderDSP<RetriggerDSP>(RetriggerDSPParams{ .waveLength = 0.125f, .rate = 0.7f, .mix = 1.0f }); } },
+		{ "gate", [] { return RenderDSP<GateDSP>(GateDSPParams{ .waveLength = 0.0625f, .rate = 0.5f, .mix = 0.9f }); } },
+		{ "flanger", [] { return RenderDSP<FlangerDSP>(FlangerDSPParams{ .period = 0.5f, .delay = 30.0f, .depth = 45.0f, .feedback = 0.6f, .stereoWidth = 0.2f, .vol = 0.75f, .mix = 0.8f }); } },
+		{ "bitcrusher", [] { return RenderDSP<BitcrusherDSP>(BitcrusherDSPParams{ .reduction = 12.0f, .mix = 1.0f }); } },
+		{ "wobble", [] { return RenderDSP<WobbleDSP>(WobbleDSPParams{ .waveLength = 0.125f, .loFreq = 500.0f, .hiFreq = 8000.0f, .q = 1.414f, .mix = 0.5f }); } },
+		{ "bus_chain", [] { return RenderBusChain(); } },
+	};
+
+	bool ReadReference(const std::string& path, std::vector<float>* pData)
+	{
+		std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+		if (!ifs)
+		{
+			return false;
+		}
+		const auto size = static_cast<std::size_t>(ifs.tellg());
+		ifs.seekg(0);
+		pData->resize(size / sizeof(float));
+		ifs.read(reinterpret_cast<char*>(pData->data()), static_cast<std::streamsize>(pData->size() * sizeof(float)));
+		return static_cast<bool>(ifs);
+	}
+
+	bool WriteReference(const std::string& path, const std::vector<float>& data)
+	{
+		std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+		ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(float)));
+		return static_cast<bool>(ofs);
+	}
+
+	bool RunCase(const std::string& name, const std::function<std::vector<float>()>& render, const std::string& referenceDir, bool regenerate)
+	{
+		const std::vector<float> output = render();
+		const std::string path = referenceDir + "/" + name + ".f32";
+		if (regenerate)
+		{
+			const bool ok = WriteReference(path, output);
+			std::printf("%-12s %s\n", name.c_str(), ok ? "regenerated" : "FAILED to write");
+			return ok;
+		}
+
+		std::vector<float> reference;
+		if (!ReadReference(path, &reference))
+		{
+			std::printf("%-12s FAILED: could not read %s\n", name.c_str(), path.c_str());
+			return false;
+		}
+		if (reference.size() != output.size())
+		{
+			std::printf("%-12s FAILED: %zu samples (reference: %zu samples)\n", name.c_str(), output.size(), reference.size());
+			return false;
+		}
+
+		float maxError = 0.0f;
+		std::size_t maxErrorIdx = 0U;
+		for (std::size_t i = 0U; i < output.size(); ++i)
+		{
+			const float error = std::abs(output[i] - reference[i]);
+			if (!(error <= maxError)) // Note: NaN is also reported
+			{
+				maxError = error;
+				maxErrorIdx = i;
+			}
+		}
+
+		const bool ok = maxError <= kTolerance;
+		std::printf("%-12s %s: max error %.3g at frame %zu (tolerance %.3g)\n", name.c_str(), ok ? "ok" : "FAILED", maxError, maxErrorIdx / kNumChannels, kTolerance);
+		return ok;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int argIdx = 1;
+	const bool regenerate = argIdx < argc && std::strcmp(argv[argIdx], "--regenerate") == 0;
+	if (regenerate)
+	{
+		++argIdx;
+	}
+	if (argIdx >= argc)
+	{
+		std::fprintf(stderr, "Usage: %s [--regenerate] <reference dir> [case names...]\n", argv[0]);
+		return 2;
+	}
+	const std::string referenceDir = argv[argIdx++];
+
+	const std::vector<std::string> caseNames(argv + argIdx, argv + argc);
+	return TestRunner::RunCases(kCases, caseNames, [&](const std::string& name, const std::function<std::vector<float>()>& render)
+	{
+		return RunCase(name, render, referenceDir, regenerate);
+	});
+}
@@ -0,0 +1,68 @@
+// Minimal runner shared by the headless test executables (ksmaudio/test, kshootmania/test)
+//
+// Each executable has a table of named cases and takes the names of the cases to run as arguments (all cases if none).
+// The exit code is 0 if all cases passed, 1 if any case failed, and 2 if no case matched the arguments.
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TestRunner
+{
+	template <typename Case>
+	using CaseTable = std::vector<std::pair<std::string, Case>>;
+
+	// Whether all CHECK()s in the current case passed
+	inline bool g_ok = true;
+
+	inline void Check(bool condition, const char* expr, int line)
+	{
+		if (!condition)
+		{
+			std::printf("    FAILED at line %d: %s\n", line, expr);
+			g_ok = false;
+		}
+	}
+
+	// Runs the cases in caseNames (all cases if it is empty) with run(name, case), which returns whether the case passed,
+	// and returns the exit code
+	template <typename Case, typename Run>
+	int RunCases(const CaseTable<Case>& cases, const std::vector<std::string>& caseNames, Run&& run)
+	{
+		bool ok = true;
+		std::size_t numRun = 0U;
+		for (const auto& [name, c] : cases)
+		{
+			if (!caseNames.empty() && std::find(caseNames.begin(), caseNames.end(), name) == caseNames.end())
+			{
+				continue;
+			}
+			ok = run(name, c) && ok;
+			++numRun;
+		}
+
+		if (numRun == 0U)
+		{
+			std::fprintf(stderr, "No matching cases\n");
+			return 2;
+		}
+		return ok ? 0 : 1;
+	}
+
+	// Runs the cases that report failures with CHECK(), and returns the exit code
+	inline int RunCheckCases(const CaseTable<std::function<void()>>& cases, const std::vector<std::string>& caseNames)
+	{
+		return RunCases(cases, caseNames, [](const std::string& name, const std::function<void()>& test)
+		{
+			g_ok = true;
+			test();
+			std::printf("%-22s %s\n", name.c_str(), g_ok ? "ok" : "FAILED");
+			return g_ok;
+		});
+	}
+}
+
+#define CHECK(expr) TestRunner::Check((expr), #expr, __LINE__)